@@ -0,0 +1,296 @@
+/* Copyright 2014-2017 MathWorks, Inc. */
+
+#ifndef ParamTuningPatch_h
+#define ParamTuningPatch_h
+
+/*
+ * Delta updates for the parameter tuning service.
+ *
+ * Instead of the full value of a parameter, the host sends a patch: a list
+ * of byte runs to overwrite, together with the version of the value the
+ * patch was computed against. A patch message is
+ *
+ *     uint32_T paramIdx | uint32_T flags | uint32_T baseVersion |
+ *     uint32_T newVersion | uint32_T numRuns | numRuns runs
+ *
+ * where each run is uint32_T offset | uint32_T length | length bytes, with
+ * no padding, in target byte order. Bit 0 of flags selects a block
+ * parameter (set) or a model parameter (clear); paramIdx indexes
+ * rtBlockParameters or rtModelParameters of the C-API map.
+ *
+ * A version is paramTuningVersion() of the parameter's bytes. The target
+ * computes the current version from the live value right before it
+ * applies a patch, on the model thread, so it needs no per-parameter state
+ * and stays correct when a parameter is written by other means, e.g. by
+ * tunePendingParameterChanges. A patch whose baseVersion does not match is
+ * rejected, and the host falls back to sending the full value. newVersion
+ * is the version after the patch; the host uses it as the base of its next
+ * patch.
+ *
+ * paramTuningPatchReceive validates the message and stages the patch from
+ * the service's message handler; it does not read the parameter.
+ * paramTuningPatchApplyPending checks the version and applies the patch
+ * from the model thread at the next step boundary, touching only the
+ * patched bytes, and returns the outcome (also kept in applyStatus for the
+ * service to report). The pending flag is stored with release and loaded
+ * with acquire semantics, so the staged patch is complete before the model
+ * thread sees the flag, and the parameter and applyStatus are written
+ * before the service thread stages the next patch.
+ */
+
+#include <string.h>
+
+#ifdef SL_INTERNAL
+  #include "simulinkcoder_capi/rtw_modelmap.h"
+#else
+  #include "rtw_modelmap.h"
+#endif
+
+#ifndef PARAMTUNING_PATCH_MAX_SIZE
+#define PARAMTUNING_PATCH_MAX_SIZE 2048
+#endif
+
+#define PARAMTUNING_PATCH_HEADER_SIZE     (5 * sizeof(uint32_T))
+#define PARAMTUNING_PATCH_RUN_HEADER_SIZE (2 * sizeof(uint32_T))
+#define PARAMTUNING_PATCH_BLOCK_PARAM     0x1U
+
+#if defined(__cplusplus) || \
+    (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L))
+#  define PARAMTUNING_PATCH_INLINE static inline
+#elif defined(_WIN32)
+#  define PARAMTUNING_PATCH_INLINE static __inline
+#else
+#  define PARAMTUNING_PATCH_INLINE static __inline__
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define PARAMTUNING_PATCH_STORE_RELEASE(p, v) \
+    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#  define PARAMTUNING_PATCH_LOAD_ACQUIRE(p) \
+    __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#elif defined(_MSC_VER)
+#  include <intrin.h>
+#  define PARAMTUNING_PATCH_STORE_RELEASE(p, v) \
+    ((void) _InterlockedExchange((volatile long *) (p), (long) (v)))
+#  define PARAMTUNING_PATCH_LOAD_ACQUIRE(p) \
+    ((int_T) _InterlockedCompareExchange((volatile long *) (p), 0L, 0L))
+#elif !defined(__cplusplus) && defined(__STDC_VERSION__) && \
+      (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#  include <stdatomic.h>
+#  define PARAMTUNING_PATCH_STORE_RELEASE(p, v) \
+    (atomic_thread_fence(memory_order_release), (void) (*(p) = (v)))
+#  define PARAMTUNING_PATCH_LOAD_ACQUIRE(p) paramTuningPatchLoadAcquire(p)
+PARAMTUNING_PATCH_INLINE int_T paramTuningPatchLoadAcquire(volatile int_T* p)
+{
+    int_T value = *p;
+    atomic_thread_fence(memory_order_acquire);
+    return value;
+}
+#else
+/* No ordering primitives: only safe if the service thread and the model
+ * thread run on the same processor core. */
+#  define PARAMTUNING_PATCH_STORE_RELEASE(p, v) ((void) (*(p) = (v)))
+#  define PARAMTUNING_PATCH_LOAD_ACQUIRE(p)     (*(p))
+#endif
+
+typedef enum {
+    PARAMTUNING_PATCH_ACCEPTED = 0,
+    PARAMTUNING_PATCH_BUSY,              /* previous patch not yet applied */
+    PARAMTUNING_PATCH_MALFORMED,
+    PARAMTUNING_PATCH_BAD_PARAMETER,
+    PARAMTUNING_PATCH_VERSION_MISMATCH,
+    PARAMTUNING_PATCH_NONE_PENDING       /* nothing to apply */
+} ParamTuningPatchStatus_T;
+
+typedef struct {
+    uint8_T         msg[PARAMTUNING_PATCH_MAX_SIZE];
+    uint32_T        msgSize;
+    uint8_T*        dstAddr;
+    size_t          nBytes;              /* size of the parameter */
+    ParamTuningPatchStatus_T applyStatus; /* outcome of the last apply */
+    volatile int_T  isPending;           /* apply at the next step boundary */
+} ParamTuningPatch_T;
+
+PARAMTUNING_PATCH_INLINE uint32_T paramTuningPatchGetU32(const uint8_T* p)
+{
+    uint32_T v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Hash of the parameter bytes, never zero. Four FNV-1a style lanes each
+ * take every fourth 32-bit word (read in target byte order) so that the
+ * multiplies overlap; the lanes and the trailing bytes are then folded
+ * into one FNV-1a hash. */
+PARAMTUNING_PATCH_INLINE uint32_T paramTuningVersion(const void* data, size_t nBytes)
+{
+    const uint8_T* p = (const uint8_T*)data;
+    uint32_T lane[4];
+    uint32_T hash = 2166136261U;
+    size_t i = 0;
+    int_T k;
+
+    for (k = 0; k < 4; k++) {
+        lane[k] = 2166136261U + (uint32_T)k;
+    }
+    for (; i + 16 <= nBytes; i += 16) {
+        for (k = 0; k < 4; k++) {
+            lane[k] = (lane[k] ^ paramTuningPatchGetU32(p + i + 4 * k)) * 16777619U;
+        }
+    }
+    for (k = 0; k < 4; k++) {
+        hash = (hash ^ lane[k]) * 16777619U;
+    }
+    for (; i < nBytes; i++) {
+        hash = (hash ^ p[i]) * 16777619U;
+    }
+    return (hash != 0) ? hash : 1;
+}
+
+/* Resolves the address and size of a parameter from the C-API map. Returns
+ * NULL if the parameter does not exist or has no address. */
+PARAMTUNING_PATCH_INLINE uint8_T* paramTuningPatchParamAddr(rtwCAPI_ModelMappingInfo* pMMI,
+                                                            const boolean_T isBlockParam,
+                                                            const uint_T paramIdx,
+                                                            size_t* pNBytes)
+{
+    const rtwCAPI_ModelParameters* modelParams = rtwCAPI_GetModelParameters(pMMI);
+    const rtwCAPI_BlockParameters* blockParams = rtwCAPI_GetBlockParameters(pMMI);
+    const rtwCAPI_DataTypeMap*     dataTypeMap = rtwCAPI_GetDataTypeMap(pMMI);
+    const rtwCAPI_DimensionMap*    dimMap      = rtwCAPI_GetDimensionMap(pMMI);
+    const uint_T*                  dimArray    = rtwCAPI_GetDimensionArray(pMMI);
+    void**                         dataAddrMap = rtwCAPI_GetDataAddressMap(pMMI);
+    uint_T   addrIdx;
+    uint16_T dataTypeIdx;
+    uint16_T dimIndex;
+    uint_T   dimArrayIdx;
+    size_t   numElements = 1;
+    void*    paramAddress;
+    int      idx;
+
+    if ((dataTypeMap == NULL) || (dimMap == NULL) || (dimArray == NULL) ||
+        (dataAddrMap == NULL)) {
+        return NULL;
+    }
+    if (isBlockParam) {
+        if ((blockParams == NULL) ||
+            (paramIdx >= rtwCAPI_GetNumBlockParameters(pMMI))) return NULL;
+        addrIdx     = rtwCAPI_GetBlockParameterAddrIdx(blockParams, paramIdx);
+        dataTypeIdx = rtwCAPI_GetBlockParameterDataTypeIdx(blockParams, paramIdx);
+        dimIndex    = rtwCAPI_GetBlockParameterDimensionIdx(blockParams, paramIdx);
+    } else {
+        if ((modelParams == NULL) ||
+            (paramIdx >= rtwCAPI_GetNumModelParameters(pMMI))) return NULL;
+        addrIdx     = rtwCAPI_GetModelParameterAddrIdx(modelParams, paramIdx);
+        dataTypeIdx = rtwCAPI_GetModelParameterDataTypeIdx(modelParams, paramIdx);
+        dimIndex    = rtwCAPI_GetModelParameterDimensionIdx(modelParams, paramIdx);
+    }
+
+    dimArrayIdx = rtwCAPI_GetDimArrayIndex(dimMap, dimIndex);
+    for (idx = 0; idx < rtwCAPI_GetNumDims(dimMap, dimIndex); idx++) {
+        numElements *= dimArray[dimArrayIdx + idx];
+    }
+
+    paramAddress = (void*)rtwCAPI_GetDataAddress(dataAddrMap, addrIdx);
+    if ((paramAddress != NULL) &&
+        rtwCAPI_GetDataIsPointer(dataTypeMap, dataTypeIdx)) {
+        paramAddress = *((void**)paramAddress);
+    }
+    *pNBytes = numElements * rtwCAPI_GetDataTypeSize(dataTypeMap, dataTypeIdx);
+    return (uint8_T*)paramAddress;
+}
+
+/* Validates a patch message against the C-API map and stages it for
+ * paramTuningPatchApplyPending. The parameter is neither read nor
+ * modified; its version is checked when the patch is applied. */
+PARAMTUNING_PATCH_INLINE ParamTuningPatchStatus_T paramTuningPatchReceive(
+    ParamTuningPatch_T* const pPatch,
+    rtwCAPI_ModelMappingInfo* pMMI,
+    const uint8_T* const msg,
+    const uint32_T msgSize)
+{
+    uint32_T paramIdx;
+    uint32_T flags;
+    uint32_T numRuns;
+    uint32_T pos;
+    uint32_T run;
+    uint8_T* dstAddr;
+    size_t   nBytes;
+
+    if (PARAMTUNING_PATCH_LOAD_ACQUIRE(&pPatch->isPending)) {
+        return PARAMTUNING_PATCH_BUSY;
+    }
+    if ((msgSize < PARAMTUNING_PATCH_HEADER_SIZE) ||
+        (msgSize > PARAMTUNING_PATCH_MAX_SIZE)) {
+        return PARAMTUNING_PATCH_MALFORMED;
+    }
+
+    paramIdx = paramTuningPatchGetU32(msg);
+    flags    = paramTuningPatchGetU32(msg + 4);
+    numRuns  = paramTuningPatchGetU32(msg + 16);
+
+    dstAddr = paramTuningPatchParamAddr(
+        pMMI, (boolean_T)((flags & PARAMTUNING_PATCH_BLOCK_PARAM) != 0),
+        (uint_T)paramIdx, &nBytes);
+    if (dstAddr == NULL) return PARAMTUNING_PATCH_BAD_PARAMETER;
+
+    /* Every run must lie within the parameter and the runs must exactly
+     * fill the message */
+    pos = PARAMTUNING_PATCH_HEADER_SIZE;
+    for (run = 0; run < numRuns; run++) {
+        uint32_T offset;
+        uint32_T length;
+        if (msgSize - pos < PARAMTUNING_PATCH_RUN_HEADER_SIZE) {
+            return PARAMTUNING_PATCH_MALFORMED;
+        }
+        offset = paramTuningPatchGetU32(msg + pos);
+        length = paramTuningPatchGetU32(msg + pos + 4);
+        pos += PARAMTUNING_PATCH_RUN_HEADER_SIZE;
+        if ((length > msgSize - pos) || (offset > nBytes) ||
+            (length > nBytes - offset)) {
+            return PARAMTUNING_PATCH_MALFORMED;
+        }
+        pos += length;
+    }
+    if (pos != msgSize) return PARAMTUNING_PATCH_MALFORMED;
+
+    memcpy(pPatch->msg, msg, msgSize);
+    pPatch->msgSize = msgSize;
+    pPatch->dstAddr = dstAddr;
+    pPatch->nBytes  = nBytes;
+    PARAMTUNING_PATCH_STORE_RELEASE(&pPatch->isPending, 1);
+    return PARAMTUNING_PATCH_ACCEPTED;
+}
+
+/* Called by the model thread between steps, next to
+ * tunePendingParameterChanges. If a patch is pending, checks its
+ * baseVersion against the live parameter and applies it only if they
+ * match. Returns PARAMTUNING_PATCH_NONE_PENDING, PARAMTUNING_PATCH_ACCEPTED
+ * (applied) or PARAMTUNING_PATCH_VERSION_MISMATCH (discarded, the
+ * parameter is unchanged). */
+PARAMTUNING_PATCH_INLINE ParamTuningPatchStatus_T paramTuningPatchApplyPending(
+    ParamTuningPatch_T* const pPatch)
+{
+    uint32_T pos = PARAMTUNING_PATCH_HEADER_SIZE;
+
+    if (!PARAMTUNING_PATCH_LOAD_ACQUIRE(&pPatch->isPending)) {
+        return PARAMTUNING_PATCH_NONE_PENDING;
+    }
+    if (paramTuningVersion(pPatch->dstAddr, pPatch->nBytes) !=
+        paramTuningPatchGetU32(pPatch->msg + 8)) {
+        pPatch->applyStatus = PARAMTUNING_PATCH_VERSION_MISMATCH;
+    } else {
+        while (pos < pPatch->msgSize) {
+            uint32_T offset = paramTuningPatchGetU32(pPatch->msg + pos);
+            uint32_T length = paramTuningPatchGetU32(pPatch->msg + pos + 4);
+            pos += PARAMTUNING_PATCH_RUN_HEADER_SIZE;
+            memcpy(pPatch->dstAddr + offset, pPatch->msg + pos, length);
+            pos += length;
+        }
+        pPatch->applyStatus = PARAMTUNING_PATCH_ACCEPTED;
+    }
+    PARAMTUNING_PATCH_STORE_RELEASE(&pPatch->isPending, 0);
+    return pPatch->applyStatus;
+}
+
+#endif
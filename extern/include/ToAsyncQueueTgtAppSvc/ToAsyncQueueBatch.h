@@ -0,0 +1,164 @@
+/* Copyright 2013-2017 MathWorks, Inc. */
+
+#ifndef ToAsyncQueueBatch_h
+#define ToAsyncQueueBatch_h
+
+#include <string.h>
+#include "ToAsyncQueueTgtAppSvcCIntrf.h"
+
+/*
+ * Batched sample records for the ToAsyncQueue service.
+ *
+ * A batch packs many (id, time, data) records into the data of a single
+ * sendToAsyncQueueTgtAppSvc message, which is sent with the reserved signal
+ * id TOASYNCQUEUE_BATCH_ID. Each record is
+ *
+ *     uint32_t id | uint32_t sizeOfData | double time | data[sizeOfData]
+ *
+ * with no padding between records. Fields are in target byte order, like
+ * the fields of an unbatched message.
+ *
+ * The target side owns a ToAsyncQueueBatch, fills it with
+ * queueToAsyncQueueBatch and sends it with flushToAsyncQueueBatch, e.g.
+ * once per model step. The ToAsyncQueueTgtAppSvc service itself is
+ * unchanged and still sends every message as it is given.
+ *
+ * A host consumer that predates batching treats a batch as a sample of an
+ * unknown signal, so batching must only be used when the host passes every
+ * received message through dispatchToAsyncQueueMessage, which splits
+ * batches back into samples and passes other messages through.
+ */
+
+#if defined(__cplusplus) || \
+    (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L))
+#  define TOASYNCQUEUE_BATCH_INLINE static inline
+#elif defined(_WIN32)
+#  define TOASYNCQUEUE_BATCH_INLINE static __inline
+#else
+#  define TOASYNCQUEUE_BATCH_INLINE static __inline__
+#endif
+
+/* Signal id of a message that carries a batch */
+#define TOASYNCQUEUE_BATCH_ID (0xFFFFFFFFU)
+
+/* Bytes in front of the data of every record */
+#define TOASYNCQUEUE_BATCH_RECORD_HEADER_SIZE \
+    (2U * sizeof(uint32_t) + sizeof(double))
+
+/* Message::ABSOLUTE_MAXIMUM_PAYLOAD less the room the service needs for
+ * its own id and time */
+#define TOASYNCQUEUE_BATCH_CAPACITY (2032U - 16U)
+
+typedef struct ToAsyncQueueBatch_tag {
+    double         firstTime;   /* time of the first record, sent as the
+                                   time of the batch message */
+    unsigned short size;        /* bytes used in buffer */
+    unsigned short count;       /* records in buffer */
+    unsigned char  buffer[TOASYNCQUEUE_BATCH_CAPACITY];
+} ToAsyncQueueBatch;
+
+/* Called by dispatchToAsyncQueueMessage for every sample */
+typedef void (*ToAsyncQueueSampleFcn)(void *context, uint32_t id, double time,
+                                      const void *data, uint32_t sizeOfData);
+
+/* Whether a record with sizeOfData bytes of data can be batched at all */
+TOASYNCQUEUE_BATCH_INLINE int toAsyncQueueBatchFits(uint32_t sizeOfData)
+{
+    return sizeOfData <= (uint32_t)(TOASYNCQUEUE_BATCH_CAPACITY -
+                                    TOASYNCQUEUE_BATCH_RECORD_HEADER_SIZE);
+}
+
+TOASYNCQUEUE_BATCH_INLINE void initToAsyncQueueBatch(ToAsyncQueueBatch *batch)
+{
+    batch->firstTime = 0.0;
+    batch->size = 0;
+    batch->count = 0;
+}
+
+/* Send the pending records, if any, as one message */
+TOASYNCQUEUE_BATCH_INLINE void flushToAsyncQueueBatch(ToAsyncQueueBatch *batch)
+{
+    if (batch->count == 0) return;
+    sendToAsyncQueueTgtAppSvc(TOASYNCQUEUE_BATCH_ID, batch->firstTime,
+                              batch->buffer, batch->size);
+    batch->size = 0;
+    batch->count = 0;
+}
+
+/* Add a sample to the batch instead of sending it on its own. The batch is
+ * flushed first if the sample does not fit. Samples too large to batch are
+ * sent directly, after the pending batch, so ordering is preserved. */
+TOASYNCQUEUE_BATCH_INLINE void queueToAsyncQueueBatch(ToAsyncQueueBatch *batch,
+                                                      uint32_t id, double time,
+                                                      const void *data,
+                                                      uint32_t sizeOfData)
+{
+    unsigned char *p;
+
+    if (!toAsyncQueueBatchFits(sizeOfData)) {
+        flushToAsyncQueueBatch(batch);
+        sendToAsyncQueueTgtAppSvc(id, time, (void *)data, sizeOfData);
+        return;
+    }
+    if (batch->size + TOASYNCQUEUE_BATCH_RECORD_HEADER_SIZE + sizeOfData >
+        TOASYNCQUEUE_BATCH_CAPACITY) {
+        flushToAsyncQueueBatch(batch);
+    }
+
+    p = batch->buffer + batch->size;
+    memcpy(p, &id, sizeof(id));
+    p += sizeof(id);
+    memcpy(p, &sizeOfData, sizeof(sizeOfData));
+    p += sizeof(sizeOfData);
+    memcpy(p, &time, sizeof(time));
+    p += sizeof(time);
+    memcpy(p, data, sizeOfData);
+    if (batch->count == 0) batch->firstTime = time;
+    batch->size = (unsigned short)(batch->size +
+                                   TOASYNCQUEUE_BATCH_RECORD_HEADER_SIZE +
+                                   sizeOfData);
+    batch->count++;
+}
+
+/* Host side: pass one received message to fcn, split into its samples if
+ * it is a batch. Returns 0 if a batch is truncated; the samples before the
+ * truncated record have been passed on. */
+TOASYNCQUEUE_BATCH_INLINE int dispatchToAsyncQueueMessage(uint32_t id,
+                                                          double time,
+                                                          const void *data,
+                                                          uint32_t sizeOfData,
+                                                          ToAsyncQueueSampleFcn fcn,
+                                                          void *context)
+{
+    const unsigned char *next = (const unsigned char *)data;
+    const unsigned char *end = next + sizeOfData;
+
+    if (id != TOASYNCQUEUE_BATCH_ID) {
+        fcn(context, id, time, data, sizeOfData);
+        return 1;
+    }
+
+    while (next != end) {
+        uint32_t recordId;
+        uint32_t recordSize;
+        double recordTime;
+
+        if ((size_t)(end - next) < (size_t)TOASYNCQUEUE_BATCH_RECORD_HEADER_SIZE) {
+            return 0;
+        }
+        memcpy(&recordId, next, sizeof(recordId));
+        next += sizeof(recordId);
+        memcpy(&recordSize, next, sizeof(recordSize));
+        next += sizeof(recordSize);
+        memcpy(&recordTime, next, sizeof(recordTime));
+        next += sizeof(recordTime);
+        if ((size_t)(end - next) < (size_t)recordSize) {
+            return 0;
+        }
+        fcn(context, recordId, recordTime, next, recordSize);
+        next += recordSize;
+    }
+    return 1;
+}
+
+#endif
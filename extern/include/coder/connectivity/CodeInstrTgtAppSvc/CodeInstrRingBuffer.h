@@ -0,0 +1,245 @@
+/* Copyright 2013-2017 The MathWorks, Inc. */
+
+#ifndef CodeInstrRingBuffer_h
+#define CodeInstrRingBuffer_h
+
+/*
+ * Ring-buffered capture of code instrumentation records.
+ *
+ * Instead of allocating and sending a buffer from each instrumentation
+ * point, the instrumented code appends a raw (section id, timer) record to
+ * a ring buffer with codeInstrRingWrite, and a background or idle loop
+ * drains the ring in large batches with codeInstrRingDrain (or, on Linux,
+ * codeInstrRingDumpToFile). Records are decoded offline by the host tool
+ * codeinstr_decode.
+ *
+ * The ring is a lock-free single-producer single-consumer queue: one task
+ * or interrupt level writes, one drains. Multitasking targets use one ring
+ * per task. When the ring is full, new records are dropped and counted.
+ *
+ * A batch, whether sent or written to a file, is
+ *
+ *     uint32_T numRecords | uint32_T numDropped | numRecords records
+ *
+ * where each record is uint32_T sectionId | uint32_T timer, in target byte
+ * order. A section start is recorded with its id; the end of a section with
+ * its id or'ed with CODEINSTR_RING_EXIT_FLAG. numDropped counts the
+ * records lost to overflow since the previous batch.
+ *
+ * Batches are self-delimiting, so a capture is simply their concatenation.
+ * They must not be sent through the code instrumentation service, whose
+ * host side expects one record per message. Send them instead over a
+ * dedicated rtIOStream connection (define CODEINSTR_RING_RTIOSTREAM and use
+ * codeInstrRingRtIOStreamSend) and record the stream on the host with
+ * codeinstr_decode -record, or write them to a file.
+ */
+
+#include "CodeInstrTgtAppSvc.h"
+#include <string.h>
+#if defined(__linux__)
+#include <stdio.h>
+#endif
+#if defined(CODEINSTR_RING_RTIOSTREAM)
+#include "rtiostream.h"
+#endif
+
+#ifndef CODEINSTR_RING_SIZE
+/* Number of records in the ring, must be a power of two */
+#define CODEINSTR_RING_SIZE 1024
+#endif
+
+#if (CODEINSTR_RING_SIZE & (CODEINSTR_RING_SIZE - 1)) != 0
+#error "CODEINSTR_RING_SIZE must be a power of two"
+#endif
+
+#ifndef CODEINSTR_RING_BATCH_RECORDS
+/* Largest number of records per batch handed to the send function */
+#define CODEINSTR_RING_BATCH_RECORDS 256
+#endif
+
+#define CODEINSTR_RING_EXIT_FLAG   0x80000000U
+#define CODEINSTR_RING_RECORD_SIZE (2 * sizeof(uint32_T))
+#define CODEINSTR_RING_HEADER_SIZE (2 * sizeof(uint32_T))
+
+#if defined(__cplusplus) || \
+    (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L))
+#  define CODEINSTR_RING_INLINE static inline
+#elif defined(_WIN32)
+#  define CODEINSTR_RING_INLINE static __inline
+#else
+#  define CODEINSTR_RING_INLINE static __inline__
+#endif
+
+/* The index store that publishes records (or frees slots) is a release, and
+ * the load of the other side's index an acquire, so that the record stores
+ * and loads cannot move across them on weakly ordered processors. */
+#if defined(__GNUC__) || defined(__clang__)
+#  define CODEINSTR_RING_STORE_RELEASE(p, v) \
+    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#  define CODEINSTR_RING_LOAD_ACQUIRE(p) \
+    __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#elif defined(_MSC_VER)
+#  include <intrin.h>
+#  define CODEINSTR_RING_STORE_RELEASE(p, v) \
+    ((void) _InterlockedExchange((volatile long *) (p), (long) (v)))
+#  define CODEINSTR_RING_LOAD_ACQUIRE(p) \
+    ((uint32_T) _InterlockedCompareExchange((volatile long *) (p), 0L, 0L))
+#elif !defined(__cplusplus) && defined(__STDC_VERSION__) && \
+      (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#  include <stdatomic.h>
+#  define CODEINSTR_RING_STORE_RELEASE(p, v) \
+    (atomic_thread_fence(memory_order_release), (void) (*(p) = (v)))
+#  define CODEINSTR_RING_LOAD_ACQUIRE(p) codeInstrRingLoadAcquire(p)
+CODEINSTR_RING_INLINE uint32_T codeInstrRingLoadAcquire(volatile uint32_T *p)
+{
+    uint32_T value = *p;
+    atomic_thread_fence(memory_order_acquire);
+    return value;
+}
+#else
+/* No ordering primitives: only safe if the producer and the consumer run on
+ * the same processor core. */
+#  define CODEINSTR_RING_STORE_RELEASE(p, v) ((void) (*(p) = (v)))
+#  define CODEINSTR_RING_LOAD_ACQUIRE(p)     (*(p))
+#endif
+
+typedef struct {
+    uint32_T sectionId;
+    uint32_T timer;
+} CodeInstrRingRecord_T;
+
+typedef struct {
+    CodeInstrRingRecord_T records[CODEINSTR_RING_SIZE];
+    volatile uint32_T head;     /* written by the producer only */
+    volatile uint32_T tail;     /* written by the consumer only */
+    volatile uint32_T dropped;  /* written by the producer only */
+    uint32_T droppedReported;   /* consumer's copy of dropped   */
+    /* consumer's staging buffer for one batch */
+    uint8_T batch[CODEINSTR_RING_HEADER_SIZE +
+                  CODEINSTR_RING_BATCH_RECORDS * CODEINSTR_RING_RECORD_SIZE];
+} CodeInstrRing_T;
+
+/* Delivers one complete batch of size bytes. Returns
+ * CODEINSTRTGTAPPSVC_SUCCESS only if the whole batch was accepted. */
+typedef boolean_T (*CodeInstrRingSendFcn)(void*          pCtx,
+                                          const uint8_T* pBatch,
+                                          size_t         size);
+
+CODEINSTR_RING_INLINE void codeInstrRingInit(CodeInstrRing_T * const pRing)
+{
+    pRing->head = 0;
+    pRing->tail = 0;
+    pRing->dropped = 0;
+    pRing->droppedReported = 0;
+}
+
+/* Producer side, called from the instrumentation points */
+CODEINSTR_RING_INLINE void codeInstrRingWrite(CodeInstrRing_T * const pRing,
+                                              const uint32_T sectionId,
+                                              const uint32_T timer)
+{
+    const uint32_T head = pRing->head;
+
+    if ((uint32_T)(head - CODEINSTR_RING_LOAD_ACQUIRE(&pRing->tail)) >=
+        CODEINSTR_RING_SIZE) {
+        CODEINSTR_RING_STORE_RELEASE(&pRing->dropped, pRing->dropped + 1);
+        return;
+    }
+    pRing->records[head & (CODEINSTR_RING_SIZE - 1)].sectionId = sectionId;
+    pRing->records[head & (CODEINSTR_RING_SIZE - 1)].timer = timer;
+    CODEINSTR_RING_STORE_RELEASE(&pRing->head, head + 1);
+}
+
+/* Consumer side. Sends the buffered records in batches of up to
+ * CODEINSTR_RING_BATCH_RECORDS each, at most maxBatches of them so that an
+ * idle loop stays responsive. Records are released from the ring only after
+ * sendFcn accepted their batch; if it fails, they stay in the ring and
+ * CODEINSTRTGTAPPSVC_ERROR is returned. The batch is staged in the ring, so
+ * different rings can be drained at the same time. */
+CODEINSTR_RING_INLINE boolean_T codeInstrRingDrain(CodeInstrRing_T * const pRing,
+                                                   const CodeInstrRingSendFcn sendFcn,
+                                                   void* pCtx,
+                                                   uint32_T maxBatches)
+{
+    uint8_T * const batch = pRing->batch;
+
+    while (maxBatches-- > 0) {
+        const uint32_T tail = pRing->tail;
+        const uint32_T dropped = CODEINSTR_RING_LOAD_ACQUIRE(&pRing->dropped);
+        const uint32_T numDropped = (uint32_T)(dropped - pRing->droppedReported);
+        uint32_T numRecords =
+            (uint32_T)(CODEINSTR_RING_LOAD_ACQUIRE(&pRing->head) - tail);
+        uint32_T first;
+        uint32_T run;
+        size_t   size;
+
+        if ((numRecords == 0) && (numDropped == 0)) break;
+        if (numRecords > CODEINSTR_RING_BATCH_RECORDS) {
+            numRecords = CODEINSTR_RING_BATCH_RECORDS;
+        }
+
+        /* At most two contiguous runs, before and after the wrap */
+        first = tail & (CODEINSTR_RING_SIZE - 1);
+        run = CODEINSTR_RING_SIZE - first;
+        if (run > numRecords) run = numRecords;
+        memcpy(batch + CODEINSTR_RING_HEADER_SIZE, &pRing->records[first],
+               run * CODEINSTR_RING_RECORD_SIZE);
+        memcpy(batch + CODEINSTR_RING_HEADER_SIZE + run * CODEINSTR_RING_RECORD_SIZE,
+               &pRing->records[0], (numRecords - run) * CODEINSTR_RING_RECORD_SIZE);
+        memcpy(batch, &numRecords, sizeof(numRecords));
+        memcpy(batch + sizeof(numRecords), &numDropped, sizeof(numDropped));
+        size = CODEINSTR_RING_HEADER_SIZE + numRecords * CODEINSTR_RING_RECORD_SIZE;
+
+        if (sendFcn(pCtx, batch, size) != CODEINSTRTGTAPPSVC_SUCCESS) {
+            return CODEINSTRTGTAPPSVC_ERROR;
+        }
+        pRing->droppedReported = dropped;
+        CODEINSTR_RING_STORE_RELEASE(&pRing->tail, tail + numRecords);
+    }
+    return CODEINSTRTGTAPPSVC_SUCCESS;
+}
+
+#if defined(CODEINSTR_RING_RTIOSTREAM)
+/* Send function for codeInstrRingDrain that writes the batch to the
+ * rtIOStream connection whose stream id pCtx points to. Blocks until the
+ * stream has accepted the whole batch. */
+CODEINSTR_RING_INLINE boolean_T codeInstrRingRtIOStreamSend(void* pCtx,
+                                                            const uint8_T* pBatch,
+                                                            size_t size)
+{
+    const int streamID = *(const int*)pCtx;
+
+    while (size > 0) {
+        size_t sizeSent;
+        if (rtIOStreamSend(streamID, pBatch, size, &sizeSent) != RTIOSTREAM_NO_ERROR) {
+            return CODEINSTRTGTAPPSVC_ERROR;
+        }
+        pBatch += sizeSent;
+        size -= sizeSent;
+    }
+    return CODEINSTRTGTAPPSVC_SUCCESS;
+}
+#endif
+
+#if defined(__linux__)
+CODEINSTR_RING_INLINE boolean_T codeInstrRingFileSend(void* pCtx,
+                                                      const uint8_T* pBatch,
+                                                      size_t size)
+{
+    if (fwrite(pBatch, 1, size, (FILE*)pCtx) != size) {
+        return CODEINSTRTGTAPPSVC_ERROR;
+    }
+    return CODEINSTRTGTAPPSVC_SUCCESS;
+}
+
+/* Consumer side for Linux targets without a host connection: appends all
+ * buffered records to fp. */
+CODEINSTR_RING_INLINE boolean_T codeInstrRingDumpToFile(CodeInstrRing_T * const pRing,
+                                                        FILE * const fp)
+{
+    return codeInstrRingDrain(pRing, codeInstrRingFileSend, fp,
+                              CODEINSTR_RING_SIZE / CODEINSTR_RING_BATCH_RECORDS + 1);
+}
+#endif
+
+#endif
@@ -0,0 +1,113 @@
+/* Copyright 2013-2017 The MathWorks, Inc. */
+
+#ifndef XILPipeline_h
+#define XILPipeline_h
+
+/*
+ * Pipelined multi-step execution over the XIL target application service.
+ *
+ * For open-loop components, whose inputs do not depend on their outputs,
+ * the host can send the inputs of N consecutive steps in one request and
+ * receive the N output vectors in one response, instead of one round trip
+ * per step. Request and response share the same layout:
+ *
+ *     uint16_T numSteps | uint16_T bytesPerStep | numSteps * bytesPerStep
+ *
+ * where the data holds the input (request) or output (response) vectors
+ * of the steps in execution order. Header fields are in target byte order.
+ * A response whose numSteps is smaller than the request's reports that the
+ * target stopped early, e.g. because a step failed. The helpers below
+ * assume byte-addressable IO units (IOUnit_T of one byte).
+ */
+
+#include "XILTgtAppSvc_CInterface.h"
+#include <string.h>
+
+#if defined(__cplusplus) || \
+    (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L))
+#  define XIL_PIPELINE_INLINE static inline
+#elif defined(_WIN32)
+#  define XIL_PIPELINE_INLINE static __inline
+#else
+#  define XIL_PIPELINE_INLINE static __inline__
+#endif
+
+#define XIL_PIPELINE_HEADER_SIZE (2 * sizeof(uint16_T))
+
+#define XIL_PIPELINE_MESSAGE_SIZE(numSteps, bytesPerStep) \
+    (XIL_PIPELINE_HEADER_SIZE + (size_t)(numSteps) * (size_t)(bytesPerStep))
+
+/* Executes one step: reads inBytesPerStep input bytes, writes
+ * outBytesPerStep output bytes (the sizes passed to xilPipelineRunBatch).
+ * Returns XILTGTAPPSVC_SUCCESS or XILTGTAPPSVC_ERROR. */
+typedef boolean_T (*XILPipelineStepFcn)(void*          pCtx,
+                                        const uint8_T* pInputs,
+                                        uint8_T*       pOutputs);
+
+/* Largest number of steps whose inputs and outputs both fit in one
+ * message of the service. */
+XIL_PIPELINE_INLINE uint16_T xilPipelineMaxSteps(const uint16_T inBytesPerStep,
+                                                 const uint16_T outBytesPerStep)
+{
+    uint16_T capacity = xilTgtAppSvcGetMaxPayloadCapacity();
+    uint16_T bytesPerStep = (inBytesPerStep > outBytesPerStep) ?
+        inBytesPerStep : outBytesPerStep;
+
+    if (capacity <= XIL_PIPELINE_HEADER_SIZE) return 0;
+    if (bytesPerStep == 0) return 0xFFFF;
+    return (uint16_T)((capacity - XIL_PIPELINE_HEADER_SIZE) / bytesPerStep);
+}
+
+/* Runs a received pipelined request and sends all outputs in a single
+ * response. The request must carry exactly inBytesPerStep bytes per step
+ * and its response must fit in one message (see xilPipelineMaxSteps). */
+XIL_PIPELINE_INLINE boolean_T xilPipelineRunBatch(const uint8_T*           pRequest,
+                                                  const uint16_T           requestSize,
+                                                  const uint16_T           inBytesPerStep,
+                                                  const uint16_T           outBytesPerStep,
+                                                  const XILPipelineStepFcn stepFcn,
+                                                  void*                    pCtx)
+{
+    uint16_T numSteps;
+    uint16_T bytesPerStep;
+    uint16_T step;
+    size_t   responseSize;
+    void*    pBuf;
+    uint8_T* pResponse;
+
+    if (requestSize < XIL_PIPELINE_HEADER_SIZE) return XILTGTAPPSVC_ERROR;
+    memcpy(&numSteps, pRequest, sizeof(numSteps));
+    memcpy(&bytesPerStep, pRequest + sizeof(numSteps), sizeof(bytesPerStep));
+    if ((bytesPerStep != inBytesPerStep) ||
+        (requestSize != XIL_PIPELINE_MESSAGE_SIZE(numSteps, bytesPerStep))) {
+        return XILTGTAPPSVC_ERROR;
+    }
+
+    responseSize = XIL_PIPELINE_MESSAGE_SIZE(numSteps, outBytesPerStep);
+    if (responseSize > xilTgtAppSvcGetMaxPayloadCapacity()) {
+        return XILTGTAPPSVC_ERROR;
+    }
+    if (xilTgtAppSvcAllocBuffer(&pBuf, (uint16_T)responseSize) !=
+        XILTGTAPPSVC_SUCCESS) {
+        return XILTGTAPPSVC_ERROR;
+    }
+    pResponse = (uint8_T*)xilTgtAppSvcGetBufferDataPtr(pBuf);
+
+    pRequest  += XIL_PIPELINE_HEADER_SIZE;
+    for (step = 0; step < numSteps; step++) {
+        if (stepFcn(pCtx,
+                    pRequest + (size_t)step * inBytesPerStep,
+                    pResponse + XIL_PIPELINE_HEADER_SIZE +
+                    (size_t)step * outBytesPerStep) != XILTGTAPPSVC_SUCCESS) {
+            break;
+        }
+    }
+
+    /* step is the number of steps that completed */
+    memcpy(pResponse, &step, sizeof(step));
+    memcpy(pResponse + sizeof(step), &outBytesPerStep, sizeof(outBytesPerStep));
+    return xilTgtAppSvcSend(pBuf,
+                            (uint16_T)XIL_PIPELINE_MESSAGE_SIZE(step, outBytesPerStep));
+}
+
+#endif
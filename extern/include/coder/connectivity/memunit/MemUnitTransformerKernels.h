@@ -0,0 +1,315 @@
+/* Copyright 2016-2017 The MathWorks, Inc. */
+
+#ifndef MemUnitTransformerKernels_h
+#define MemUnitTransformerKernels_h
+
+/*
+ * Bulk kernels for the memory unit transformer.
+ *
+ * A transform is selected once per (type, direction) with
+ * memUnitXformKernel_Select, typically when the transformer is initialized,
+ * and then applied to a whole buffer with memUnitXformKernel_Run instead of
+ * converting element by element. The kernels are:
+ *
+ *   o copy      - host and target layouts match. When the input and output
+ *                 buffers are the same the transform is a no-op.
+ *   o swap      - same element size, different byte order. Uses SSSE3 or
+ *                 NEON byte shuffles when available, otherwise SSE2 word
+ *                 shuffles and shifts.
+ *   o widen     - outbound, the element is smaller than a target memory unit
+ *                 (e.g. an 8 bit type on a 16 bit word addressable target):
+ *                 each element is sign or zero extended to a full memory
+ *                 unit in target byte order.
+ *   o narrow    - the inbound counterpart of widen.
+ *
+ * Like memUnitXformer_DoXform, memUnitXformKernel_Run advances *pIn and
+ * *pOut past the data it consumed and produced.
+ */
+
+#include <string.h>
+#include "tmwtypes.h"
+#include "MemUnitTransformerType.h"
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define MEM_UNIT_XFORM_SSSE3
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define MEM_UNIT_XFORM_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MEM_UNIT_XFORM_NEON
+#endif
+
+#if defined(__cplusplus) || \
+    (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L))
+#  define MEM_UNIT_XFORM_INLINE static inline
+#elif defined(_WIN32)
+#  define MEM_UNIT_XFORM_INLINE static __inline
+#else
+#  define MEM_UNIT_XFORM_INLINE static __inline__
+#endif
+
+#define MEM_UNIT_NUM_TYPES (MEM_UNIT_DOUBLE_TYPE + 1)
+
+typedef enum MEM_UNIT_XFORM_KERNEL_KIND {
+    MEM_UNIT_XFORM_KERNEL_COPY=0,
+    MEM_UNIT_XFORM_KERNEL_SWAP,
+    MEM_UNIT_XFORM_KERNEL_WIDEN,
+    MEM_UNIT_XFORM_KERNEL_NARROW
+} mem_unit_xform_kernel_kind_T;
+
+typedef struct {
+    mem_unit_xform_kernel_kind_T kind;
+    uint8_T   typeSize;          /* bytes of one host element             */
+    uint8_T   tgtSize;           /* bytes of one element in target memory */
+    boolean_T isSigned;          /* sign extend when widening             */
+    boolean_T tgtIsLittleEndian;
+} memUnitXformKernel_T;
+
+MEM_UNIT_XFORM_INLINE uint8_T memUnitXformKernel_TypeSize(const mem_unit_type_T typeId)
+{
+    static const uint8_T sizes[MEM_UNIT_NUM_TYPES] = {
+        1, 1, 2, 4, 8, 1, 2, 4, 8, 4, 8
+    };
+    return sizes[typeId];
+}
+
+MEM_UNIT_XFORM_INLINE boolean_T memUnitXformKernel_HostIsLittleEndian(void)
+{
+    const uint16_T one = 1;
+    return (boolean_T)(*(const uint8_T*)&one == 1);
+}
+
+/* Chooses the kernel for one type and direction. memUnitSize is the size of
+ * a target memory unit in bytes (1 for byte addressable targets) and
+ * needsSwap tells whether the type is stored in the opposite byte order on
+ * the target. */
+MEM_UNIT_XFORM_INLINE void memUnitXformKernel_Select(memUnitXformKernel_T * const pKernel,
+                                                     const mem_unit_type_T typeId,
+                                                     const boolean_T isInbound,
+                                                     const uint_T memUnitSize,
+                                                     const boolean_T needsSwap)
+{
+    const uint8_T typeSize = memUnitXformKernel_TypeSize(typeId);
+
+    pKernel->typeSize = typeSize;
+    pKernel->tgtSize = typeSize;
+    pKernel->isSigned = (boolean_T)((typeId >= MEM_UNIT_INT8_TYPE) &&
+                                    (typeId <= MEM_UNIT_INT64_TYPE));
+    pKernel->tgtIsLittleEndian = (boolean_T)
+        (memUnitXformKernel_HostIsLittleEndian() != needsSwap);
+
+    if (typeSize < memUnitSize) {
+        pKernel->tgtSize = (uint8_T)memUnitSize;
+        pKernel->kind = isInbound ?
+            MEM_UNIT_XFORM_KERNEL_NARROW : MEM_UNIT_XFORM_KERNEL_WIDEN;
+    } else if (needsSwap && (typeSize > 1)) {
+        pKernel->kind = MEM_UNIT_XFORM_KERNEL_SWAP;
+    } else {
+        pKernel->kind = MEM_UNIT_XFORM_KERNEL_COPY;
+    }
+}
+
+/* Byte reversal of n elements of size 2, 4 or 8. pIn and pOut may be the
+ * same buffer but must not otherwise overlap. */
+MEM_UNIT_XFORM_INLINE void memUnitXformKernel_Swap(const uint8_T *pIn,
+                                                   uint8_T *pOut,
+                                                   size_t n,
+                                                   const uint8_T typeSize)
+{
+    size_t nBytes = n * typeSize;
+    size_t i = 0;
+
+#if defined(MEM_UNIT_XFORM_SSSE3)
+    {
+        __m128i mask;
+        if (typeSize == 2) {
+            mask = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+        } else if (typeSize == 4) {
+            mask = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+        } else {
+            mask = _mm_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+        }
+        for (; i + 16 <= nBytes; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(pIn + i));
+            _mm_storeu_si128((__m128i*)(pOut + i), _mm_shuffle_epi8(v, mask));
+        }
+    }
+#elif defined(MEM_UNIT_XFORM_SSE2)
+    for (; i + 16 <= nBytes; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(pIn + i));
+        /* reverse the 16 bit words of each element, then the bytes of
+         * each word */
+        if (typeSize == 4) {
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+        } else if (typeSize == 8) {
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x1B), 0x1B);
+        }
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i*)(pOut + i), v);
+    }
+#elif defined(MEM_UNIT_XFORM_NEON)
+    for (; i + 16 <= nBytes; i += 16) {
+        uint8x16_t v = vld1q_u8(pIn + i);
+        if (typeSize == 2) {
+            v = vrev16q_u8(v);
+        } else if (typeSize == 4) {
+            v = vrev32q_u8(v);
+        } else {
+            v = vrev64q_u8(v);
+        }
+        vst1q_u8(pOut + i, v);
+    }
+#endif
+
+    /* Remainder, or the whole buffer without SIMD. The fixed size loops
+     * are simple enough for the compiler to vectorize on its own. */
+    if (typeSize == 2) {
+        for (; i < nBytes; i += 2) {
+            uint16_T v;
+            memcpy(&v, pIn + i, 2);
+            v = (uint16_T)((v >> 8) | (v << 8));
+            memcpy(pOut + i, &v, 2);
+        }
+    } else if (typeSize == 4) {
+        for (; i < nBytes; i += 4) {
+            uint32_T v;
+            memcpy(&v, pIn + i, 4);
+            v = ((v >> 24) | ((v >> 8) & 0xFF00U) |
+                 ((v << 8) & 0xFF0000U) | (v << 24));
+            memcpy(pOut + i, &v, 4);
+        }
+    } else {
+#if defined(UINT64_T)
+        const uint64_T mask16 = ((uint64_T)0x0000FFFFU << 32) | 0x0000FFFFU;
+        const uint64_T mask8  = ((uint64_T)0x00FF00FFU << 32) | 0x00FF00FFU;
+        for (; i < nBytes; i += 8) {
+            uint64_T v;
+            memcpy(&v, pIn + i, 8);
+            v = ((v >> 32) | (v << 32));
+            v = (((v >> 16) & mask16) | ((v & mask16) << 16));
+            v = (((v >> 8) & mask8) | ((v & mask8) << 8));
+            memcpy(pOut + i, &v, 8);
+        }
+#else
+        /* no 64 bit integer: swap the two 32 bit halves */
+        for (; i < nBytes; i += 8) {
+            uint32_T lo, hi;
+            memcpy(&lo, pIn + i, 4);
+            memcpy(&hi, pIn + i + 4, 4);
+            lo = ((lo >> 24) | ((lo >> 8) & 0xFF00U) |
+                  ((lo << 8) & 0xFF0000U) | (lo << 24));
+            hi = ((hi >> 24) | ((hi >> 8) & 0xFF00U) |
+                  ((hi << 8) & 0xFF0000U) | (hi << 24));
+            memcpy(pOut + i, &hi, 4);
+            memcpy(pOut + i + 4, &lo, 4);
+        }
+#endif
+    }
+}
+
+MEM_UNIT_XFORM_INLINE void memUnitXformKernel_Widen(const memUnitXformKernel_T * const pKernel,
+                                                    const uint8_T *pIn,
+                                                    uint8_T *pOut,
+                                                    size_t n)
+{
+    const uint8_T typeSize = pKernel->typeSize;
+    const uint8_T tgtSize = pKernel->tgtSize;
+    const boolean_T hostLE = memUnitXformKernel_HostIsLittleEndian();
+    size_t i;
+    uint8_T k;
+
+    if ((typeSize == 1) && !pKernel->isSigned) {
+        /* Common case: 8 bit data on a 16 or 32 bit word addressable target */
+        const size_t valueOffset = pKernel->tgtIsLittleEndian ? 0 : tgtSize - 1;
+        memset(pOut, 0, n * tgtSize);
+        for (i = 0; i < n; i++) {
+            pOut[i * tgtSize + valueOffset] = pIn[i];
+        }
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        const uint8_T *src = pIn + i * typeSize;
+        uint8_T *dst = pOut + i * tgtSize;
+        const uint8_T msb = src[hostLE ? typeSize - 1 : 0];
+        const uint8_T fill = (pKernel->isSigned && (msb & 0x80)) ? 0xFF : 0x00;
+
+        /* k counts bytes from the least significant end */
+        for (k = 0; k < tgtSize; k++) {
+            const uint8_T b = (k < typeSize) ?
+                src[hostLE ? k : typeSize - 1 - k] : fill;
+            dst[pKernel->tgtIsLittleEndian ? k : tgtSize - 1 - k] = b;
+        }
+    }
+}
+
+MEM_UNIT_XFORM_INLINE void memUnitXformKernel_Narrow(const memUnitXformKernel_T * const pKernel,
+                                                     const uint8_T *pIn,
+                                                     uint8_T *pOut,
+                                                     size_t n)
+{
+    const uint8_T typeSize = pKernel->typeSize;
+    const uint8_T tgtSize = pKernel->tgtSize;
+    const boolean_T hostLE = memUnitXformKernel_HostIsLittleEndian();
+    size_t i;
+    uint8_T k;
+
+    if (typeSize == 1) {
+        const size_t valueOffset = pKernel->tgtIsLittleEndian ? 0 : tgtSize - 1;
+        for (i = 0; i < n; i++) {
+            pOut[i] = pIn[i * tgtSize + valueOffset];
+        }
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        const uint8_T *src = pIn + i * tgtSize;
+        uint8_T *dst = pOut + i * typeSize;
+
+        for (k = 0; k < typeSize; k++) {
+            dst[hostLE ? k : typeSize - 1 - k] =
+                src[pKernel->tgtIsLittleEndian ? k : tgtSize - 1 - k];
+        }
+    }
+}
+
+/* Transforms length host elements (outbound) or length target elements
+ * (inbound) from *pIn to *pOut and advances both pointers. For COPY and
+ * SWAP kernels *pIn and *pOut may point to the same buffer. */
+MEM_UNIT_XFORM_INLINE void memUnitXformKernel_Run(const memUnitXformKernel_T * const pKernel,
+                                                  void ** const pIn,
+                                                  void ** const pOut,
+                                                  const size_t length)
+{
+    const uint8_T *in = (const uint8_T*)*pIn;
+    uint8_T *out = (uint8_T*)*pOut;
+    size_t inSize = pKernel->typeSize;
+    size_t outSize = pKernel->typeSize;
+
+    switch (pKernel->kind) {
+      case MEM_UNIT_XFORM_KERNEL_COPY:
+        if (in != out) {
+            memcpy(out, in, length * inSize);
+        }
+        break;
+      case MEM_UNIT_XFORM_KERNEL_SWAP:
+        memUnitXformKernel_Swap(in, out, length, pKernel->typeSize);
+        break;
+      case MEM_UNIT_XFORM_KERNEL_WIDEN:
+        outSize = pKernel->tgtSize;
+        memUnitXformKernel_Widen(pKernel, in, out, length);
+        break;
+      case MEM_UNIT_XFORM_KERNEL_NARROW:
+        inSize = pKernel->tgtSize;
+        memUnitXformKernel_Narrow(pKernel, in, out, length);
+        break;
+    }
+
+    *pIn = (void*)(in + length * inSize);
+    *pOut = (void*)(out + length * outSize);
+}
+
+#endif
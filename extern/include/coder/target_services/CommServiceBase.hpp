@@ -97,6 +97,13 @@ protected:
             delete message;
             break;
 
+        case EchoMsg::ID:
+            new (message) EchoResponseMsg;
+            if (sendMessage(message) != TSE_SUCCESS) {
+                delete message;
+            }
+            break;
+
         case ConnectMsg::ID:
             new (message) ConnectResponseMsg;
             sendMessage(message);
@@ -104,6 +111,17 @@ protected:
             Application::connectionChanged(connected_);
             break;
 
+        case PoolStatsMsg::ID:
+            {
+                PoolStatsResponseMsg *psrm = new (message) PoolStatsResponseMsg;
+                assert(psrm->payloadCapacity() >= PoolStatsResponseMsg::PAYLOAD_SIZE);
+                psrm->poolStats_ = PoolStats::instance();
+                if (sendMessage(message) != TSE_SUCCESS) {
+                    delete message;
+                }
+                break;
+            }
+
         case HeartbeatMsg::ID:
             {
                 HeartbeatResponseMsg *hrm = new (message) HeartbeatResponseMsg;
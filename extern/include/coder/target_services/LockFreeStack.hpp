@@ -0,0 +1,184 @@
+/* Copyright 2013-2017 The MathWorks, Inc. */
+
+#ifndef coder_tgtsvc_LockFreeStack_hpp
+#define coder_tgtsvc_LockFreeStack_hpp
+
+#include <assert.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "coder_target_services_spec.h"
+
+#if defined(_MSC_VER) && !defined(__GNUC__)
+#include <intrin.h>
+#endif
+
+namespace coder { namespace tgtsvc {
+
+namespace detail {
+
+/* Primitives used by the memory service. Only single-word atomics are
+ * used, so nothing needs libatomic: the head of LockFreeStack packs the top
+ * pointer and a change counter into one 64-bit word.
+ *
+ *   - 64-bit x86 and ARM: the pointer takes the low 48 bits (user space
+ *     addresses) and the counter the high 16 bits.
+ *   - 32-bit targets with a native 64-bit compare-and-swap: 32 bits each.
+ *
+ * CODER_TGTSVC_HAVE_ATOMICS is defined when atomicAdd is atomic, and
+ * CODER_TGTSVC_HAVE_LOCKFREE_STACK when LockFreeStack is available. On
+ * other targets MemoryServiceBase has no default free lists and the
+ * Derived service must provide popChunk/pushChunk. */
+#if defined(__GNUC__)
+
+#define CODER_TGTSVC_HAVE_ATOMICS 1
+
+template <class T> inline void atomicAdd(T *p, T v) {
+    __atomic_fetch_add(p, v, __ATOMIC_RELAXED);
+}
+
+#if (defined(__x86_64__) || defined(__aarch64__)) && (__SIZEOF_POINTER__ == 8)
+#define CODER_TGTSVC_HAVE_LOCKFREE_STACK 1
+#define CODER_TGTSVC_STACK_PTR_BITS 48
+#elif (__SIZEOF_POINTER__ == 4) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+#define CODER_TGTSVC_HAVE_LOCKFREE_STACK 1
+#define CODER_TGTSVC_STACK_PTR_BITS 32
+#endif
+
+#ifdef CODER_TGTSVC_HAVE_LOCKFREE_STACK
+
+typedef uint64_t StackWord __attribute__((aligned(8)));
+
+inline uint64_t atomicLoadAcquire(const StackWord *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+inline bool atomicCompareExchange(StackWord *p, uint64_t *expected, uint64_t desired) {
+    return __atomic_compare_exchange_n(p, expected, desired, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+template <class T> inline T *atomicLoadRelaxed(T *const *p) {
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+template <class T> inline void atomicStoreRelaxed(T **p, T *v) {
+    __atomic_store_n(p, v, __ATOMIC_RELAXED);
+}
+
+#endif
+
+#elif defined(_MSC_VER)
+
+#define CODER_TGTSVC_HAVE_ATOMICS 1
+
+inline void atomicAdd(uint32_t *p, uint32_t v) {
+    (void)_InterlockedExchangeAdd(reinterpret_cast<volatile long*>(p), (long)v);
+}
+
+inline void atomicAdd(uint16_t *p, uint16_t v) {
+    (void)_InterlockedExchangeAdd16(reinterpret_cast<volatile short*>(p), (short)v);
+}
+
+#if defined(_M_X64) || defined(_M_ARM64)
+#define CODER_TGTSVC_HAVE_LOCKFREE_STACK 1
+#define CODER_TGTSVC_STACK_PTR_BITS 48
+#elif defined(_M_IX86) || defined(_M_ARM)
+#define CODER_TGTSVC_HAVE_LOCKFREE_STACK 1
+#define CODER_TGTSVC_STACK_PTR_BITS 32
+#endif
+
+#ifdef CODER_TGTSVC_HAVE_LOCKFREE_STACK
+
+typedef __declspec(align(8)) volatile __int64 StackWord;
+
+/* the interlocked intrinsics are full barriers */
+inline uint64_t atomicLoadAcquire(StackWord *p) {
+    return (uint64_t)_InterlockedCompareExchange64(p, 0, 0);
+}
+
+inline bool atomicCompareExchange(StackWord *p, uint64_t *expected, uint64_t desired) {
+    uint64_t seen = (uint64_t)_InterlockedCompareExchange64(p, (__int64)desired,
+                                                            (__int64)*expected);
+    if (seen == *expected) return true;
+    *expected = seen;
+    return false;
+}
+
+template <class T> inline T *atomicLoadRelaxed(T *const *p) {
+    return *const_cast<T *const volatile *>(p);
+}
+
+template <class T> inline void atomicStoreRelaxed(T **p, T *v) {
+    *const_cast<T *volatile *>(p) = v;
+}
+
+#endif
+
+#endif
+
+#ifdef CODER_TGTSVC_HAVE_LOCKFREE_STACK
+
+/* Treiber stack of free nodes. The link to the next node is kept in the
+ * first word of the node itself, so a node must be at least pointer sized
+ * and its memory must never be returned to the system while the stack is
+ * in use. The head carries a counter that changes on every update, so a
+ * node that is popped and pushed back between another thread's read of the
+ * head and its compare-and-swap cannot be mistaken for an unchanged head.
+ *
+ * The stack has no constructor: a zero-initialized stack (static storage,
+ * or after clear()) is empty. */
+template <class Node>
+class LockFreeStack
+{
+public:
+    void push(Node *n) {
+        assert(((uint64_t)(uintptr_t)n & ~PTR_MASK) == 0);
+
+        uint64_t oldHead = atomicLoadAcquire(&head_);
+        do {
+            atomicStoreRelaxed(&nextOf(n), top(oldHead));
+        } while (!atomicCompareExchange(&head_, &oldHead, make(n, oldHead)));
+    }
+
+    Node *pop() {
+        uint64_t oldHead = atomicLoadAcquire(&head_);
+        Node *n;
+        do {
+            n = top(oldHead);
+            if (n == NULL) return NULL;
+            /* n may already be popped and reused by another thread; the
+             * counter then makes the compare-and-swap fail */
+        } while (!atomicCompareExchange(&head_, &oldHead,
+                                        make(atomicLoadRelaxed(&nextOf(n)), oldHead)));
+        return n;
+    }
+
+    /* Only while no other thread uses the stack */
+    void clear() { head_ = 0; }
+
+private:
+    StackWord head_;
+
+    static const uint64_t PTR_MASK =
+        (((uint64_t)1) << CODER_TGTSVC_STACK_PTR_BITS) - 1;
+
+    static Node *top(uint64_t head) {
+        return reinterpret_cast<Node*>((uintptr_t)(head & PTR_MASK));
+    }
+
+    /* new head with top n and the counter of oldHead plus one */
+    static uint64_t make(Node *n, uint64_t oldHead) {
+        uint64_t tag = (oldHead >> CODER_TGTSVC_STACK_PTR_BITS) + 1;
+        return (uint64_t)(uintptr_t)n | (tag << CODER_TGTSVC_STACK_PTR_BITS);
+    }
+
+    static Node *&nextOf(Node *n) { return *reinterpret_cast<Node**>(n); }
+};
+
+#endif
+
+}
+
+}}
+
+#endif
@@ -7,6 +7,8 @@
 #include <stdlib.h>
 #include "coder_target_services_spec.h"
 #include "SList.hpp"
+#include "LockFreeStack.hpp"
+#include "PoolStats.hpp"
 #include "StatusFlags.hpp"
 
 namespace coder { namespace tgtsvc {
@@ -42,25 +44,57 @@ struct Chunk : public SListBaseHook<> {
     }
 };
 
+/* Pool lookup table and default free lists of the memory service of type
+ * Derived. They are kept out of MemoryServiceBase, whose layout the
+ * prebuilt target services library is compiled against, so there is one
+ * set per Derived type and only one such service may exist at a time.
+ * Zero-initialized before any constructor runs. */
+template <class Derived>
+struct MemoryPools
+{
+    enum {
+        MAX_POOL_COUNT = 16,
+        LOOKUP_SIZE = 64
+    };
+
+    const void *owner_;
+    uint8_t lookupShift_;
+    uint8_t lookup_[LOOKUP_SIZE];
+
+#ifdef CODER_TGTSVC_HAVE_LOCKFREE_STACK
+    LockFreeStack<Chunk> freeChunks_[MAX_POOL_COUNT];
+#endif
+
+    static MemoryPools &instance() {
+        static MemoryPools pools;
+        return pools;
+    }
+};
+
 }
 
 template <class Derived>
 class CODER_TARGET_SERVICES_EXPORT_CLASS MemoryServiceBase
 {
 public:
-   
+    enum {
+        MAX_POOL_COUNT = detail::MemoryPools<Derived>::MAX_POOL_COUNT
+    };
+
     explicit MemoryServiceBase(const uint16_t *poolSizes, uint8_t poolCnt) :
     poolSizes_(poolSizes), poolCount_(poolCnt)
     {
-       
+        assert(poolCnt > 0 && poolCnt <= MAX_POOL_COUNT);
         for (uint8_t i=0; i<poolCount(); ++i) {
             assert(poolSize(i) % sizeof(void*) == 0);
             if (i>0) assert(poolSize(i) > poolSize(i-1));
             else assert(poolSize(i) >= sizeof(void*));
         }
+        initPools();
     }
 
     ~MemoryServiceBase() {
+        pools().owner_ = NULL;
     }
 
     uint16_t poolSize(uint8_t poolIdx) const {
@@ -85,8 +119,14 @@ public:
         if (c != NULL) {
             c->poolIndex(poolIdx);
             c->allocated(true);
+            PoolStats::instance().allocated(poolIdx);
         } else {
             StatusFlags::instance().set(StatusFlags::MEMORY_ALLOCATION_FAILED);
+            if (poolIdx < poolCount()) {
+                PoolStats::instance().failed(poolIdx);
+            } else {
+                PoolStats::instance().oversized();
+            }
         }
         return c;
     }
@@ -95,6 +135,7 @@ public:
         detail::Chunk *c = reinterpret_cast<detail::Chunk*>(p);
         assert(c != NULL && c->allocated() && c->poolIndex() < poolCount());
         c->allocated(false);
+        PoolStats::instance().freed(c->poolIndex());
         static_cast<Derived*>(this)->pushChunk(c);
     }
 
@@ -107,13 +148,56 @@ public:
 
     uint16_t maxCapacity() const { return poolSize(poolCount()-1); }
 
+#ifdef CODER_TGTSVC_HAVE_LOCKFREE_STACK
+    /* Default free lists, one lock-free stack per pool, safe to use from
+     * the model and the comm thread at the same time. Derived services that
+     * define their own popChunk/pushChunk hide these. */
+    detail::Chunk *popChunk(uint8_t poolIdx) {
+        assert(poolIdx < poolCount());
+        return pools().freeChunks_[poolIdx].pop();
+    }
+
+    void pushChunk(detail::Chunk *c) {
+        assert(c->poolIndex() < poolCount());
+        pools().freeChunks_[c->poolIndex()].push(c);
+    }
+#endif
+
 private:
     const uint16_t *poolSizes_;
     uint8_t poolCount_;
 
-    uint8_t whichPool(size_t requestSize) {
+    static detail::MemoryPools<Derived> &pools() {
+        return detail::MemoryPools<Derived>::instance();
+    }
+
+    void initPools() {
+        detail::MemoryPools<Derived> &p = pools();
+        assert(p.owner_ == NULL);
+        p.owner_ = this;
+
+        p.lookupShift_ = 0;
+        while ((maxCapacity() >> p.lookupShift_) >= p.LOOKUP_SIZE) ++p.lookupShift_;
+
         uint8_t r = 0;
-        while (r < poolCount() && poolSize(r) < requestSize) ++r;
+        for (size_t i=0; i<p.LOOKUP_SIZE; ++i) {
+            size_t low = i << p.lookupShift_;
+            while (r < poolCount() && poolSize(r) < low) ++r;
+            p.lookup_[i] = r;
+        }
+
+#ifdef CODER_TGTSVC_HAVE_LOCKFREE_STACK
+        /* chunks freed to an earlier service may no longer exist */
+        for (uint8_t i=0; i<MAX_POOL_COUNT; ++i) p.freeChunks_[i].clear();
+#endif
+    }
+
+    uint8_t whichPool(size_t requestSize) {
+        if (requestSize > maxCapacity()) return poolCount();
+
+        const detail::MemoryPools<Derived> &p = pools();
+        uint8_t r = p.lookup_[requestSize >> p.lookupShift_];
+        while (poolSize(r) < requestSize) ++r;
         return r;
     }
 
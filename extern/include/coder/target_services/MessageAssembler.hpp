@@ -4,9 +4,27 @@
 #define coder_tgtsvc_MessageAssembler_hpp
 
 #include <memory>
+#include <iterator>
+#include <string.h>
 
 namespace coder { namespace tgtsvc {
 
+namespace detail {
+
+template <typename Iterator>
+const uint8_t *contiguous_run(const Iterator &, const Iterator &, size_t &count) {
+    count = 0;
+    return NULL;
+}
+
+template <typename T>
+const uint8_t *contiguous_run(T * const &it, T * const &end, size_t &count) {
+    count = (size_t)(end - it);
+    return reinterpret_cast<const uint8_t*>(it);
+}
+
+}
+
 struct MessageAssembler
 {
     enum Return {
@@ -21,8 +39,8 @@ struct MessageAssembler
     Return assemble(Iterator &it, Iterator end) {
         while (it != end) {
 
-            while (it != end && pos_ < sizeof(MessageHeader)) {
-                headerAddr()[pos_++] = *it++;
+            if (pos_ < sizeof(MessageHeader)) {
+                pos_ += copy(it, end, headerAddr() + pos_, sizeof(MessageHeader) - pos_);
             }
             if (pos_ < sizeof(MessageHeader)) break;
 
@@ -32,9 +50,7 @@ struct MessageAssembler
                 msg_->header(hdr_);
             }
 
-            while (it != end && pos_ < msg_->transmitSize()) {
-                msg_->transmitStart()[pos_++] = *it++;
-            }
+            pos_ += copy(it, end, msg_->transmitStart() + pos_, msg_->transmitSize() - pos_);
 
             if (pos_ == msg_->transmitSize()) {
                 pos_ = 0;
@@ -57,6 +73,26 @@ private:
     MessageHeader hdr_;           
 
     uint8_t *headerAddr() { return reinterpret_cast<uint8_t*>(&hdr_); }
+
+   
+    template <typename Iterator>
+    static size_t copy(Iterator &it, Iterator end, uint8_t *dst, size_t want) {
+        using detail::contiguous_run;
+        size_t copied = 0;
+        while (copied < want && it != end) {
+            size_t run;
+            const uint8_t *src = contiguous_run(it, end, run);
+            if (run > 0) {
+                if (run > want - copied) run = want - copied;
+                memcpy(dst + copied, src, run);
+                std::advance(it, run);
+                copied += run;
+            } else {
+                dst[copied++] = *it++;
+            }
+        }
+        return copied;
+    }
 };
 
 }}
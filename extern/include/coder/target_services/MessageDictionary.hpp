@@ -2,6 +2,7 @@
 
 #include <coder/target_services/Message.hpp>
 #include <coder/target_services/StatusFlags.hpp>
+#include <coder/target_services/PoolStats.hpp>
 
 namespace coder { namespace tgtsvc {
 
@@ -17,6 +18,10 @@ enum {
     OUT_TEST_START_MSG_ID     = 9,
     OUT_TEST_RESULT_MSG_ID    = 10,
     TEST_CONCLUDED_MSG_ID     = 11,
+    ECHO_MSG_ID               = 12,
+    ECHO_RESPONSE_MSG_ID      = 13,
+    POOL_STATS_MSG_ID         = 14,
+    POOL_STATS_RESPONSE_MSG_ID = 15,
     COMM_SERVICE_ID = 0xFF
 };
 
@@ -215,4 +220,76 @@ public:
     uint8_t pad_;
 };
 
+class EchoMsg : public Message
+{
+public:
+    enum {
+        ID = ECHO_MSG_ID,
+        MIN_PAYLOAD_SIZE = sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint64_t)
+    };
+
+    explicit EchoMsg(uint16_t size) {
+        assert(size >= MIN_PAYLOAD_SIZE);
+        MessageHeader &h = header();
+        h.payloadSize_ = size;
+        h.appId_ = COMM_SERVICE_ID;
+        h.appFun_ = ID;
+    }
+
+    uint32_t sequence_;
+    uint32_t pad_;
+    uint64_t timestamp_;
+private:
+    EchoMsg();
+};
+
+class EchoResponseMsg : public Message
+{
+public:
+    enum {
+        ID = ECHO_RESPONSE_MSG_ID
+    };
+
+   
+    EchoResponseMsg() {
+        MessageHeader &h = header();
+        h.appId_ = COMM_SERVICE_ID;
+        h.appFun_ = ID;
+    }
+};
+
+class PoolStatsMsg : public Message
+{
+public:
+    enum {
+        ID = POOL_STATS_MSG_ID,
+        PAYLOAD_SIZE = 0
+    };
+
+    PoolStatsMsg() {
+        MessageHeader &h = header();
+        h.payloadSize_ = PAYLOAD_SIZE;
+        h.appId_ = COMM_SERVICE_ID;
+        h.appFun_ = ID;
+    }
+};
+
+class PoolStatsResponseMsg : public Message
+{
+public:
+    enum {
+        ID = POOL_STATS_RESPONSE_MSG_ID,
+        PAYLOAD_SIZE = sizeof(coder::tgtsvc::PoolStats)
+    };
+
+    PoolStatsResponseMsg() {
+        MessageHeader &h = header();
+        h.payloadSize_ = PAYLOAD_SIZE;
+        h.appId_ = COMM_SERVICE_ID;
+        h.appFun_ = ID;
+    }
+
+    coder::tgtsvc::PoolStats poolStats_;
+};
+
 }}
@@ -0,0 +1,72 @@
+/* Copyright 2013-2017 The MathWorks, Inc. */
+
+#ifndef coder_tgtsvc_PoolStats_hpp
+#define coder_tgtsvc_PoolStats_hpp
+
+#include <stdint.h>
+#include "coder_target_services_spec.h"
+#include "LockFreeStack.hpp"
+
+namespace coder { namespace tgtsvc {
+
+/* Memory pool usage of the first MAX_POOLS pools, maintained by
+ * MemoryServiceBase and sent to the host in PoolStatsResponseMsg. The
+ * counts are cumulative and wrap; the host takes differences between
+ * requests. Requests larger than every pool are counted in
+ * oversizeFailCount_. Without atomic primitives (see LockFreeStack.hpp) the
+ * counts are updated with plain arithmetic and are approximate when several
+ * threads allocate. */
+struct PoolStats
+{
+    enum {
+        MAX_POOLS = 5
+    };
+
+    struct Pool {
+        uint32_t allocCount_;
+        uint16_t inUse_;
+        uint16_t failCount_;
+    };
+
+    Pool pools_[MAX_POOLS];
+    uint16_t oversizeFailCount_;
+    uint16_t reserved_;
+
+    void allocated(uint8_t poolIdx) {
+        if (poolIdx < MAX_POOLS) {
+            add(&pools_[poolIdx].allocCount_, (uint32_t)1);
+            add(&pools_[poolIdx].inUse_, (uint16_t)1);
+        }
+    }
+
+    void freed(uint8_t poolIdx) {
+        if (poolIdx < MAX_POOLS) add(&pools_[poolIdx].inUse_, (uint16_t)-1);
+    }
+
+    void failed(uint8_t poolIdx) {
+        if (poolIdx < MAX_POOLS) add(&pools_[poolIdx].failCount_, (uint16_t)1);
+    }
+
+    void oversized() {
+        add(&oversizeFailCount_, (uint16_t)1);
+    }
+
+    /* Zero-initialized before any constructor runs */
+    static PoolStats &instance() {
+        static PoolStats stats;
+        return stats;
+    }
+
+private:
+    template <class T> static void add(T *p, T v) {
+#ifdef CODER_TGTSVC_HAVE_ATOMICS
+        detail::atomicAdd(p, v);
+#else
+        *p = (T)(*p + v);
+#endif
+    }
+};
+
+}}
+
+#endif
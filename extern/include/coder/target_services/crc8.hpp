@@ -30,6 +30,177 @@ const uint8_t crc8_table[] = {
     0x57, 0x69, 0x2b, 0x15
 };
 
+const uint8_t crc8_slice_table[7][256] = {
+    {
+        0x00, 0xc0, 0xe5, 0x25, 0xaf, 0x6f, 0x4a, 0x8a, 0x3b, 0xfb, 0xde, 0x1e,
+        0x94, 0x54, 0x71, 0xb1, 0x76, 0xb6, 0x93, 0x53, 0xd9, 0x19, 0x3c, 0xfc,
+        0x4d, 0x8d, 0xa8, 0x68, 0xe2, 0x22, 0x07, 0xc7, 0xec, 0x2c, 0x09, 0xc9,
+        0x43, 0x83, 0xa6, 0x66, 0xd7, 0x17, 0x32, 0xf2, 0x78, 0xb8, 0x9d, 0x5d,
+        0x9a, 0x5a, 0x7f, 0xbf, 0x35, 0xf5, 0xd0, 0x10, 0xa1, 0x61, 0x44, 0x84,
+        0x0e, 0xce, 0xeb, 0x2b, 0xbd, 0x7d, 0x58, 0x98, 0x12, 0xd2, 0xf7, 0x37,
+        0x86, 0x46, 0x63, 0xa3, 0x29, 0xe9, 0xcc, 0x0c, 0xcb, 0x0b, 0x2e, 0xee,
+        0x64, 0xa4, 0x81, 0x41, 0xf0, 0x30, 0x15, 0xd5, 0x5f, 0x9f, 0xba, 0x7a,
+        0x51, 0x91, 0xb4, 0x74, 0xfe, 0x3e, 0x1b, 0xdb, 0x6a, 0xaa, 0x8f, 0x4f,
+        0xc5, 0x05, 0x20, 0xe0, 0x27, 0xe7, 0xc2, 0x02, 0x88, 0x48, 0x6d, 0xad,
+        0x1c, 0xdc, 0xf9, 0x39, 0xb3, 0x73, 0x56, 0x96, 0x1f, 0xdf, 0xfa, 0x3a,
+        0xb0, 0x70, 0x55, 0x95, 0x24, 0xe4, 0xc1, 0x01, 0x8b, 0x4b, 0x6e, 0xae,
+        0x69, 0xa9, 0x8c, 0x4c, 0xc6, 0x06, 0x23, 0xe3, 0x52, 0x92, 0xb7, 0x77,
+        0xfd, 0x3d, 0x18, 0xd8, 0xf3, 0x33, 0x16, 0xd6, 0x5c, 0x9c, 0xb9, 0x79,
+        0xc8, 0x08, 0x2d, 0xed, 0x67, 0xa7, 0x82, 0x42, 0x85, 0x45, 0x60, 0xa0,
+        0x2a, 0xea, 0xcf, 0x0f, 0xbe, 0x7e, 0x5b, 0x9b, 0x11, 0xd1, 0xf4, 0x34,
+        0xa2, 0x62, 0x47, 0x87, 0x0d, 0xcd, 0xe8, 0x28, 0x99, 0x59, 0x7c, 0xbc,
+        0x36, 0xf6, 0xd3, 0x13, 0xd4, 0x14, 0x31, 0xf1, 0x7b, 0xbb, 0x9e, 0x5e,
+        0xef, 0x2f, 0x0a, 0xca, 0x40, 0x80, 0xa5, 0x65, 0x4e, 0x8e, 0xab, 0x6b,
+        0xe1, 0x21, 0x04, 0xc4, 0x75, 0xb5, 0x90, 0x50, 0xda, 0x1a, 0x3f, 0xff,
+        0x38, 0xf8, 0xdd, 0x1d, 0x97, 0x57, 0x72, 0xb2, 0x03, 0xc3, 0xe6, 0x26,
+        0xac, 0x6c, 0x49, 0x89
+    },
+    {
+        0x00, 0xeb, 0xb3, 0x58, 0x03, 0xe8, 0xb0, 0x5b, 0x06, 0xed, 0xb5, 0x5e,
+        0x05, 0xee, 0xb6, 0x5d, 0x0c, 0xe7, 0xbf, 0x54, 0x0f, 0xe4, 0xbc, 0x57,
+        0x0a, 0xe1, 0xb9, 0x52, 0x09, 0xe2, 0xba, 0x51, 0x18, 0xf3, 0xab, 0x40,
+        0x1b, 0xf0, 0xa8, 0x43, 0x1e, 0xf5, 0xad, 0x46, 0x1d, 0xf6, 0xae, 0x45,
+        0x14, 0xff, 0xa7, 0x4c, 0x17, 0xfc, 0xa4, 0x4f, 0x12, 0xf9, 0xa1, 0x4a,
+        0x11, 0xfa, 0xa2, 0x49, 0x30, 0xdb, 0x83, 0x68, 0x33, 0xd8, 0x80, 0x6b,
+        0x36, 0xdd, 0x85, 0x6e, 0x35, 0xde, 0x86, 0x6d, 0x3c, 0xd7, 0x8f, 0x64,
+        0x3f, 0xd4, 0x8c, 0x67, 0x3a, 0xd1, 0x89, 0x62, 0x39, 0xd2, 0x8a, 0x61,
+        0x28, 0xc3, 0x9b, 0x70, 0x2b, 0xc0, 0x98, 0x73, 0x2e, 0xc5, 0x9d, 0x76,
+        0x2d, 0xc6, 0x9e, 0x75, 0x24, 0xcf, 0x97, 0x7c, 0x27, 0xcc, 0x94, 0x7f,
+        0x22, 0xc9, 0x91, 0x7a, 0x21, 0xca, 0x92, 0x79, 0x60, 0x8b, 0xd3, 0x38,
+        0x63, 0x88, 0xd0, 0x3b, 0x66, 0x8d, 0xd5, 0x3e, 0x65, 0x8e, 0xd6, 0x3d,
+        0x6c, 0x87, 0xdf, 0x34, 0x6f, 0x84, 0xdc, 0x37, 0x6a, 0x81, 0xd9, 0x32,
+        0x69, 0x82, 0xda, 0x31, 0x78, 0x93, 0xcb, 0x20, 0x7b, 0x90, 0xc8, 0x23,
+        0x7e, 0x95, 0xcd, 0x26, 0x7d, 0x96, 0xce, 0x25, 0x74, 0x9f, 0xc7, 0x2c,
+        0x77, 0x9c, 0xc4, 0x2f, 0x72, 0x99, 0xc1, 0x2a, 0x71, 0x9a, 0xc2, 0x29,
+        0x50, 0xbb, 0xe3, 0x08, 0x53, 0xb8, 0xe0, 0x0b, 0x56, 0xbd, 0xe5, 0x0e,
+        0x55, 0xbe, 0xe6, 0x0d, 0x5c, 0xb7, 0xef, 0x04, 0x5f, 0xb4, 0xec, 0x07,
+        0x5a, 0xb1, 0xe9, 0x02, 0x59, 0xb2, 0xea, 0x01, 0x48, 0xa3, 0xfb, 0x10,
+        0x4b, 0xa0, 0xf8, 0x13, 0x4e, 0xa5, 0xfd, 0x16, 0x4d, 0xa6, 0xfe, 0x15,
+        0x44, 0xaf, 0xf7, 0x1c, 0x47, 0xac, 0xf4, 0x1f, 0x42, 0xa9, 0xf1, 0x1a,
+        0x41, 0xaa, 0xf2, 0x19
+    },
+    {
+        0x00, 0xa2, 0x21, 0x83, 0x42, 0xe0, 0x63, 0xc1, 0x84, 0x26, 0xa5, 0x07,
+        0xc6, 0x64, 0xe7, 0x45, 0x6d, 0xcf, 0x4c, 0xee, 0x2f, 0x8d, 0x0e, 0xac,
+        0xe9, 0x4b, 0xc8, 0x6a, 0xab, 0x09, 0x8a, 0x28, 0xda, 0x78, 0xfb, 0x59,
+        0x98, 0x3a, 0xb9, 0x1b, 0x5e, 0xfc, 0x7f, 0xdd, 0x1c, 0xbe, 0x3d, 0x9f,
+        0xb7, 0x15, 0x96, 0x34, 0xf5, 0x57, 0xd4, 0x76, 0x33, 0x91, 0x12, 0xb0,
+        0x71, 0xd3, 0x50, 0xf2, 0xd1, 0x73, 0xf0, 0x52, 0x93, 0x31, 0xb2, 0x10,
+        0x55, 0xf7, 0x74, 0xd6, 0x17, 0xb5, 0x36, 0x94, 0xbc, 0x1e, 0x9d, 0x3f,
+        0xfe, 0x5c, 0xdf, 0x7d, 0x38, 0x9a, 0x19, 0xbb, 0x7a, 0xd8, 0x5b, 0xf9,
+        0x0b, 0xa9, 0x2a, 0x88, 0x49, 0xeb, 0x68, 0xca, 0x8f, 0x2d, 0xae, 0x0c,
+        0xcd, 0x6f, 0xec, 0x4e, 0x66, 0xc4, 0x47, 0xe5, 0x24, 0x86, 0x05, 0xa7,
+        0xe2, 0x40, 0xc3, 0x61, 0xa0, 0x02, 0x81, 0x23, 0xc7, 0x65, 0xe6, 0x44,
+        0x85, 0x27, 0xa4, 0x06, 0x43, 0xe1, 0x62, 0xc0, 0x01, 0xa3, 0x20, 0x82,
+        0xaa, 0x08, 0x8b, 0x29, 0xe8, 0x4a, 0xc9, 0x6b, 0x2e, 0x8c, 0x0f, 0xad,
+        0x6c, 0xce, 0x4d, 0xef, 0x1d, 0xbf, 0x3c, 0x9e, 0x5f, 0xfd, 0x7e, 0xdc,
+        0x99, 0x3b, 0xb8, 0x1a, 0xdb, 0x79, 0xfa, 0x58, 0x70, 0xd2, 0x51, 0xf3,
+        0x32, 0x90, 0x13, 0xb1, 0xf4, 0x56, 0xd5, 0x77, 0xb6, 0x14, 0x97, 0x35,
+        0x16, 0xb4, 0x37, 0x95, 0x54, 0xf6, 0x75, 0xd7, 0x92, 0x30, 0xb3, 0x11,
+        0xd0, 0x72, 0xf1, 0x53, 0x7b, 0xd9, 0x5a, 0xf8, 0x39, 0x9b, 0x18, 0xba,
+        0xff, 0x5d, 0xde, 0x7c, 0xbd, 0x1f, 0x9c, 0x3e, 0xcc, 0x6e, 0xed, 0x4f,
+        0x8e, 0x2c, 0xaf, 0x0d, 0x48, 0xea, 0x69, 0xcb, 0x0a, 0xa8, 0x2b, 0x89,
+        0xa1, 0x03, 0x80, 0x22, 0xe3, 0x41, 0xc2, 0x60, 0x25, 0x87, 0x04, 0xa6,
+        0x67, 0xc5, 0x46, 0xe4
+    },
+    {
+        0x00, 0x50, 0xa0, 0xf0, 0x25, 0x75, 0x85, 0xd5, 0x4a, 0x1a, 0xea, 0xba,
+        0x6f, 0x3f, 0xcf, 0x9f, 0x94, 0xc4, 0x34, 0x64, 0xb1, 0xe1, 0x11, 0x41,
+        0xde, 0x8e, 0x7e, 0x2e, 0xfb, 0xab, 0x5b, 0x0b, 0x4d, 0x1d, 0xed, 0xbd,
+        0x68, 0x38, 0xc8, 0x98, 0x07, 0x57, 0xa7, 0xf7, 0x22, 0x72, 0x82, 0xd2,
+        0xd9, 0x89, 0x79, 0x29, 0xfc, 0xac, 0x5c, 0x0c, 0x93, 0xc3, 0x33, 0x63,
+        0xb6, 0xe6, 0x16, 0x46, 0x9a, 0xca, 0x3a, 0x6a, 0xbf, 0xef, 0x1f, 0x4f,
+        0xd0, 0x80, 0x70, 0x20, 0xf5, 0xa5, 0x55, 0x05, 0x0e, 0x5e, 0xae, 0xfe,
+        0x2b, 0x7b, 0x8b, 0xdb, 0x44, 0x14, 0xe4, 0xb4, 0x61, 0x31, 0xc1, 0x91,
+        0xd7, 0x87, 0x77, 0x27, 0xf2, 0xa2, 0x52, 0x02, 0x9d, 0xcd, 0x3d, 0x6d,
+        0xb8, 0xe8, 0x18, 0x48, 0x43, 0x13, 0xe3, 0xb3, 0x66, 0x36, 0xc6, 0x96,
+        0x09, 0x59, 0xa9, 0xf9, 0x2c, 0x7c, 0x8c, 0xdc, 0x51, 0x01, 0xf1, 0xa1,
+        0x74, 0x24, 0xd4, 0x84, 0x1b, 0x4b, 0xbb, 0xeb, 0x3e, 0x6e, 0x9e, 0xce,
+        0xc5, 0x95, 0x65, 0x35, 0xe0, 0xb0, 0x40, 0x10, 0x8f, 0xdf, 0x2f, 0x7f,
+        0xaa, 0xfa, 0x0a, 0x5a, 0x1c, 0x4c, 0xbc, 0xec, 0x39, 0x69, 0x99, 0xc9,
+        0x56, 0x06, 0xf6, 0xa6, 0x73, 0x23, 0xd3, 0x83, 0x88, 0xd8, 0x28, 0x78,
+        0xad, 0xfd, 0x0d, 0x5d, 0xc2, 0x92, 0x62, 0x32, 0xe7, 0xb7, 0x47, 0x17,
+        0xcb, 0x9b, 0x6b, 0x3b, 0xee, 0xbe, 0x4e, 0x1e, 0x81, 0xd1, 0x21, 0x71,
+        0xa4, 0xf4, 0x04, 0x54, 0x5f, 0x0f, 0xff, 0xaf, 0x7a, 0x2a, 0xda, 0x8a,
+        0x15, 0x45, 0xb5, 0xe5, 0x30, 0x60, 0x90, 0xc0, 0x86, 0xd6, 0x26, 0x76,
+        0xa3, 0xf3, 0x03, 0x53, 0xcc, 0x9c, 0x6c, 0x3c, 0xe9, 0xb9, 0x49, 0x19,
+        0x12, 0x42, 0xb2, 0xe2, 0x37, 0x67, 0x97, 0xc7, 0x58, 0x08, 0xf8, 0xa8,
+        0x7d, 0x2d, 0xdd, 0x8d
+    },
+    {
+        0x00, 0x16, 0x2c, 0x3a, 0x58, 0x4e, 0x74, 0x62, 0xb0, 0xa6, 0x9c, 0x8a,
+        0xe8, 0xfe, 0xc4, 0xd2, 0x05, 0x13, 0x29, 0x3f, 0x5d, 0x4b, 0x71, 0x67,
+        0xb5, 0xa3, 0x99, 0x8f, 0xed, 0xfb, 0xc1, 0xd7, 0x0a, 0x1c, 0x26, 0x30,
+        0x52, 0x44, 0x7e, 0x68, 0xba, 0xac, 0x96, 0x80, 0xe2, 0xf4, 0xce, 0xd8,
+        0x0f, 0x19, 0x23, 0x35, 0x57, 0x41, 0x7b, 0x6d, 0xbf, 0xa9, 0x93, 0x85,
+        0xe7, 0xf1, 0xcb, 0xdd, 0x14, 0x02, 0x38, 0x2e, 0x4c, 0x5a, 0x60, 0x76,
+        0xa4, 0xb2, 0x88, 0x9e, 0xfc, 0xea, 0xd0, 0xc6, 0x11, 0x07, 0x3d, 0x2b,
+        0x49, 0x5f, 0x65, 0x73, 0xa1, 0xb7, 0x8d, 0x9b, 0xf9, 0xef, 0xd5, 0xc3,
+        0x1e, 0x08, 0x32, 0x24, 0x46, 0x50, 0x6a, 0x7c, 0xae, 0xb8, 0x82, 0x94,
+        0xf6, 0xe0, 0xda, 0xcc, 0x1b, 0x0d, 0x37, 0x21, 0x43, 0x55, 0x6f, 0x79,
+        0xab, 0xbd, 0x87, 0x91, 0xf3, 0xe5, 0xdf, 0xc9, 0x28, 0x3e, 0x04, 0x12,
+        0x70, 0x66, 0x5c, 0x4a, 0x98, 0x8e, 0xb4, 0xa2, 0xc0, 0xd6, 0xec, 0xfa,
+        0x2d, 0x3b, 0x01, 0x17, 0x75, 0x63, 0x59, 0x4f, 0x9d, 0x8b, 0xb1, 0xa7,
+        0xc5, 0xd3, 0xe9, 0xff, 0x22, 0x34, 0x0e, 0x18, 0x7a, 0x6c, 0x56, 0x40,
+        0x92, 0x84, 0xbe, 0xa8, 0xca, 0xdc, 0xe6, 0xf0, 0x27, 0x31, 0x0b, 0x1d,
+        0x7f, 0x69, 0x53, 0x45, 0x97, 0x81, 0xbb, 0xad, 0xcf, 0xd9, 0xe3, 0xf5,
+        0x3c, 0x2a, 0x10, 0x06, 0x64, 0x72, 0x48, 0x5e, 0x8c, 0x9a, 0xa0, 0xb6,
+        0xd4, 0xc2, 0xf8, 0xee, 0x39, 0x2f, 0x15, 0x03, 0x61, 0x77, 0x4d, 0x5b,
+        0x89, 0x9f, 0xa5, 0xb3, 0xd1, 0xc7, 0xfd, 0xeb, 0x36, 0x20, 0x1a, 0x0c,
+        0x6e, 0x78, 0x42, 0x54, 0x86, 0x90, 0xaa, 0xbc, 0xde, 0xc8, 0xf2, 0xe4,
+        0x33, 0x25, 0x1f, 0x09, 0x6b, 0x7d, 0x47, 0x51, 0x83, 0x95, 0xaf, 0xb9,
+        0xdb, 0xcd, 0xf7, 0xe1
+    },
+    {
+        0x00, 0xcb, 0xf3, 0x38, 0x83, 0x48, 0x70, 0xbb, 0x63, 0xa8, 0x90, 0x5b,
+        0xe0, 0x2b, 0x13, 0xd8, 0xc6, 0x0d, 0x35, 0xfe, 0x45, 0x8e, 0xb6, 0x7d,
+        0xa5, 0x6e, 0x56, 0x9d, 0x26, 0xed, 0xd5, 0x1e, 0xe9, 0x22, 0x1a, 0xd1,
+        0x6a, 0xa1, 0x99, 0x52, 0x8a, 0x41, 0x79, 0xb2, 0x09, 0xc2, 0xfa, 0x31,
+        0x2f, 0xe4, 0xdc, 0x17, 0xac, 0x67, 0x5f, 0x94, 0x4c, 0x87, 0xbf, 0x74,
+        0xcf, 0x04, 0x3c, 0xf7, 0xb7, 0x7c, 0x44, 0x8f, 0x34, 0xff, 0xc7, 0x0c,
+        0xd4, 0x1f, 0x27, 0xec, 0x57, 0x9c, 0xa4, 0x6f, 0x71, 0xba, 0x82, 0x49,
+        0xf2, 0x39, 0x01, 0xca, 0x12, 0xd9, 0xe1, 0x2a, 0x91, 0x5a, 0x62, 0xa9,
+        0x5e, 0x95, 0xad, 0x66, 0xdd, 0x16, 0x2e, 0xe5, 0x3d, 0xf6, 0xce, 0x05,
+        0xbe, 0x75, 0x4d, 0x86, 0x98, 0x53, 0x6b, 0xa0, 0x1b, 0xd0, 0xe8, 0x23,
+        0xfb, 0x30, 0x08, 0xc3, 0x78, 0xb3, 0x8b, 0x40, 0x0b, 0xc0, 0xf8, 0x33,
+        0x88, 0x43, 0x7b, 0xb0, 0x68, 0xa3, 0x9b, 0x50, 0xeb, 0x20, 0x18, 0xd3,
+        0xcd, 0x06, 0x3e, 0xf5, 0x4e, 0x85, 0xbd, 0x76, 0xae, 0x65, 0x5d, 0x96,
+        0x2d, 0xe6, 0xde, 0x15, 0xe2, 0x29, 0x11, 0xda, 0x61, 0xaa, 0x92, 0x59,
+        0x81, 0x4a, 0x72, 0xb9, 0x02, 0xc9, 0xf1, 0x3a, 0x24, 0xef, 0xd7, 0x1c,
+        0xa7, 0x6c, 0x54, 0x9f, 0x47, 0x8c, 0xb4, 0x7f, 0xc4, 0x0f, 0x37, 0xfc,
+        0xbc, 0x77, 0x4f, 0x84, 0x3f, 0xf4, 0xcc, 0x07, 0xdf, 0x14, 0x2c, 0xe7,
+        0x5c, 0x97, 0xaf, 0x64, 0x7a, 0xb1, 0x89, 0x42, 0xf9, 0x32, 0x0a, 0xc1,
+        0x19, 0xd2, 0xea, 0x21, 0x9a, 0x51, 0x69, 0xa2, 0x55, 0x9e, 0xa6, 0x6d,
+        0xd6, 0x1d, 0x25, 0xee, 0x36, 0xfd, 0xc5, 0x0e, 0xb5, 0x7e, 0x46, 0x8d,
+        0x93, 0x58, 0x60, 0xab, 0x10, 0xdb, 0xe3, 0x28, 0xf0, 0x3b, 0x03, 0xc8,
+        0x73, 0xb8, 0x80, 0x4b
+    },
+    {
+        0x00, 0x3c, 0x78, 0x44, 0xf0, 0xcc, 0x88, 0xb4, 0x85, 0xb9, 0xfd, 0xc1,
+        0x75, 0x49, 0x0d, 0x31, 0x6f, 0x53, 0x17, 0x2b, 0x9f, 0xa3, 0xe7, 0xdb,
+        0xea, 0xd6, 0x92, 0xae, 0x1a, 0x26, 0x62, 0x5e, 0xde, 0xe2, 0xa6, 0x9a,
+        0x2e, 0x12, 0x56, 0x6a, 0x5b, 0x67, 0x23, 0x1f, 0xab, 0x97, 0xd3, 0xef,
+        0xb1, 0x8d, 0xc9, 0xf5, 0x41, 0x7d, 0x39, 0x05, 0x34, 0x08, 0x4c, 0x70,
+        0xc4, 0xf8, 0xbc, 0x80, 0xd9, 0xe5, 0xa1, 0x9d, 0x29, 0x15, 0x51, 0x6d,
+        0x5c, 0x60, 0x24, 0x18, 0xac, 0x90, 0xd4, 0xe8, 0xb6, 0x8a, 0xce, 0xf2,
+        0x46, 0x7a, 0x3e, 0x02, 0x33, 0x0f, 0x4b, 0x77, 0xc3, 0xff, 0xbb, 0x87,
+        0x07, 0x3b, 0x7f, 0x43, 0xf7, 0xcb, 0x8f, 0xb3, 0x82, 0xbe, 0xfa, 0xc6,
+        0x72, 0x4e, 0x0a, 0x36, 0x68, 0x54, 0x10, 0x2c, 0x98, 0xa4, 0xe0, 0xdc,
+        0xed, 0xd1, 0x95, 0xa9, 0x1d, 0x21, 0x65, 0x59, 0xd7, 0xeb, 0xaf, 0x93,
+        0x27, 0x1b, 0x5f, 0x63, 0x52, 0x6e, 0x2a, 0x16, 0xa2, 0x9e, 0xda, 0xe6,
+        0xb8, 0x84, 0xc0, 0xfc, 0x48, 0x74, 0x30, 0x0c, 0x3d, 0x01, 0x45, 0x79,
+        0xcd, 0xf1, 0xb5, 0x89, 0x09, 0x35, 0x71, 0x4d, 0xf9, 0xc5, 0x81, 0xbd,
+        0x8c, 0xb0, 0xf4, 0xc8, 0x7c, 0x40, 0x04, 0x38, 0x66, 0x5a, 0x1e, 0x22,
+        0x96, 0xaa, 0xee, 0xd2, 0xe3, 0xdf, 0x9b, 0xa7, 0x13, 0x2f, 0x6b, 0x57,
+        0x0e, 0x32, 0x76, 0x4a, 0xfe, 0xc2, 0x86, 0xba, 0x8b, 0xb7, 0xf3, 0xcf,
+        0x7b, 0x47, 0x03, 0x3f, 0x61, 0x5d, 0x19, 0x25, 0x91, 0xad, 0xe9, 0xd5,
+        0xe4, 0xd8, 0x9c, 0xa0, 0x14, 0x28, 0x6c, 0x50, 0xd0, 0xec, 0xa8, 0x94,
+        0x20, 0x1c, 0x58, 0x64, 0x55, 0x69, 0x2d, 0x11, 0xa5, 0x99, 0xdd, 0xe1,
+        0xbf, 0x83, 0xc7, 0xfb, 0x4f, 0x73, 0x37, 0x0b, 0x3a, 0x06, 0x42, 0x7e,
+        0xca, 0xf6, 0xb2, 0x8e
+    }
+};
+
 static const uint8_t DEFAULT_CRC8_SEED = 0x6c;
 
 template <typename Iterator>
@@ -46,4 +217,29 @@ uint8_t crc8(Iterator it, Iterator end, uint8_t seed = DEFAULT_CRC8_SEED)
     return (uint8_t)(crc ^ 0xff);
 }
 
+inline uint8_t crc8(const uint8_t *it, const uint8_t *end, uint8_t seed = DEFAULT_CRC8_SEED)
+{
+    if (it == end)
+        return seed;
+
+    unsigned crc = seed ^ 0xff;
+    while (end - it >= 8) {
+        crc = crc8_slice_table[6][crc ^ it[0]] ^ crc8_slice_table[5][it[1]] ^
+              crc8_slice_table[4][it[2]] ^ crc8_slice_table[3][it[3]] ^
+              crc8_slice_table[2][it[4]] ^ crc8_slice_table[1][it[5]] ^
+              crc8_slice_table[0][it[6]] ^ crc8_table[it[7]];
+        it += 8;
+    }
+    while (it != end) {
+        crc = crc8_table[crc ^ *it];
+        ++it;
+    }
+    return (uint8_t)(crc ^ 0xff);
+}
+
+inline uint8_t crc8(uint8_t *it, uint8_t *end, uint8_t seed = DEFAULT_CRC8_SEED)
+{
+    return crc8(const_cast<const uint8_t*>(it), const_cast<const uint8_t*>(end), seed);
+}
+
 #endif
\ No newline at end of file
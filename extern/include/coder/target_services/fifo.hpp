@@ -32,6 +32,11 @@ struct circular_iterator : public std::iterator<std::random_access_iterator_tag,
     value_type &operator*() { return *it_; }
     const value_type &operator*() const { return *it_; }
 
+    const value_type *contiguous(const circular_iterator<value_type> &last, size_t &count) const {
+        count = last.it_ >= it_ ? (size_t)(last.it_ - it_) : (size_t)(end_ - it_);
+        return it_;
+    }
+
     value_type &operator[](size_t idx) {
         value_type *r = it_ + idx;
         ptrdiff_t wrap = end_ - begin_;
@@ -66,6 +71,13 @@ private:
     }
 };
 
+template <typename value_type>
+const uint8_t *contiguous_run(const circular_iterator<value_type> &it,
+                              const circular_iterator<value_type> &end, size_t &count)
+{
+    return reinterpret_cast<const uint8_t*>(it.contiguous(end, count));
+}
+
 template<typename T, size_t N>
 class fifo
 {
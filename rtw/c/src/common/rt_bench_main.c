@@ -0,0 +1,683 @@
+/*
+ * Copyright 2017 The MathWorks, Inc.
+ *
+ * File: rt_bench_main.c
+ *
+ * Abstract:
+ *
+ *   A benchmark main for generated Simulink Coder code. Where rt_main.c
+ *   runs the model to its stop time, this main measures how long the model
+ *   step takes: it runs a number of warm-up steps, then times a number of
+ *   steps of each task (tid) separately with a high resolution clock and
+ *   writes the statistics of the step times as JSON, for tracking step time
+ *   regressions across model and toolchain versions.
+ *
+ *   It uses the same call interface as rt_main.c (static, single output/
+ *   update function, terminate function) and runs the tasks of a
+ *   multitasking model one after the other, in the order rt_main.c does
+ *   when no task is preempted.
+ *
+ *   Command line options:
+ *
+ *     -w <steps>   warm-up base rate steps, not timed (default 1000)
+ *     -n <steps>   timed base rate steps (default 10000)
+ *     -cpu <n>     pin the process to processor n (Linux and Windows)
+ *     -perf        also count cycles, instructions and cache misses of each
+ *                  task with perf_event_open (Linux only)
+ *     -tf <time>   override the stop time, e.g. -tf inf, when the model
+ *                  has one (inf is stored as -1, the generated code's
+ *                  value for no stop time)
+ *     -o <file>    write the JSON to file instead of the standard output
+ *
+ *   The run ends early if the model stops, e.g. at its stop time; the JSON
+ *   then has "stoppedEarly": true and fewer timed steps.
+ *
+ * Required Defines:
+ *
+ *   MODEL - Model name
+ *   NUMST - Number of sample times
+ *
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE                    /* sched_setaffinity */
+#endif
+
+/*==================*
+ * Required defines *
+ *==================*/
+
+#ifndef MODEL
+# error Must specify a model name.  Define MODEL=name.
+#else
+/* create generic macros that work with any model */
+# define EXPAND_CONCAT(name1,name2) name1 ## name2
+# define CONCAT(name1,name2) EXPAND_CONCAT(name1,name2)
+# define MODEL_INITIALIZE CONCAT(MODEL,_initialize)
+# define MODEL_STEP       CONCAT(MODEL,_step)
+# define MODEL_TERMINATE  CONCAT(MODEL,_terminate)
+# define RT_MDL           CONCAT(MODEL,_M)
+#endif
+
+#ifndef NUMST
+# error Must specify the number of sample times.  Define NUMST=number.
+#endif
+
+#if CLASSIC_INTERFACE == 1
+# error "Classic call interface is not supported by rt_bench_main.c."
+#endif
+
+#if ONESTEPFCN==0
+#error Separate output and update functions are not supported by \
+rt_bench_main.c. Select the 'Single output/update function' option.
+#endif
+
+#if TERMFCN==0
+#error The terminate function is required by rt_bench_main.c. \
+Select the 'Terminate function required' option.
+#endif
+
+#if MULTI_INSTANCE_CODE==1
+#error rt_bench_main.c does not support reusable code generation.  \
+Deselect ERT option 'Generate reusable code'.
+#endif
+
+#if EXT_MODE==1
+#error External mode is not supported by rt_bench_main.c; external mode \
+communication would be timed with the model step.
+#endif
+
+#define QUOTE1(name) #name
+#define QUOTE(name) QUOTE1(name)    /* need to expand name    */
+
+#ifndef SAVEFILE
+# define MATFILE2(file) #file ".mat"
+# define MATFILE1(file) MATFILE2(file)
+# define MATFILE MATFILE1(MODEL)
+#else
+# define MATFILE QUOTE(SAVEFILE)
+#endif
+
+/*==========*
+ * Includes *
+ *==========*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <time.h>
+#endif
+
+#if defined(__linux__)
+# include <sched.h>
+# include <unistd.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <linux/perf_event.h>
+# define BENCH_HAVE_PERF 1
+#endif
+
+#include "rtwtypes.h"
+#include "rtmodel.h"
+
+#include "rt_logging.h"
+#ifdef UseMMIDataLogging
+#include "rt_logging_mmi.h"
+#endif
+
+#ifdef MODEL_STEP_FCN_CONTROL_USED
+#error rt_bench_main.c does not support model step function prototype control.
+#endif
+
+/*========================*
+ * Setup for multitasking *
+ *========================*/
+
+/*
+ * Let MT be synonym for MULTITASKING (to shorten command line for DOS)
+ */
+#if defined(MT)
+# if MT == 0
+# undef MT
+# else
+# define MULTITASKING 1
+# endif
+#endif
+
+#if defined(TID01EQ) && TID01EQ == 1
+#define FIRST_TID 1
+#else
+#define FIRST_TID 0
+#endif
+
+#if !defined(MULTITASKING)
+# define NUM_BENCH_TASKS 1
+#else
+# define NUM_BENCH_TASKS NUMST
+#endif
+
+#define BENCH_NUM_PERF_EVENTS 3         /* cycles, instructions, cache misses */
+
+/*====================*
+ * External functions *
+ *====================*/
+
+extern void MODEL_INITIALIZE(void);
+extern void MODEL_TERMINATE(void);
+
+#if !defined(MULTITASKING)
+ extern void MODEL_STEP(void);       /* single-rate step function */
+#else
+ extern void MODEL_STEP(int_T tid);  /* multirate step function */
+#endif
+
+
+/*==================================*
+ * Global data local to this module *
+ *==================================*/
+
+/* Step times and counters of one task */
+typedef struct {
+    double   *stepTimes;                /* seconds, one per timed step        */
+    size_t   numSteps;                  /* timed steps so far                 */
+    uint64_T perfCounts[BENCH_NUM_PERF_EVENTS];
+} BenchTask;
+
+static BenchTask benchTasks[NUM_BENCH_TASKS];
+static int       perfGroupFd = -1;      /* perf event group leader, or -1     */
+
+#if defined(MULTITASKING)
+static boolean_T eventFlags[NUMST];
+#endif
+
+/*=================*
+ * Local functions *
+ *=================*/
+
+/* Function: rt_BenchClock ====================================================
+ *
+ * Abstract:
+ *   High resolution monotonic clock, in seconds.
+ */
+static double rt_BenchClock(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER        count;
+
+    if (freq.QuadPart == 0) (void)QueryPerformanceFrequency(&freq);
+    (void)QueryPerformanceCounter(&count);
+    return((double)count.QuadPart / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+
+# if defined(CLOCK_MONOTONIC_RAW)
+    (void)clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+# else
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+# endif
+    return((double)ts.tv_sec + 1.0e-9*(double)ts.tv_nsec);
+#endif
+} /* end rt_BenchClock */
+
+/* Function: rt_BenchClockName ================================================
+ *
+ * Abstract:
+ *   Name of the clock used by rt_BenchClock, for the JSON output.
+ */
+static const char *rt_BenchClockName(void)
+{
+#if defined(_WIN32)
+    return("QueryPerformanceCounter");
+#elif defined(CLOCK_MONOTONIC_RAW)
+    return("CLOCK_MONOTONIC_RAW");
+#else
+    return("CLOCK_MONOTONIC");
+#endif
+} /* end rt_BenchClockName */
+
+/* Function: rt_BenchPinCpu ===================================================
+ *
+ * Abstract:
+ *   Pin the process to one processor so that the timed steps are not
+ *   migrated between processors.
+ *
+ * Returns:
+ *   0 on success, -1 if the processor cannot be selected on this host.
+ */
+static int rt_BenchPinCpu(int cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return(sched_setaffinity(0, sizeof(set), &set) == 0 ? 0 : -1);
+#elif defined(_WIN32)
+    if (cpu >= (int)(8*sizeof(DWORD_PTR))) return(-1);
+    return(SetProcessAffinityMask(GetCurrentProcess(),
+                                  (DWORD_PTR)1 << cpu) ? 0 : -1);
+#else
+    (void)cpu;
+    return(-1);
+#endif
+} /* end rt_BenchPinCpu */
+
+#ifdef BENCH_HAVE_PERF
+
+/* Function: rt_BenchOpenPerf =================================================
+ *
+ * Abstract:
+ *   Open a group of hardware counters (cycles, instructions, cache misses)
+ *   of this process, user space only, and start them.
+ *
+ * Returns:
+ *   0 on success, -1 if the counters are not available, e.g. because of
+ *   /proc/sys/kernel/perf_event_paranoid.
+ */
+static int rt_BenchOpenPerf(void)
+{
+    static const uint64_T config[BENCH_NUM_PERF_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES
+    };
+    struct perf_event_attr attr;
+    int                    i;
+
+    for (i = 0; i < BENCH_NUM_PERF_EVENTS; i++) {
+        long fd;
+
+        (void)memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.config         = config[i];
+        attr.read_format    = PERF_FORMAT_GROUP;
+        attr.disabled       = (i == 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+
+        fd = syscall(__NR_perf_event_open, &attr, 0, -1,
+                     (i == 0) ? -1 : perfGroupFd, 0);
+        if (fd < 0) {
+            if (perfGroupFd >= 0) (void)close(perfGroupFd);
+            perfGroupFd = -1;
+            return(-1);
+        }
+        if (i == 0) perfGroupFd = (int)fd;
+    }
+    (void)ioctl(perfGroupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    (void)ioctl(perfGroupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return(0);
+} /* end rt_BenchOpenPerf */
+
+/* Function: rt_BenchReadPerf =================================================
+ *
+ * Abstract:
+ *   Read the current values of the counters opened by rt_BenchOpenPerf.
+ */
+static void rt_BenchReadPerf(uint64_T counts[BENCH_NUM_PERF_EVENTS])
+{
+    uint64_T buf[1 + BENCH_NUM_PERF_EVENTS];   /* nr, then the values */
+    int      i;
+
+    if (read(perfGroupFd, buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+        (void)memset(buf, 0, sizeof(buf));
+    }
+    for (i = 0; i < BENCH_NUM_PERF_EVENTS; i++) {
+        counts[i] = buf[1 + i];
+    }
+} /* end rt_BenchReadPerf */
+
+#endif /* BENCH_HAVE_PERF */
+
+/* Function: rt_BenchStepTask =================================================
+ *
+ * Abstract:
+ *   Step the model for one task and, if timed, record how long it took and
+ *   the counter increments.
+ */
+static void rt_BenchStepTask(int_T tid, boolean_T timed)
+{
+    BenchTask *task = &benchTasks[tid];
+    double    tStart;
+#ifdef BENCH_HAVE_PERF
+    uint64_T  before[BENCH_NUM_PERF_EVENTS];
+    uint64_T  after[BENCH_NUM_PERF_EVENTS];
+    int       i;
+
+    if (timed && perfGroupFd >= 0) rt_BenchReadPerf(before);
+#endif
+
+    tStart = rt_BenchClock();
+#if !defined(MULTITASKING)
+    (void)tid;
+    MODEL_STEP();
+#else
+    MODEL_STEP(tid);
+#endif
+    if (!timed) return;
+
+    task->stepTimes[task->numSteps++] = rt_BenchClock() - tStart;
+
+#ifdef BENCH_HAVE_PERF
+    if (perfGroupFd >= 0) {
+        rt_BenchReadPerf(after);
+        for (i = 0; i < BENCH_NUM_PERF_EVENTS; i++) {
+            task->perfCounts[i] += after[i] - before[i];
+        }
+    }
+#endif
+} /* end rt_BenchStepTask */
+
+/* Function: rt_BenchOneStep ==================================================
+ *
+ * Abstract:
+ *   Perform one base rate step of the model and the subrate steps that are
+ *   due, in the order of rt_OneStep in rt_main.c.
+ */
+static void rt_BenchOneStep(boolean_T timed)
+{
+#if !defined(MULTITASKING)
+    rt_BenchStepTask(0, timed);
+#else
+    int_T i;
+
+    for (i = FIRST_TID+1; i < NUMST; i++) {
+        eventFlags[i] = rtmStepTask(RT_MDL,i);
+        if (++rtmTaskCounter(RT_MDL,i) == rtmCounterLimit(RT_MDL,i))
+            rtmTaskCounter(RT_MDL, i) = 0;
+    }
+
+    rt_BenchStepTask(0, timed);
+
+    for (i = FIRST_TID+1; i < NUMST; i++) {
+        if (eventFlags[i]) {
+            rt_BenchStepTask(i, timed);
+            eventFlags[i] = 0;
+        }
+    }
+#endif
+} /* end rt_BenchOneStep */
+
+/* Function: rt_BenchCompareTimes =============================================
+ *
+ * Abstract:
+ *   qsort comparison of step times.
+ */
+static int rt_BenchCompareTimes(const void *a, const void *b)
+{
+    double ta = *(const double *)a;
+    double tb = *(const double *)b;
+
+    return((ta > tb) - (ta < tb));
+} /* end rt_BenchCompareTimes */
+
+/* Function: rt_BenchPercentile ===============================================
+ *
+ * Abstract:
+ *   Percentile p (0..100) of sorted step times, nearest rank.
+ */
+static double rt_BenchPercentile(const double *sorted, size_t n, double p)
+{
+    size_t rank = (size_t)ceil(p/100.0*(double)n);
+
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return(sorted[rank-1]);
+} /* end rt_BenchPercentile */
+
+/* Function: rt_BenchWriteJson ================================================
+ *
+ * Abstract:
+ *   Write the benchmark settings and the step time statistics of each task
+ *   that ran. Times are in nanoseconds; counters are per step.
+ */
+static void rt_BenchWriteJson(FILE      *fp,
+                              long      numWarmup,
+                              long      numTimed,
+                              int       cpu,
+                              boolean_T stoppedEarly)
+{
+    int_T tid;
+    int_T first = 1;
+
+    (void)fprintf(fp, "{\n");
+    (void)fprintf(fp, "  \"model\": \"%s\",\n", QUOTE(MODEL));
+#if defined(__GNUC__) && !defined(__clang__)
+    (void)fprintf(fp, "  \"compiler\": \"gcc %s\",\n", __VERSION__);
+#elif defined(__VERSION__)
+    (void)fprintf(fp, "  \"compiler\": \"%s\",\n", __VERSION__);
+#elif defined(_MSC_FULL_VER)
+    (void)fprintf(fp, "  \"compiler\": \"MSVC %d\",\n", _MSC_FULL_VER);
+#else
+    (void)fprintf(fp, "  \"compiler\": \"\",\n");
+#endif
+    (void)fprintf(fp, "  \"numSampleTimes\": %d,\n", NUMST);
+#if defined(MULTITASKING)
+    (void)fprintf(fp, "  \"multitasking\": true,\n");
+#else
+    (void)fprintf(fp, "  \"multitasking\": false,\n");
+#endif
+    (void)fprintf(fp, "  \"clock\": \"%s\",\n", rt_BenchClockName());
+    (void)fprintf(fp, "  \"cpu\": %d,\n", cpu);
+    (void)fprintf(fp, "  \"warmupSteps\": %ld,\n", numWarmup);
+    (void)fprintf(fp, "  \"timedSteps\": %ld,\n", numTimed);
+    (void)fprintf(fp, "  \"stoppedEarly\": %s,\n",
+                  stoppedEarly ? "true" : "false");
+    (void)fprintf(fp, "  \"tasks\": [");
+
+    for (tid = 0; tid < NUM_BENCH_TASKS; tid++) {
+        BenchTask *task = &benchTasks[tid];
+        size_t    n     = task->numSteps;
+        double    sum   = 0.0;
+        double    sumSq = 0.0;
+        double    mean;
+        size_t    i;
+
+        if (n == 0) continue;
+
+        for (i = 0; i < n; i++) {
+            sum += task->stepTimes[i];
+        }
+        mean = sum/(double)n;
+        for (i = 0; i < n; i++) {
+            double d = task->stepTimes[i] - mean;
+            sumSq += d*d;
+        }
+        qsort(task->stepTimes, n, sizeof(double), rt_BenchCompareTimes);
+
+        (void)fprintf(fp, "%s\n    {\n", first ? "" : ",");
+        first = 0;
+        (void)fprintf(fp, "      \"tid\": %d,\n", (int)tid);
+        (void)fprintf(fp, "      \"steps\": %lu,\n", (unsigned long)n);
+        (void)fprintf(fp, "      \"minNs\": %.1f,\n", 1e9*task->stepTimes[0]);
+        (void)fprintf(fp, "      \"meanNs\": %.1f,\n", 1e9*mean);
+        (void)fprintf(fp, "      \"medianNs\": %.1f,\n",
+                      1e9*rt_BenchPercentile(task->stepTimes, n, 50.0));
+        (void)fprintf(fp, "      \"p90Ns\": %.1f,\n",
+                      1e9*rt_BenchPercentile(task->stepTimes, n, 90.0));
+        (void)fprintf(fp, "      \"p99Ns\": %.1f,\n",
+                      1e9*rt_BenchPercentile(task->stepTimes, n, 99.0));
+        (void)fprintf(fp, "      \"maxNs\": %.1f,\n", 1e9*task->stepTimes[n-1]);
+        (void)fprintf(fp, "      \"stddevNs\": %.1f", 1e9*sqrt(sumSq/(double)n));
+        if (perfGroupFd >= 0) {
+            (void)fprintf(fp, ",\n      \"perf\": {\"cycles\": %.1f, "
+                          "\"instructions\": %.1f, \"cacheMisses\": %.1f}",
+                          (double)task->perfCounts[0]/(double)n,
+                          (double)task->perfCounts[1]/(double)n,
+                          (double)task->perfCounts[2]/(double)n);
+        }
+        (void)fprintf(fp, "\n    }");
+    }
+    (void)fprintf(fp, "\n  ]\n}\n");
+} /* end rt_BenchWriteJson */
+
+/* Function: rt_BenchUsage ====================================================
+ *
+ * Abstract:
+ *   Print the command line options and return the exit status for a bad
+ *   command line.
+ */
+static int_T rt_BenchUsage(const char *prog)
+{
+    (void)fprintf(stderr, "usage: %s [-w warmupSteps] [-n timedSteps] "
+                  "[-cpu n] [-perf] [-tf stopTime] [-o file.json]\n", prog);
+    return(2);
+} /* end rt_BenchUsage */
+
+/*===================*
+ * Visible functions *
+ *===================*/
+
+/* Function: main =============================================================
+ *
+ * Abstract:
+ *   Benchmark the model step on a workstation.
+ */
+int_T main(int_T argc, const char *argv[])
+{
+    long        numWarmup = 1000;
+    long        numTimed  = 10000;
+    long        step;
+    int         cpu       = -1;
+    int         usePerf   = 0;
+    const char  *outFile  = NULL;
+    FILE        *fp       = stdout;
+    boolean_T   stoppedEarly = false;
+    boolean_T   setTFinal = false;
+    real_T      tFinal    = 0.0;
+    int_T       tid;
+    int_T       i;
+
+    /******************************
+     * Parse the command line     *
+     ******************************/
+    for (i = 1; i < argc; i++) {
+        const char *opt = argv[i];
+
+        if (strcmp(opt, "-perf") == 0) {
+            usePerf = 1;
+        } else if (i+1 >= argc) {
+            return(rt_BenchUsage(argv[0]));
+        } else if (strcmp(opt, "-w") == 0) {
+            numWarmup = atol(argv[++i]);
+        } else if (strcmp(opt, "-n") == 0) {
+            numTimed = atol(argv[++i]);
+        } else if (strcmp(opt, "-cpu") == 0) {
+            cpu = atoi(argv[++i]);
+        } else if (strcmp(opt, "-o") == 0) {
+            outFile = argv[++i];
+        } else if (strcmp(opt, "-tf") == 0) {
+            tFinal = (real_T)strtod(argv[++i], NULL);
+            setTFinal = true;
+        } else {
+            return(rt_BenchUsage(argv[0]));
+        }
+    }
+    if (numWarmup < 0 || numTimed < 1) return(rt_BenchUsage(argv[0]));
+
+    /*****************************************
+     * Pin the process, allocate, open perf *
+     *****************************************/
+    if (cpu >= 0 && rt_BenchPinCpu(cpu) != 0) {
+        (void)fprintf(stderr, "warning: could not pin to processor %d\n", cpu);
+        cpu = -1;
+    }
+
+    /* a subrate task runs at most once per base rate step */
+    for (tid = 0; tid < NUM_BENCH_TASKS; tid++) {
+        benchTasks[tid].stepTimes =
+            (double *)malloc((size_t)numTimed*sizeof(double));
+        if (benchTasks[tid].stepTimes == NULL) {
+            (void)fprintf(stderr, "memory allocation error\n");
+            return(1);
+        }
+    }
+
+    if (usePerf) {
+#ifdef BENCH_HAVE_PERF
+        if (rt_BenchOpenPerf() != 0) {
+            (void)fprintf(stderr, "warning: hardware counters are not "
+                          "available (see perf_event_paranoid)\n");
+        }
+#else
+        (void)fprintf(stderr, "warning: -perf is only supported on Linux\n");
+#endif
+    }
+
+    /************************
+     * Initialize the model *
+     ************************/
+    MODEL_INITIALIZE();
+
+    /* the initialize function sets the stop time, so override it after */
+    if (setTFinal) {
+#if defined(rtmGetTFinal)
+        /* the generated stop check takes -1 as no stop time */
+        rtmGetTFinal(RT_MDL) = (tFinal > DBL_MAX) ? -1.0 : tFinal;
+#else
+        (void)tFinal;
+        (void)fprintf(stderr, "warning: the model has no stop time; "
+                      "-tf ignored\n");
+#endif
+    }
+
+    /**************************************
+     * Warm up, then time the model steps *
+     **************************************/
+    for (step = 0; step < numWarmup + numTimed; step++) {
+        if (rtmGetErrorStatus(RT_MDL) != NULL ||
+            rtmGetStopRequested(RT_MDL)) {
+            stoppedEarly = true;
+            break;
+        }
+        rt_BenchOneStep((boolean_T)(step >= numWarmup));
+    }
+    numTimed = (step > numWarmup) ? step - numWarmup : 0;
+    if (numWarmup > step) numWarmup = step;
+
+    /*******************************
+     * Cleanup and exit (optional) *
+     *******************************/
+
+#ifdef UseMMIDataLogging
+    rt_CleanUpForStateLogWithMMI(rtmGetRTWLogInfo(RT_MDL));
+#endif
+    rt_StopDataLogging(MATFILE,rtmGetRTWLogInfo(RT_MDL));
+
+    MODEL_TERMINATE();
+
+    if (outFile != NULL && (fp = fopen(outFile, "w")) == NULL) {
+        (void)fprintf(stderr, "could not open %s\n", outFile);
+        fp = stdout;
+    }
+    rt_BenchWriteJson(fp, numWarmup, numTimed, cpu, stoppedEarly);
+    if (fp != stdout) (void)fclose(fp);
+
+#ifdef BENCH_HAVE_PERF
+    if (perfGroupFd >= 0) (void)close(perfGroupFd);
+#endif
+    for (tid = 0; tid < NUM_BENCH_TASKS; tid++) {
+        free(benchTasks[tid].stepTimes);
+    }
+
+    {
+        const char_T *errStatus = (const char_T *) (rtmGetErrorStatus(RT_MDL));
+
+        if (errStatus != NULL && strcmp(errStatus, "Simulation finished")) {
+            (void)fprintf(stderr, "%s\n", errStatus);
+            return(1);
+        }
+    }
+
+    return(0);
+}
+
+/* [EOF] rt_bench_main.c */
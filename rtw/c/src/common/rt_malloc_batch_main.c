@@ -0,0 +1,562 @@
+/*
+ * Copyright 2017 The MathWorks, Inc.
+ *
+ * File    : rt_malloc_batch_main.c
+ *
+ * Abstract:
+ *      A batch version of rt_malloc_main.c that runs many instances of the
+ *      same model in one process, for fleet simulations. The instances are
+ *      created with the model's allocation function, split into contiguous
+ *      ranges, one per thread, and advanced in lockstep: every thread steps
+ *      each of its instances once, then waits at a barrier for the others
+ *      before the next major step. An instance that stops (e.g. at its stop
+ *      time or on an error) is not stepped again; the batch ends when all
+ *      instances have stopped.
+ *
+ *      Requires POSIX threads.
+ *
+ *      Command line options:
+ *
+ *        -n <count>     number of model instances (default 1)
+ *        -threads <n>   number of threads (default: one per processor, at
+ *                       most one per instance)
+ *        -local         create and initialize each instance on the thread
+ *                       that steps it, so that the data of the instances of
+ *                       one thread is allocated together, from that
+ *                       thread's heap and on its memory node, instead of
+ *                       interleaved in creation order on the main thread
+ *
+ *      With MAT-file logging, instance k writes <name>_<k>.mat, where
+ *      <name>.mat is the file rt_malloc_main.c would write.
+ *
+ *      The generated code must not share writable data between instances
+ *      (the default for code with a dynamic memory allocation function).
+ *
+ * Compiler specified defines:
+ *      MODEL=modelname - Required.
+ *	NUMST=#         - Required. Number of sample times.
+ *      TID01EQ=1 or 0  - Optional. Only define to 1 if sample time task
+ *                        id's 0 and 1 have equal rates.
+ *      MULTITASKING    - Optional. (use MT for a synonym).
+ *	SAVEFILE        - Optional (non-quoted) name of .mat file to create.
+ *			  Default is <MODEL>.mat
+ */
+
+/*==================*
+ * Required defines *
+ *==================*/
+
+#ifndef MODEL
+# error Must specify a model name.  Define MODEL=name.
+#else
+/* create generic macros that work with any model */
+# define EXPAND_CONCAT(name1,name2) name1 ## name2
+# define CONCAT(name1,name2) EXPAND_CONCAT(name1,name2)
+# define MODEL_INITIALIZE CONCAT(MODEL,_initialize)
+# define MODEL_STEP       CONCAT(MODEL,_step)
+# define MODEL_TERMINATE  CONCAT(MODEL,_terminate)
+# define RT_MDL_TYPE      CONCAT(MODEL,_M_TYPE)
+#endif
+
+#ifndef NUMST
+# error Must specify the number of sample times.  Define NUMST=number.
+#endif
+
+#if CLASSIC_INTERFACE == 1
+# error "Classic call interface is not supported by rt_malloc_batch_main.c."
+#endif
+
+#if ONESTEPFCN==0
+#error Separate output and update functions are not supported by \
+rt_malloc_batch_main.c. Select the 'Single output/update function' option.
+#endif
+
+#if TERMFCN==0
+#error The terminate function is required by rt_malloc_batch_main.c. \
+Select the 'Terminate function required' option.
+#endif
+
+#if ALLOCATIONFCN==0
+# error An allocation function is required by rt_malloc_batch_main.c. \
+Select the 'Use dynamic memory allocation for model initialization' option.
+#endif
+
+#if EXT_MODE==1
+# error External mode is not supported by rt_malloc_batch_main.c.
+#endif
+
+#define QUOTE1(name) #name
+#define QUOTE(name) QUOTE1(name)    /* need to expand name    */
+
+#ifndef SAVEFILE
+# define MATFILE2(file) #file ".mat"
+# define MATFILE1(file) MATFILE2(file)
+# define MATFILE MATFILE1(MODEL)
+#else
+# define MATFILE QUOTE(SAVEFILE)
+#endif
+
+/*==========*
+ * Includes *
+ *==========*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "rtwtypes.h"
+#include "rtmodel.h" /* optional for automated builds */
+
+#include "rt_logging.h"
+#ifdef UseMMIDataLogging
+#include "rt_logging_mmi.h"
+#endif
+
+#ifdef MODEL_STEP_FCN_CONTROL_USED
+#error rt_malloc_batch_main.c does not support model step function prototype control.
+#endif
+
+#if ROOT_IO_FORMAT != 2
+# error rt_malloc_batch_main.c requires root-level I/O to be passed as part \
+of model data structure. Set 'Pass root-level I/O as' parameter to 'Part of \
+model data structure'.
+#endif
+
+/*========================*
+ * Setup for multitasking *
+ *========================*/
+
+/*
+ * Let MT be synonym for MULTITASKING (to shorten command line for DOS)
+ */
+#if defined(MT)
+# if MT == 0
+# undef MT
+# else
+# define MULTITASKING 1
+# endif
+#endif
+
+#if defined(TID01EQ) && TID01EQ == 1
+#define FIRST_TID 1
+#else
+#define FIRST_TID 0
+#endif
+
+/*====================*
+ * External functions *
+ *====================*/
+extern RT_MDL_TYPE *MODEL(void);
+extern void MODEL_INITIALIZE(RT_MDL_TYPE *S);
+extern void MODEL_TERMINATE(RT_MDL_TYPE  *S);
+
+#if !defined(MULTITASKING)
+extern void MODEL_STEP(RT_MDL_TYPE *S);       /* single-rate step function */
+#else
+extern void MODEL_STEP(RT_MDL_TYPE *S, int_T tid);  /* multirate step function */
+#endif
+
+
+/*==================================*
+ * Global data local to this module *
+ *==================================*/
+
+/* One model instance */
+typedef struct {
+    RT_MDL_TYPE *S;
+    boolean_T   active;                /* still stepping                     */
+    const char  *errmsg;               /* creation error, NULL if none       */
+#if defined(MULTITASKING)
+    boolean_T   eventFlags[NUMST];
+#endif
+} BatchInstance;
+
+/* One thread and the instances [first, last) it steps */
+typedef struct {
+    pthread_t thread;
+    int_T     first;
+    int_T     last;
+} BatchWorker;
+
+/* Barrier that also sums a value over the threads that wait at it */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    int_T           numThreads;
+    int_T           numWaiting;
+    unsigned long   generation;
+    int_T           sum;
+    int_T           result;
+} BatchBarrier;
+
+static BatchInstance *batchInstances     = NULL;
+static int_T         numBatchInstances   = 1;
+static BatchWorker   *batchWorkers       = NULL;
+static boolean_T     createInWorkers     = false;
+static BatchBarrier  batchBarrier;
+
+const char *RT_MEMORY_ALLOCATION_ERROR = "memory allocation error";
+
+/*=================*
+ * Local functions *
+ *=================*/
+
+/* Function: rt_BatchBarrierWait ==============================================
+ *
+ * Abstract:
+ *   Wait until all threads have reached the barrier.
+ *
+ * Returns:
+ *   The sum of the values passed by all threads for this crossing.
+ */
+static int_T rt_BatchBarrierWait(BatchBarrier *b, int_T value)
+{
+    unsigned long generation;
+    int_T         result;
+
+    (void)pthread_mutex_lock(&b->mutex);
+    generation = b->generation;
+    b->sum    += value;
+    if (++b->numWaiting == b->numThreads) {
+        b->result     = b->sum;
+        b->sum        = 0;
+        b->numWaiting = 0;
+        b->generation++;
+        (void)pthread_cond_broadcast(&b->cond);
+    } else {
+        while (generation == b->generation) {
+            (void)pthread_cond_wait(&b->cond, &b->mutex);
+        }
+    }
+    /* result cannot change before this thread reaches the barrier again */
+    result = b->result;
+    (void)pthread_mutex_unlock(&b->mutex);
+
+    return(result);
+} /* end rt_BatchBarrierWait */
+
+/* Function: rt_BatchMatFileName ==============================================
+ *
+ * Abstract:
+ *   MAT-file name of instance idx: MATFILE with "_<idx>" before ".mat".
+ */
+static void rt_BatchMatFileName(int_T idx, char *name, size_t nameLen)
+{
+    const char *base = MATFILE;
+    size_t     len   = strlen(base);
+
+    if (len >= 4 && strcmp(base + len - 4, ".mat") == 0) len -= 4;
+    (void)snprintf(name, nameLen, "%.*s_%d.mat", (int)len, base, (int)idx);
+} /* end rt_BatchMatFileName */
+
+/* Function: rt_BatchCreateInstance ===========================================
+ *
+ * Abstract:
+ *   Allocate one model instance, start its data logging and initialize it,
+ *   as rt_malloc_main.c does for its single instance. On failure,
+ *   inst->errmsg is set and the instance is not stepped.
+ */
+static void rt_BatchCreateInstance(BatchInstance *inst)
+{
+    RT_MDL_TYPE  *S;
+    const char_T *errmsg;
+
+    inst->active = false;
+    inst->errmsg = NULL;
+#if defined(MULTITASKING)
+    (void)memset(inst->eventFlags, 0, sizeof(inst->eventFlags));
+#endif
+
+    inst->S = S = MODEL();
+    if (S == NULL) {
+        inst->errmsg = "memory allocation error during model registration";
+        return;
+    }
+    errmsg = (const char_T *) (rtmGetErrorStatus(S));
+    if (errmsg != NULL) {
+        inst->errmsg = errmsg;
+        return;
+    }
+
+#ifdef UseMMIDataLogging
+    rt_FillStateSigInfoFromMMI(rtmGetRTWLogInfo(S), &rtmGetErrorStatus(S));
+#endif
+    errmsg = rt_StartDataLogging(rtmGetRTWLogInfo(S),
+                                 rtmGetTFinal(S),
+                                 rtmGetStepSize(S),
+                                 &rtmGetErrorStatus(S));
+    if (errmsg != NULL) {
+        inst->errmsg = errmsg;
+        return;
+    }
+
+    MODEL_INITIALIZE(S);
+    inst->active = true;
+} /* end rt_BatchCreateInstance */
+
+/* Function: rt_BatchOneStep ==================================================
+ *
+ * Abstract:
+ *   Perform one major step of one instance. The instances of a thread are
+ *   stepped one after the other, so unlike rt_OneStep in rt_malloc_main.c
+ *   there are no overruns to check for.
+ */
+static void rt_BatchOneStep(BatchInstance *inst)
+{
+    RT_MDL_TYPE *S = inst->S;
+
+#if !defined(MULTITASKING)
+    MODEL_STEP(S);
+#else
+    int_T i;
+
+    for (i = FIRST_TID+1; i < NUMST; i++) {
+        inst->eventFlags[i] = rtmStepTask(S,i);
+        if (++rtmTaskCounter(S,i) == rtmCounterLimit(S,i))
+            rtmTaskCounter(S, i) = 0;
+    }
+
+    MODEL_STEP(S,0);
+
+    for (i = FIRST_TID+1; i < NUMST; i++) {
+        if (inst->eventFlags[i]) {
+            MODEL_STEP(S,i);
+            inst->eventFlags[i] = 0;
+        }
+    }
+#endif
+} /* end rt_BatchOneStep */
+
+/* Function: rt_BatchWorker ===================================================
+ *
+ * Abstract:
+ *   Thread body: create the instances of this thread if asked to, then step
+ *   them until all instances of all threads have stopped.
+ */
+static void *rt_BatchWorker(void *arg)
+{
+    BatchWorker *w = (BatchWorker *)arg;
+    int_T       numFailed = 0;
+    int_T       numActive;
+    int_T       i;
+
+    if (createInWorkers) {
+        for (i = w->first; i < w->last; i++) {
+            rt_BatchCreateInstance(&batchInstances[i]);
+            if (batchInstances[i].errmsg != NULL) numFailed++;
+        }
+    }
+
+    /* no instance runs unless all of them could be created */
+    if (rt_BatchBarrierWait(&batchBarrier, numFailed) != 0) return(NULL);
+
+    do {
+        numActive = 0;
+        for (i = w->first; i < w->last; i++) {
+            BatchInstance *inst = &batchInstances[i];
+
+            if (!inst->active) continue;
+            if (rtmGetErrorStatus(inst->S) != NULL ||
+                rtmGetStopRequested(inst->S)) {
+                inst->active = false;
+                continue;
+            }
+            rt_BatchOneStep(inst);
+            numActive++;
+        }
+    } while (rt_BatchBarrierWait(&batchBarrier, numActive) > 0);
+
+    return(NULL);
+} /* end rt_BatchWorker */
+
+/* Function: rt_BatchTermInstances ============================================
+ *
+ * Abstract:
+ *   Stop the data logging of and terminate all instances that were
+ *   allocated, printing the error status of those that did not finish.
+ *
+ * Returns:
+ *   The number of instances that failed.
+ */
+static int_T rt_BatchTermInstances(void)
+{
+    int_T numFailed = 0;
+    int_T i;
+
+    for (i = 0; i < numBatchInstances; i++) {
+        BatchInstance *inst = &batchInstances[i];
+        RT_MDL_TYPE   *S    = inst->S;
+        const char_T  *errStatus;
+
+        if (inst->errmsg != NULL) {
+            (void)fprintf(stderr, "instance %d: error during model "
+                          "creation: %s\n", (int)i, inst->errmsg);
+            numFailed++;
+        }
+        if (S == NULL) continue;
+
+        if (inst->errmsg == NULL) {
+            char matFile[1024];
+
+            rt_BatchMatFileName(i, matFile, sizeof(matFile));
+#ifdef UseMMIDataLogging
+            rt_CleanUpForStateLogWithMMI(rtmGetRTWLogInfo(S));
+#endif
+            rt_StopDataLogging(matFile,rtmGetRTWLogInfo(S));
+
+            errStatus = (const char_T *) (rtmGetErrorStatus(S));
+            if (errStatus != NULL && strcmp(errStatus, "Simulation finished")) {
+                (void)printf("instance %d: %s\n", (int)i, errStatus);
+                numFailed++;
+            }
+        }
+        MODEL_TERMINATE(S);
+    }
+    return(numFailed);
+} /* end rt_BatchTermInstances */
+
+/* Function: rt_BatchUsage ====================================================
+ *
+ * Abstract:
+ *   Print the command line options and return the exit status for a bad
+ *   command line.
+ */
+static int_T rt_BatchUsage(const char *prog)
+{
+    (void)fprintf(stderr, "usage: %s [-n instances] [-threads n] [-local]\n",
+                  prog);
+    return(2);
+} /* end rt_BatchUsage */
+
+/*===================*
+ * Visible functions *
+ *===================*/
+
+/* Function: main =============================================================
+ *
+ * Abstract:
+ *   Execute many instances of the model on a workstation.
+ */
+int_T main(int_T argc, const char *argv[])
+{
+    long            numProcs = sysconf(_SC_NPROCESSORS_ONLN);
+    int_T           numThreads = 0;
+    int_T           numCreated;
+    int_T           numFailed;
+    int_T           i;
+    struct timespec tStart, tEnd;
+
+    /******************************
+     * Parse the command line     *
+     ******************************/
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-local") == 0) {
+            createInWorkers = true;
+        } else if (strcmp(argv[i], "-n") == 0 && i+1 < argc) {
+            numBatchInstances = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-threads") == 0 && i+1 < argc) {
+            numThreads = atoi(argv[++i]);
+        } else {
+            return(rt_BatchUsage(argv[0]));
+        }
+    }
+    if (numBatchInstances < 1 || numThreads < 0) {
+        return(rt_BatchUsage(argv[0]));
+    }
+    if (numThreads == 0) numThreads = (numProcs > 0) ? (int_T)numProcs : 1;
+    if (numThreads > numBatchInstances) numThreads = numBatchInstances;
+
+#if MAT_FILE==0
+    printf("warning: the simulation will run with no stop time; "
+           "to change this behavior select the 'MAT-file logging' option\n");
+    fflush(NULL);
+#endif
+
+    batchInstances = (BatchInstance *)
+        calloc(numBatchInstances, sizeof(BatchInstance));
+    batchWorkers   = (BatchWorker *)calloc(numThreads, sizeof(BatchWorker));
+    if (batchInstances == NULL || batchWorkers == NULL) {
+        (void)fprintf(stderr, "%s\n", RT_MEMORY_ALLOCATION_ERROR);
+        return(1);
+    }
+
+    /* contiguous ranges of instances, sizes differing by at most one */
+    for (i = 0; i < numThreads; i++) {
+        batchWorkers[i].first = (int_T)((long)i*numBatchInstances/numThreads);
+        batchWorkers[i].last  =
+            (int_T)((long)(i+1)*numBatchInstances/numThreads);
+    }
+
+    /************************
+     * Create the instances *
+     ************************/
+    if (!createInWorkers) {
+        for (i = 0; i < numBatchInstances; i++) {
+            rt_BatchCreateInstance(&batchInstances[i]);
+            if (batchInstances[i].errmsg != NULL) {
+                numBatchInstances = i+1;
+                (void)rt_BatchTermInstances();
+                return(1);
+            }
+        }
+    }
+
+    (void)printf("\n** starting %d instances of the model on %d threads **\n",
+                 (int)numBatchInstances, (int)numThreads);
+
+    (void)pthread_mutex_init(&batchBarrier.mutex, NULL);
+    (void)pthread_cond_init(&batchBarrier.cond, NULL);
+    batchBarrier.numThreads = numThreads;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &tStart);
+
+    /************************************************************
+     * Step the instances; this thread takes the first range    *
+     ************************************************************/
+    for (numCreated = 1; numCreated < numThreads; numCreated++) {
+        if (pthread_create(&batchWorkers[numCreated].thread, NULL,
+                           rt_BatchWorker, &batchWorkers[numCreated]) != 0) {
+            break;
+        }
+    }
+    if (numCreated < numThreads) {
+        /*
+         * Let the threads that did start give up at the first barrier: it
+         * now waits for them and this thread only, which reports a failure.
+         */
+        (void)fprintf(stderr, "could not create thread %d\n", (int)numCreated);
+        (void)pthread_mutex_lock(&batchBarrier.mutex);
+        batchBarrier.numThreads = numCreated;
+        (void)pthread_mutex_unlock(&batchBarrier.mutex);
+        (void)rt_BatchBarrierWait(&batchBarrier, 1);
+    } else {
+        (void)rt_BatchWorker(&batchWorkers[0]);
+    }
+    for (i = 1; i < numCreated; i++) {
+        (void)pthread_join(batchWorkers[i].thread, NULL);
+    }
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &tEnd);
+    (void)printf("** %d instances finished in %.3f s **\n",
+                 (int)numBatchInstances,
+                 (double)(tEnd.tv_sec - tStart.tv_sec) +
+                 1.0e-9*(double)(tEnd.tv_nsec - tStart.tv_nsec));
+
+    /********************
+     * Cleanup and exit *
+     ********************/
+    numFailed = rt_BatchTermInstances();
+    if (numCreated < numThreads) numFailed++;
+
+    (void)pthread_cond_destroy(&batchBarrier.cond);
+    (void)pthread_mutex_destroy(&batchBarrier.mutex);
+    free(batchWorkers);
+    free(batchInstances);
+
+    return(numFailed == 0 ? 0 : 1);
+}
+
+/* EOF: rt_malloc_batch_main.c */
@@ -74,21 +74,64 @@
 #  endif
 #endif
 
-/* Function: IsEscapeChar ======================================================
+/* Escape lookup table ========================================================
  * Abstract:
- *  Returns true if the char belongs to the escape sequence, false otherwise.
+ *  One entry per byte value; non-zero for the bytes that must be escaped on
+ *  the comm line (packet_head 0x7e, packet_tail 0x03 and escape_character
+ *  0x7d).  Must be kept in sync with the HDLC definitions in ext_serial_pkt.h.
  */
-PRIVATE boolean_T IsEscapeChar(char c)
+static const uint8_T EscapeCharTable[256] = {
+    0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x00 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x10 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x20 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x30 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x40 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x50 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x60 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, /* 0x70 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x80 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x90 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0xA0 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0xB0 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0xC0 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0xD0 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0xE0 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0  /* 0xF0 */
+};
+
+/* Size of the chunks used to filter outgoing payload and to read incoming
+ * packet bytes. */
+#define SERIAL_PKT_CHUNK_SIZE 256
+
+#ifndef MIN
+#define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
+/* Function: CleanRunLength ====================================================
+ * Abstract:
+ *  Returns the number of leading bytes of src, up to 'bytes', that do not
+ *  need to be escaped.
+ */
+PRIVATE uint32_T CleanRunLength(const char *src, uint32_T bytes)
 {
-    if ((c == packet_head) ||
-        (c == packet_tail) ||
-        (c == escape_character)) {
-	return true;
+    const unsigned char *pSrc = (const unsigned char *)src;
+    uint32_T i = 0;
+
+    /* Unrolled by 4; most payload bytes are clean. */
+    while ((i + 4) <= bytes) {
+        if (EscapeCharTable[pSrc[i]])   return i;
+        if (EscapeCharTable[pSrc[i+1]]) return i+1;
+        if (EscapeCharTable[pSrc[i+2]]) return i+2;
+        if (EscapeCharTable[pSrc[i+3]]) return i+3;
+        i += 4;
     }
+    while (i < bytes) {
+        if (EscapeCharTable[pSrc[i]]) return i;
+        i++;
+    }
+    return bytes;
 
-    return false;
-
-} /* end IsEscapeChar */
+} /* end CleanRunLength */
 
 
 /* Function: Filter ============================================================
@@ -99,33 +142,74 @@ PRIVATE boolean_T IsEscapeChar(char c)
  *  byte exclusive or'd with the mask character.  If a byte does not conflict,
  *  it is unchanged.  Returns the new size of the buffer after filtering.
  *
+ *  Runs of bytes that do not conflict are copied with a single memcpy.
+ *
  * Note: In the worst case where every char is an escape char, the
  *       destination buffer will be 2 times the size of the source buffer.
  */
 PRIVATE uint32_T Filter(char *dest, char *src, uint32_T bytes)
 {
-    uint32_T i;
-    uint32_T newSize = bytes;
-    char     *pDest  = dest;
-    char     *pSrc   = src;
-
-    for (i=0 ; i<bytes ; i++, pSrc++) {
-	if (IsEscapeChar(*pSrc)) {
-	    *pDest = escape_character;
-	    pDest++;
-	    *pDest = (char)((*pSrc) ^ mask_character);
-	    pDest++;
-	    newSize++;
-	} else {
-	    *pDest = *pSrc;
-	    pDest++;
-	}
+    uint32_T i     = 0;
+    char     *pDest = dest;
+
+    while (i < bytes) {
+        uint32_T run = CleanRunLength(&src[i], bytes - i);
+
+        if (run > 0) {
+            memcpy(pDest, &src[i], run);
+            pDest += run;
+            i     += run;
+        }
+        if (i < bytes) {
+            *pDest = escape_character;
+            pDest++;
+            *pDest = (char)(src[i] ^ mask_character);
+            pDest++;
+            i++;
+        }
     }
-    return newSize;
+    return (uint32_T)(pDest - dest);
 
 } /* end Filter */
 
 
+/* Function: MinBytesToRead ====================================================
+ * Abstract:
+ *  Returns the minimum number of bytes that must still arrive on the comm
+ *  line before the packet being received can complete.  Every field is at
+ *  least as long on the line as it is once unescaped, so reading this many
+ *  bytes at once never consumes bytes belonging to the next packet.
+ */
+PRIVATE uint32_T MinBytesToRead(const ExtSerialPacket *pkt)
+{
+    uint32_T nBytes;
+
+    switch (pkt->state) {
+      case ESP_InType:
+        nBytes = (uint32_T)(sizeof(pkt->PacketType) - pkt->DataCount) +
+            (uint32_T)sizeof(pkt->size) + TAIL_SIZE;
+        break;
+      case ESP_InSize:
+        nBytes = (uint32_T)(sizeof(pkt->size) - pkt->DataCount) + TAIL_SIZE;
+        break;
+      case ESP_InPayload:
+        nBytes = (pkt->size - pkt->DataCount) + TAIL_SIZE;
+        break;
+      case ESP_InTail:
+        nBytes = (uint32_T)(sizeof(pkt->tail) - pkt->DataCount);
+        break;
+      case ESP_NoPacket:
+      case ESP_InHead:
+      default:
+        /* Unknown amount of line noise may precede a packet header. */
+        nBytes = 1;
+        break;
+    }
+    return MIN(nBytes, SERIAL_PKT_CHUNK_SIZE);
+
+} /* end MinBytesToRead */
+
+
 /* Function: Num2String ========================================================
  * Abstract:
  *  Translates unsigned long values into strings and returns the size of the
@@ -214,7 +298,9 @@ PUBLIC boolean_T SetExtSerialPacket(ExtSerialPacket *pkt, ExtSerialPort *portDev
     uint32_T  newByteCnt   = 0; /* Num bytes after filtering. */
     boolean_T error        = EXT_NO_ERROR;
 
+    uint32_T  chunkSize    = 0;
     char Buffer[sizeof(uint32_T)*2]; /* Local buffer for converting escape chars. */
+    char ChunkBuffer[SERIAL_PKT_CHUNK_SIZE*2]; /* Filtered payload chunk. */
 
     /* If not connected, return immediately. */
     if (!portDev->fConnected) return false;
@@ -243,11 +329,13 @@ PUBLIC boolean_T SetExtSerialPacket(ExtSerialPacket *pkt, ExtSerialPort *portDev
     error = ExtSerialPortSetData(portDev, Buffer, newByteCnt);
     if (error != EXT_NO_ERROR) goto EXIT_POINT;
 
-    /* Send the variable-sized packet buffer data. */
-    for (i=0; i<pkt->size; i++)
+    /* Send the variable-sized packet buffer data, one filtered chunk at a
+     * time. */
+    for (i=0; i<pkt->size; i+=chunkSize)
     {
-        newByteCnt = Filter(Buffer, &(pkt->Buffer[i]), 1);
-        error = ExtSerialPortSetData(portDev, Buffer, newByteCnt);
+        chunkSize  = MIN(pkt->size - i, SERIAL_PKT_CHUNK_SIZE);
+        newByteCnt = Filter(ChunkBuffer, &(pkt->Buffer[i]), chunkSize);
+        error = ExtSerialPortSetData(portDev, ChunkBuffer, newByteCnt);
         if (error != EXT_NO_ERROR) goto EXIT_POINT;
     }
 
@@ -276,8 +364,12 @@ PUBLIC boolean_T GetExtSerialPacket(ExtSerialPacket *pkt, ExtSerialPort *portDev
 {
     char      char1        = 0;
     uint32_T  numCharRecvd = 0;
+    uint32_T  bytesToRead  = 0;
+    uint32_T  rxIdx        = 0;
+    uint32_T  rxCount      = 0;
     boolean_T PacketError  = false;
     boolean_T error        = EXT_NO_ERROR;
+    char      rxBuffer[SERIAL_PKT_CHUNK_SIZE];
 
     /* If not connected, return immediately. */
     if (!portDev->fConnected) return EXT_ERROR;
@@ -293,18 +385,55 @@ PUBLIC boolean_T GetExtSerialPacket(ExtSerialPacket *pkt, ExtSerialPort *portDev
     pkt->inQuote      = false;
 
     for(;;) {
-        /* Get a character from input stream. */
-        error = ExtSerialPortGetData(portDev, &char1, 1, &numCharRecvd);    
-                
-        if (error != EXT_NO_ERROR) goto EXIT_POINT;
+        if (rxIdx == rxCount) {
+            /*
+             * Refill the local buffer with as many bytes as the packet is
+             * known to still need, so the comm line is not read one
+             * character at a time.  Bytes left over in the buffer can only
+             * occur if a corrupted packet is restarted or discarded part way
+             * through a chunk.
+             */
+            bytesToRead = MinBytesToRead(pkt);
+            error = ExtSerialPortGetData(portDev, rxBuffer, bytesToRead,
+                                         &numCharRecvd);
+
+            if (error != EXT_NO_ERROR) goto EXIT_POINT;
+
+            if (numCharRecvd != bytesToRead) {
+                pkt->state  = ESP_NoPacket;
+                pkt->cursor = 0;
+                error = EXT_ERROR;
+                goto EXIT_POINT;
+            }
+            rxIdx   = 0;
+            rxCount = numCharRecvd;
+        }
 
-        if (numCharRecvd != 1) {
-            pkt->state  = ESP_NoPacket;
-            pkt->cursor = 0;
-            error = EXT_ERROR;
-            goto EXIT_POINT;
+        /*
+         * Fast path: copy a run of bytes that need no unescaping straight
+         * into the payload buffer.
+         */
+        if ((pkt->state == ESP_InPayload) && !pkt->inQuote) {
+            uint32_T run = CleanRunLength(&rxBuffer[rxIdx],
+                                          MIN(rxCount - rxIdx,
+                                              pkt->size - pkt->DataCount));
+            if (run > 0) {
+                memcpy(pkt->cursor, &rxBuffer[rxIdx], run);
+                pkt->cursor    += run;
+                pkt->DataCount += run;
+                rxIdx          += run;
+                if (pkt->DataCount == pkt->size) {
+                    pkt->state = ESP_InTail;
+                    pkt->cursor = (char *)&pkt->tail;
+                    pkt->DataCount = 0;
+                }
+                continue;
+            }
         }
 
+        /* Get a character from the local buffer. */
+        char1 = rxBuffer[rxIdx++];
+
         /* Handle quoting and filtering (does not deal with xon/xoff issues). */
         switch (pkt->state) {
           case ESP_InType:
@@ -6,6 +6,9 @@
  *  Abstract:
  *      - provide utility functions common to rapid accelerator and RSim
  *        target
+ *      - compile with RAPID_INPORT_TU_CACHE to keep the inport TU tables
+ *        of a -i MAT-file in a cache file next to it, which later runs map
+ *        instead of validating and converting the MAT-file again
  *
  * Copyright 2007-2016 The MathWorks, Inc.
  ******************************************************************/
@@ -23,6 +26,14 @@
 #include  <math.h>
 #include  <float.h>
 #include  <ctype.h>
+#include  <time.h>
+
+#ifdef RAPID_INPORT_TU_CACHE
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
 
 /*
  * We want access to the real mx* routines in this file and not their RTW
@@ -77,6 +88,33 @@ void  *gblISigstreamManager = NULL;
 void  *gblOSigstreamManager = NULL;
 void  *slioCatalogue = NULL;
 
+/* MAT-file loads queued by rt_RapidQueueMatFileLoad */
+typedef struct {
+    const char          *fileName;
+    RapidMatFileLoadFcn loadFcn;
+    void                *arg;
+    double              loadTime;   /* seconds */
+    char                errmsg[RAPID_MAT_LOAD_ERRMSG_LEN];
+} RapidMatFileLoad;
+
+static RapidMatFileLoad *gblMatFileLoads    = NULL;
+static int_T            gblNumMatFileLoads = 0;
+static int_T            gblMaxMatFileLoads = 0;
+
+/* arguments of the inport load queued by rt_RapidQueueInportsMatFile;
+ * fileName is NULL when none is queued */
+static struct {
+    const char *fileName;
+    int        *matFileFormat;
+    int        isRaccel;
+} gblInportLoadArgs = { NULL, NULL, 0 };
+
+#ifdef RAPID_INPORT_TU_CACHE
+/* TU tables cache file mapped by rt_ReadInportTUCache */
+static void   *gblInportTUCacheMap     = NULL;
+static size_t gblInportTUCacheMapSize  = 0;
+#endif
+
 #define INVALID_DTYPE_ID   (-10)
 #define SINGLEVAR_MATRIX   (0)
 #define SINGLEVAR_STRUCT   (1)
@@ -839,6 +877,7 @@ static const char* setGblInportTUtableElement(int_T inportIdx,
     gblInportTUtables[inportIdx].ur = NULL;
     gblInportTUtables[inportIdx].ui = NULL;
     gblInportTUtables[inportIdx].time = NULL; 
+    gblInportTUtables[inportIdx].uNumBytes = 0;
     
     gblInportTUtables[inportIdx].complex = isComplex ? 1 : 0;    
     gblInportTUtables[inportIdx].isPeriodicFcnCall = isPeriodicFcnCall;
@@ -856,6 +895,11 @@ static const char* setGblInportTUtableElement(int_T inportIdx,
 
     gblInportTUtables[inportIdx].time = inportTimeDataPtr;
 
+    /* the data handed over without a copy are function-call counts */
+    gblInportTUtables[inportIdx].uNumBytes = (elementSize > 0) ?
+        elementSize*numOfTimePoints*portWidth :
+        ((matDataRe != NULL) ? numOfTimePoints*sizeof(uint_T) : 0);
+
     if (elementSize > 0) {
         /* allocate memory */
         gblInportTUtables[inportIdx].ur = 
@@ -1199,6 +1243,345 @@ EXIT_POINT:
 
 
 
+#ifdef RAPID_INPORT_TU_CACHE
+
+/*
+ * Inport TU tables cache file, in the byte order of the host that wrote it:
+ * an InportTUCacheHeader, one InportTUCacheRecord per root inport, then the
+ * time, real and imaginary data of the TU tables, each at an offset that is
+ * a multiple of INPORT_TU_CACHE_ALIGN. An offset of zero stands for a NULL
+ * array. Inports that share a time vector share its offset.
+ */
+#define INPORT_TU_CACHE_MAGIC  "RTINPTU1"
+#define INPORT_TU_CACHE_SUFFIX ".tucache"
+#define INPORT_TU_CACHE_ALIGN  16
+
+typedef struct {
+    char     magic[8];
+    uint32_T byteOrder;                /* 0x01020304 as written              */
+    int32_T  numInports;
+    uint64_T fileHash;                 /* of the -i MAT-file contents        */
+    uint64_T interfaceHash;            /* of the root inports of the model   */
+    uint64_T cacheSize;                /* bytes in the cache file            */
+    int32_T  matFileFormat;
+    int32_T  reserved[5];
+} InportTUCacheHeader;
+
+typedef struct {
+    int32_T  nTimePoints;
+    int32_T  uDataType;
+    int32_T  complex;
+    int32_T  currTimeIdx;
+    int32_T  isPeriodicFcnCall;
+    int32_T  reserved;
+    uint64_T uNumBytes;
+    uint64_T timeOffset;
+    uint64_T urOffset;
+    uint64_T uiOffset;
+} InportTUCacheRecord;
+
+
+/* Function: rt_InportTUCacheHash ============================================
+ * Abstract:
+ *      Add nBytes of data to a 64-bit FNV-1a hash.
+ */
+static uint64_T rt_InportTUCacheHash(uint64_T   hash,
+                                     const void *data,
+                                     size_t     nBytes)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    size_t              i;
+
+    for (i = 0; i < nBytes; i++) {
+        hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+    return(hash);
+
+} /* end rt_InportTUCacheHash */
+
+
+/* Function: rt_InportTUCacheKey =============================================
+ * Abstract:
+ *      Compute the key of the TU tables of an inport MAT-file: the hash of
+ *      the file contents and the hash of everything about the root inports
+ *      of the model that the TU tables depend on.
+ *
+ * Returns:
+ *	true    : success
+ *      false   : the MAT-file could not be read
+ */
+static bool rt_InportTUCacheKey(const char *inportFileName,
+                                int        isRaccel,
+                                uint64_T   *fileHash,
+                                uint64_T   *interfaceHash)
+{
+    static const uint64_T fnvOffset = 14695981039346656037ULL;
+    unsigned char         buf[65536];
+    FILE                  *fp;
+    size_t                nRead;
+    uint64_T              hash = fnvOffset;
+    int_T                 n    = gblNumRootInportBlks;
+
+    if ((fp = fopen(inportFileName, "rb")) == NULL) return(false);
+    while ((nRead = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        hash = rt_InportTUCacheHash(hash, buf, nRead);
+    }
+    if (ferror(fp)) {
+        (void)fclose(fp);
+        return(false);
+    }
+    (void)fclose(fp);
+    *fileHash = hash;
+
+    hash = rt_InportTUCacheHash(fnvOffset, &n, sizeof(n));
+    hash = rt_InportTUCacheHash(hash, &isRaccel, sizeof(isRaccel));
+    hash = rt_InportTUCacheHash(hash, gblInportDims, 2*n*sizeof(int_T));
+    hash = rt_InportTUCacheHash(hash, gblInportComplex, n*sizeof(int_T));
+    hash = rt_InportTUCacheHash(hash, gblInportInterpoFlag, n*sizeof(int_T));
+    hash = rt_InportTUCacheHash(hash, gblInportDataTypeIdx, n*sizeof(int_T));
+    hash = rt_InportTUCacheHash(hash, gblInportContinuous, n*sizeof(int_T));
+    *interfaceHash = hash;
+
+    return(true);
+
+} /* end rt_InportTUCacheKey */
+
+
+/* Function: rt_ReadInportTUCache ============================================
+ * Abstract:
+ *      Map an inport TU tables cache file and point gblInportTUtables into
+ *      it, if the file is complete and was written for the same key. The
+ *      mapping is private, so the TU tables can be written without changing
+ *      the file. rt_RapidFreeGbls unmaps it.
+ *
+ * Returns:
+ *	true    : the TU tables were set up from the cache file
+ *      false   : no usable cache file, nothing was changed
+ */
+static bool rt_ReadInportTUCache(const char *cacheFileName,
+                                 uint64_T   fileHash,
+                                 uint64_T   interfaceHash,
+                                 int        *matFileFormat)
+{
+    const InportTUCacheHeader *hdr;
+    const InportTUCacheRecord *rec;
+    rtInportTUtable           *tables = NULL;
+    char                      *map;
+    struct stat               st;
+    size_t                    size;
+    int_T                     i;
+    int                       fd;
+
+    if ((fd = open(cacheFileName, O_RDONLY)) < 0) return(false);
+    if (fstat(fd, &st) != 0 ||
+        (size_t)st.st_size < sizeof(InportTUCacheHeader)) {
+        (void)close(fd);
+        return(false);
+    }
+    size = (size_t)st.st_size;
+    map  = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                        fd, 0);
+    (void)close(fd);
+    if (map == (char *)MAP_FAILED) return(false);
+
+    hdr = (const InportTUCacheHeader *)map;
+    if (memcmp(hdr->magic, INPORT_TU_CACHE_MAGIC, sizeof(hdr->magic)) != 0 ||
+        hdr->byteOrder != 0x01020304U ||
+        hdr->numInports != gblNumRootInportBlks ||
+        hdr->fileHash != fileHash ||
+        hdr->interfaceHash != interfaceHash ||
+        hdr->cacheSize != (uint64_T)size ||
+        size < sizeof(InportTUCacheHeader) +
+               gblNumRootInportBlks*sizeof(InportTUCacheRecord)) {
+        goto ERROR_EXIT;
+    }
+
+    tables = (rtInportTUtable *)
+        malloc(sizeof(rtInportTUtable)*gblNumRootInportBlks);
+    if (tables == NULL) goto ERROR_EXIT;
+
+    rec = (const InportTUCacheRecord *)(map + sizeof(InportTUCacheHeader));
+    for (i = 0; i < gblNumRootInportBlks; i++, rec++) {
+        uint64_T timeBytes = (uint64_T)rec->nTimePoints*sizeof(double);
+
+        if ((rec->timeOffset != 0 &&
+             (rec->timeOffset > size || timeBytes > size - rec->timeOffset)) ||
+            (rec->urOffset != 0 &&
+             (rec->urOffset > size || rec->uNumBytes > size - rec->urOffset)) ||
+            (rec->uiOffset != 0 &&
+             (rec->uiOffset > size || rec->uNumBytes > size - rec->uiOffset))) {
+            goto ERROR_EXIT;
+        }
+        tables[i].time = (rec->timeOffset == 0) ? NULL :
+            (double *)(map + rec->timeOffset);
+        tables[i].ur = (rec->urOffset == 0) ? NULL : map + rec->urOffset;
+        tables[i].ui = (rec->uiOffset == 0) ? NULL : map + rec->uiOffset;
+        tables[i].uNumBytes         = (size_t)rec->uNumBytes;
+        tables[i].nTimePoints       = rec->nTimePoints;
+        tables[i].uDataType         = rec->uDataType;
+        tables[i].complex           = rec->complex;
+        tables[i].currTimeIdx       = rec->currTimeIdx;
+        tables[i].isPeriodicFcnCall = (rec->isPeriodicFcnCall != 0);
+    }
+
+    *matFileFormat          = hdr->matFileFormat;
+    gblInportTUtables       = tables;
+    gblInportTUCacheMap     = map;
+    gblInportTUCacheMapSize = size;
+    return(true);
+
+  ERROR_EXIT:
+    free(tables);
+    (void)munmap(map, size);
+    return(false);
+
+} /* end rt_ReadInportTUCache */
+
+
+/* Function: rt_WriteInportTUCachePad ========================================
+ * Abstract:
+ *      Write zeros to fp until *pos reaches offset.
+ */
+static bool rt_WriteInportTUCachePad(FILE *fp, uint64_T *pos, uint64_T offset)
+{
+    static const char zeros[INPORT_TU_CACHE_ALIGN] = {0};
+
+    while (*pos < offset) {
+        size_t n = (size_t)(offset - *pos);
+
+        if (n > sizeof(zeros)) n = sizeof(zeros);
+        if (fwrite(zeros, 1, n, fp) != n) return(false);
+        *pos += n;
+    }
+    return(true);
+
+} /* end rt_WriteInportTUCachePad */
+
+
+/* Function: rt_WriteInportTUCache ===========================================
+ * Abstract:
+ *      Save gblInportTUtables in a cache file for later runs. The file is
+ *      written under a temporary name and then renamed, so that runs
+ *      started at the same time never map a partly written cache. Failing
+ *      to write the cache only costs the next run the conversion.
+ */
+static void rt_WriteInportTUCache(const char *cacheFileName,
+                                  uint64_T   fileHash,
+                                  uint64_T   interfaceHash,
+                                  int        matFileFormat)
+{
+    InportTUCacheHeader hdr;
+    InportTUCacheRecord *recs   = NULL;
+    char                *tmpName = NULL;
+    FILE                *fp     = NULL;
+    uint64_T            pos;
+    int_T               n = gblNumRootInportBlks;
+    int_T               i, j;
+    bool                ok = false;
+
+    recs    = (InportTUCacheRecord *)calloc(n, sizeof(InportTUCacheRecord));
+    tmpName = (char *)malloc(strlen(cacheFileName) + 24);
+    if (recs == NULL || tmpName == NULL) goto EXIT_POINT;
+
+    /* lay out the data */
+    pos = sizeof(InportTUCacheHeader) + n*sizeof(InportTUCacheRecord);
+#define ALIGN_CACHE_POS(p) \
+    (((p) + INPORT_TU_CACHE_ALIGN - 1) & ~(uint64_T)(INPORT_TU_CACHE_ALIGN - 1))
+    for (i = 0; i < n; i++) {
+        const rtInportTUtable *tu = &gblInportTUtables[i];
+
+        recs[i].nTimePoints       = tu->nTimePoints;
+        recs[i].uDataType         = tu->uDataType;
+        recs[i].complex           = tu->complex;
+        recs[i].currTimeIdx       = tu->currTimeIdx;
+        recs[i].isPeriodicFcnCall = tu->isPeriodicFcnCall;
+        recs[i].uNumBytes         = tu->uNumBytes;
+
+        if (tu->time != NULL) {
+            for (j = 0; j < i; j++) {
+                if (gblInportTUtables[j].time == tu->time) break;
+            }
+            if (j < i) {
+                recs[i].timeOffset = recs[j].timeOffset;
+            } else {
+                recs[i].timeOffset = pos = ALIGN_CACHE_POS(pos);
+                pos += (uint64_T)tu->nTimePoints*sizeof(double);
+            }
+        }
+        if (tu->ur != NULL) {
+            recs[i].urOffset = pos = ALIGN_CACHE_POS(pos);
+            pos += tu->uNumBytes;
+        }
+        if (tu->ui != NULL) {
+            recs[i].uiOffset = pos = ALIGN_CACHE_POS(pos);
+            pos += tu->uNumBytes;
+        }
+    }
+#undef ALIGN_CACHE_POS
+
+    (void)memset(&hdr, 0, sizeof(hdr));
+    (void)memcpy(hdr.magic, INPORT_TU_CACHE_MAGIC, sizeof(hdr.magic));
+    hdr.byteOrder     = 0x01020304U;
+    hdr.numInports    = n;
+    hdr.fileHash      = fileHash;
+    hdr.interfaceHash = interfaceHash;
+    hdr.cacheSize     = pos;
+    hdr.matFileFormat = matFileFormat;
+
+    (void)sprintf(tmpName, "%s.%ld", cacheFileName, (long)getpid());
+    if ((fp = fopen(tmpName, "wb")) == NULL) goto EXIT_POINT;
+
+    if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+        fwrite(recs, sizeof(InportTUCacheRecord), n, fp) != (size_t)n) {
+        goto EXIT_POINT;
+    }
+    pos = sizeof(InportTUCacheHeader) + n*sizeof(InportTUCacheRecord);
+    for (i = 0; i < n; i++) {
+        const rtInportTUtable *tu = &gblInportTUtables[i];
+
+        if (tu->time != NULL && recs[i].timeOffset >= pos) {
+            size_t nBytes = tu->nTimePoints*sizeof(double);
+
+            if (!rt_WriteInportTUCachePad(fp, &pos, recs[i].timeOffset) ||
+                fwrite(tu->time, 1, nBytes, fp) != nBytes) goto EXIT_POINT;
+            pos += nBytes;
+        }
+        if (tu->ur != NULL) {
+            if (!rt_WriteInportTUCachePad(fp, &pos, recs[i].urOffset) ||
+                fwrite(tu->ur, 1, tu->uNumBytes, fp) != tu->uNumBytes) {
+                goto EXIT_POINT;
+            }
+            pos += tu->uNumBytes;
+        }
+        if (tu->ui != NULL) {
+            if (!rt_WriteInportTUCachePad(fp, &pos, recs[i].uiOffset) ||
+                fwrite(tu->ui, 1, tu->uNumBytes, fp) != tu->uNumBytes) {
+                goto EXIT_POINT;
+            }
+            pos += tu->uNumBytes;
+        }
+    }
+
+    ok = (pos == hdr.cacheSize);
+
+  EXIT_POINT:
+    if (fp != NULL) {
+        if (fclose(fp) != 0) ok = false;
+        if (ok && rename(tmpName, cacheFileName) != 0) ok = false;
+        if (!ok) (void)remove(tmpName);
+    }
+    if (!ok) {
+        printf("*** Warning: could not write the inport cache file %s ***\n",
+               cacheFileName);
+    }
+    free(tmpName);
+    free(recs);
+
+} /* end rt_WriteInportTUCache */
+
+#endif /* RAPID_INPORT_TU_CACHE */
+
+
 /* Function: FreeFNamePairList ================================================
  * Abstract:
  *	Free name pair lists.
@@ -1216,34 +1599,45 @@ static void FreeFNamePairList(FNamePair *list, int_T len)
 } /* end FreeFFnameList */
 
 
-/*==================*
- * Visible routines *
- *==================*/
+/* Function: rt_RemapFromFileBlockMatFile ====================================
+ * Abstract:
+ *      Fill in the file name and width of a From File block and remap the
+ *      "original" MAT-filename if told to do so by the user via a -f command
+ *      line switch.
+ */
+static void rt_RemapFromFileBlockMatFile(const char *origFileName,
+                                         int        originalWidth,
+                                         FrFInfo    *frFInfo)
+{
+    int_T i;
 
-/* Function: rt_RapidReadFromFileBlockMatFile ============================================
+    frFInfo->origFileName  = origFileName;
+    frFInfo->originalWidth = originalWidth;
+    frFInfo->newFileName   = origFileName; /* assume */
 
- *
+    for (i=0; i<gblNumFrFiles; i++) {
+        if (gblFrFNamepair[i].newName != NULL && \
+            strcmp(origFileName, gblFrFNamepair[i].oldName)==0) {
+            frFInfo->newFileName = gblFrFNamepair[i].newName; /* remap */
+            gblFrFNamepair[i].remapped = 1;
+            break;
+        }
+    }
+
+} /* end rt_RemapFromFileBlockMatFile */
+
+
+/* Function: rt_LoadFromFileBlockMatFile =====================================
  * Abstract:
- *      This function opens a "fromfile" matfile containing a TU matrix.
- *      The first row of the TU matrix contains a time vector, while
- *      successive rows contain one or more U vectors. This function
- *      expects to find one and only one matrix in the
- *      matfile which must be named "TU".
- *
- *      originalWidth    = only the number of U channels (minimum is 1)
- *      nptsPerSignal    = the length of the T vector.
- *      nptsTotal        = total number of point in entire TU matrix.
- *                         npoints equals: nptsPerChannel * (nchannels + 1)
- *
- * Returns:
- *	NULL    : success
- *      non-NULL: error message
+ *      Read the TU matrix of an already remapped From File block (arg is its
+ *      FrFInfo) into frFInfo->tuDataMatrix. On failure, the error message is
+ *      written to errmsg, which is left empty on success. Used both by
+ *      rt_RapidReadFromFileBlockMatFile and by the queued loads (see
+ *      rt_RapidQueueFromFileBlockMatFile).
  */
-const char *rt_RapidReadFromFileBlockMatFile(const char *origFileName,
-                                   int originalWidth,
-                                   FrFInfo * frFInfo)
+static void rt_LoadFromFileBlockMatFile(void *arg, char *errmsg)
 {
-    static char  errmsg[1024];
+    FrFInfo      *frFInfo = (FrFInfo *)arg;
     MATFile      *pmat;
     mxArray      *tuData_mxArray_ptr = NULL;
     const double *matData;
@@ -1254,27 +1648,6 @@ const char *rt_RapidReadFromFileBlockMatFile(const char *origFileName,
 
     errmsg[0] = '\0'; /* assume success */
 
-    /******************************************************************
-     * Remap the "original" MAT-filename if told to do by user via a *
-     * -f command line switch.                                        *
-     ******************************************************************/
-    {
-        int_T i;
-
-        frFInfo->origFileName  = origFileName;
-        frFInfo->originalWidth = originalWidth;
-        frFInfo->newFileName   = origFileName; /* assume */
-
-        for (i=0; i<gblNumFrFiles; i++) {
-            if (gblFrFNamepair[i].newName != NULL && \
-                strcmp(origFileName, gblFrFNamepair[i].oldName)==0) {
-                frFInfo->newFileName = gblFrFNamepair[i].newName; /* remap */
-                gblFrFNamepair[i].remapped = 1;
-                break;
-            }
-        }
-    }
-
     if ((pmat=matOpen(matFile=frFInfo->newFileName,"r")) == NULL) {
         (void)sprintf(errmsg,"could not open MAT-file '%s' containing "
                       "From File Block data", matFile);
@@ -1358,6 +1731,101 @@ EXIT_POINT:
         mxDestroyArray(tuData_mxArray_ptr);
     }
 
+} /* end rt_LoadFromFileBlockMatFile */
+
+
+/* Function: rt_LoadInportsMatFile ==========================================
+ * Abstract:
+ *      MAT-file load function queued by rt_RapidQueueInportsMatFile.
+ */
+static void rt_LoadInportsMatFile(void *arg, char *errmsg)
+{
+    const char *result;
+
+    (void)arg; /* gblInportLoadArgs */
+    result = rt_RapidReadInportsMatFile(gblInportLoadArgs.fileName,
+                                        gblInportLoadArgs.matFileFormat,
+                                        gblInportLoadArgs.isRaccel);
+    errmsg[0] = '\0';
+    if (result != NULL) {
+        (void)strncpy(errmsg, result, RAPID_MAT_LOAD_ERRMSG_LEN-1);
+        errmsg[RAPID_MAT_LOAD_ERRMSG_LEN-1] = '\0';
+    }
+
+} /* end rt_LoadInportsMatFile */
+
+
+/* Function: rt_MatFileLoadClock =============================================
+ * Abstract:
+ *      Wall clock in seconds, used to time MAT-file loads. Falls back to the
+ *      processor time where there is no monotonic clock.
+ */
+static double rt_MatFileLoadClock(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((double)ts.tv_sec + 1.0e-9*(double)ts.tv_nsec);
+#else
+    return((double)clock()/CLOCKS_PER_SEC);
+#endif
+} /* end rt_MatFileLoadClock */
+
+
+/* Function: rt_RunMatFileLoads ==============================================
+ * Abstract:
+ *      Run the queued MAT-file loads one after the other, timing each of
+ *      them.
+ */
+static void rt_RunMatFileLoads(void)
+{
+    int_T i;
+
+    for (i = 0; i < gblNumMatFileLoads; i++) {
+        RapidMatFileLoad *load   = &gblMatFileLoads[i];
+        double           tStart  = rt_MatFileLoadClock();
+
+        load->errmsg[0] = '\0';
+        load->loadFcn(load->arg, load->errmsg);
+        load->loadTime = rt_MatFileLoadClock() - tStart;
+    }
+
+} /* end rt_RunMatFileLoads */
+
+
+/*==================*
+ * Visible routines *
+ *==================*/
+
+/* Function: rt_RapidReadFromFileBlockMatFile ============================================
+
+ *
+ * Abstract:
+ *      This function opens a "fromfile" matfile containing a TU matrix.
+ *      The first row of the TU matrix contains a time vector, while
+ *      successive rows contain one or more U vectors. This function
+ *      expects to find one and only one matrix in the
+ *      matfile which must be named "TU".
+ *
+ *      originalWidth    = only the number of U channels (minimum is 1)
+ *      nptsPerSignal    = the length of the T vector.
+ *      nptsTotal        = total number of point in entire TU matrix.
+ *                         npoints equals: nptsPerChannel * (nchannels + 1)
+ *
+ * Returns:
+ *	NULL    : success
+ *      non-NULL: error message
+ */
+const char *rt_RapidReadFromFileBlockMatFile(const char *origFileName,
+                                   int originalWidth,
+                                   FrFInfo * frFInfo)
+{
+    static char errmsg[1024];
+
+    rt_RemapFromFileBlockMatFile(origFileName, originalWidth, frFInfo);
+    rt_LoadFromFileBlockMatFile(frFInfo, errmsg);
+
     return (errmsg[0] != '\0'? errmsg: NULL);
 
 } /* end rt_RapidReadFromFileBlockMatFile */
@@ -1385,6 +1853,12 @@ const char *rt_RapidReadInportsMatFile(const char* inportFileName, int* matFileF
     mxArray      *inportData_mxArray_ptr = NULL;
     mxLogical    *periodicFunctionCallInports = NULL;
     bool          externalInputIsInDatasetFormat = false;
+#ifdef RAPID_INPORT_TU_CACHE
+    char          *cacheFileName = NULL;
+    bool          haveCacheKey = false;
+    uint64_T      fileHash = 0;
+    uint64_T      interfaceHash = 0;
+#endif
    
     errmsg[0] = '\0'; /* assume success */
     
@@ -1412,6 +1886,24 @@ const char *rt_RapidReadInportsMatFile(const char* inportFileName, int* matFileF
         }
     }
 
+#ifdef RAPID_INPORT_TU_CACHE
+    /* TU tables of the same file from an earlier run? */
+    cacheFileName = (char *)malloc(strlen(inportFileName) +
+                                   sizeof(INPORT_TU_CACHE_SUFFIX));
+    if (cacheFileName != NULL) {
+        (void)strcpy(cacheFileName, inportFileName);
+        (void)strcat(cacheFileName, INPORT_TU_CACHE_SUFFIX);
+        haveCacheKey = rt_InportTUCacheKey(inportFileName, isRaccel,
+                                           &fileHash, &interfaceHash);
+    }
+    if (haveCacheKey && rt_ReadInportTUCache(cacheFileName, fileHash,
+                                             interfaceHash, matFileFormat)) {
+        printf(" *** %s is successfully loaded from %s! ***\n",
+               inportFileName, cacheFileName);
+        goto EXIT_POINT;
+    }
+#endif
+
     periodicFunctionCallInports = malloc(sizeof(mxLogical)*gblNumRootInportBlks);
     if (periodicFunctionCallInports == NULL) {
         (void)sprintf(errmsg,"Memory allocation error"); 
@@ -1441,7 +1933,17 @@ const char *rt_RapidReadInportsMatFile(const char* inportFileName, int* matFileF
     /* Reach here, data is successfully loaded */
     printf(" *** %s is successfully loaded! ***\n", inportFileName);
 
+#ifdef RAPID_INPORT_TU_CACHE
+    if (haveCacheKey) {
+        rt_WriteInportTUCache(cacheFileName, fileHash, interfaceHash,
+                              *matFileFormat);
+    }
+#endif
+
 EXIT_POINT:
+#ifdef RAPID_INPORT_TU_CACHE
+    free(cacheFileName);
+#endif
     
     if (pmat!=NULL) {
         matClose(pmat); pmat = NULL;
@@ -1460,6 +1962,166 @@ EXIT_POINT:
 } /* end rt_RapidReadInportsMatFile */
 
 
+/* Function: rt_RapidQueueMatFileLoad ========================================
+ *
+ * Abstract:
+ *      Queue a MAT-file load to be run by rt_RapidJoinMatFileLoads. loadFcn
+ *      is called with arg and an empty RAPID_MAT_LOAD_ERRMSG_LEN buffer, in
+ *      which it leaves an error message if the load fails. fileName is only
+ *      used to report the load time and must stay valid until the join.
+ *
+ * Returns:
+ *	NULL    : success
+ *      non-NULL: error message
+ */
+const char *rt_RapidQueueMatFileLoad(const char          *fileName,
+                                     RapidMatFileLoadFcn loadFcn,
+                                     void                *arg)
+{
+    RapidMatFileLoad *load;
+
+    if (gblNumMatFileLoads == gblMaxMatFileLoads) {
+        int_T            newMax   = (gblMaxMatFileLoads == 0) ?
+                                    8 : 2*gblMaxMatFileLoads;
+        RapidMatFileLoad *newList = (RapidMatFileLoad *)
+            realloc(gblMatFileLoads, newMax*sizeof(RapidMatFileLoad));
+
+        if (newList == NULL) {
+            return("memory allocation error (rt_RapidQueueMatFileLoad)");
+        }
+        gblMatFileLoads    = newList;
+        gblMaxMatFileLoads = newMax;
+    }
+
+    load = &gblMatFileLoads[gblNumMatFileLoads++];
+    load->fileName  = fileName;
+    load->loadFcn   = loadFcn;
+    load->arg       = arg;
+    load->loadTime  = 0.0;
+    load->errmsg[0] = '\0';
+
+    return(NULL);
+
+} /* end rt_RapidQueueMatFileLoad */
+
+
+/* Function: rt_RapidQueueInportsMatFile =====================================
+ *
+ * Abstract:
+ *      Queued version of rt_RapidReadInportsMatFile. The inport MAT-file is
+ *      read, and the TU tables are filled, by rt_RapidJoinMatFileLoads,
+ *      which returns any error. matFileFormat must stay valid until then.
+ *      Only one inport MAT-file can be queued per join.
+ *
+ * Returns:
+ *	NULL    : success
+ *      non-NULL: error message
+ */
+const char *rt_RapidQueueInportsMatFile(const char *inportFileName,
+                                        int        *matFileFormat,
+                                        int        isRaccel)
+{
+    const char *result;
+
+    /* nothing to read, only the warning about a missing -i to print */
+    if (gblNumRootInportBlks == 0 || inportFileName == NULL) {
+        return(rt_RapidReadInportsMatFile(inportFileName,
+                                          matFileFormat,
+                                          isRaccel));
+    }
+
+    if (gblInportLoadArgs.fileName != NULL) {
+        return("an inport MAT-file is already queued "
+               "(rt_RapidQueueInportsMatFile)");
+    }
+
+    gblInportLoadArgs.fileName      = inportFileName;
+    gblInportLoadArgs.matFileFormat = matFileFormat;
+    gblInportLoadArgs.isRaccel      = isRaccel;
+
+    result = rt_RapidQueueMatFileLoad(inportFileName,
+                                      rt_LoadInportsMatFile,
+                                      &gblInportLoadArgs);
+    if (result != NULL) gblInportLoadArgs.fileName = NULL;
+    return(result);
+
+} /* end rt_RapidQueueInportsMatFile */
+
+
+/* Function: rt_RapidQueueFromFileBlockMatFile ===============================
+ *
+ * Abstract:
+ *      Queued version of rt_RapidReadFromFileBlockMatFile for use from the
+ *      start code of From File blocks. The -f remapping is done right away,
+ *      so rt_RapidCheckRemappings can be called as before; the TU matrix is
+ *      read into frFInfo by rt_RapidJoinMatFileLoads, which must be called
+ *      before the blocks first produce output.
+ *
+ * Returns:
+ *	NULL    : success
+ *      non-NULL: error message
+ */
+const char *rt_RapidQueueFromFileBlockMatFile(const char *origFileName,
+                                              int        originalWidth,
+                                              FrFInfo    *frFInfo)
+{
+    rt_RemapFromFileBlockMatFile(origFileName, originalWidth, frFInfo);
+
+    return(rt_RapidQueueMatFileLoad(frFInfo->newFileName,
+                                    rt_LoadFromFileBlockMatFile,
+                                    frFInfo));
+
+} /* end rt_RapidQueueFromFileBlockMatFile */
+
+
+/* Function: rt_RapidJoinMatFileLoads ========================================
+ *
+ * Abstract:
+ *      Run all queued MAT-file loads, one after the other on the calling
+ *      thread, then print the load time of each file and the total. The
+ *      queue is empty on return.
+ *
+ * Returns:
+ *	NULL    : success
+ *      non-NULL: error message of the first queued load that failed
+ */
+const char *rt_RapidJoinMatFileLoads(void)
+{
+    static char errmsg[RAPID_MAT_LOAD_ERRMSG_LEN];
+    double      tStart;
+    int_T       i;
+
+    errmsg[0] = '\0'; /* assume success */
+
+    if (gblNumMatFileLoads == 0) return(NULL);
+
+    tStart = rt_MatFileLoadClock();
+    rt_RunMatFileLoads();
+
+    for (i = 0; i < gblNumMatFileLoads; i++) {
+        const RapidMatFileLoad *load = &gblMatFileLoads[i];
+
+        if (load->errmsg[0] != '\0') {
+            if (errmsg[0] == '\0') (void)strcpy(errmsg, load->errmsg);
+        } else {
+            printf(" *** %s loaded in %.3f s ***\n",
+                   load->fileName, load->loadTime);
+        }
+    }
+    printf(" *** %d MAT-file(s) loaded in %.3f s ***\n",
+           (int)gblNumMatFileLoads, rt_MatFileLoadClock() - tStart);
+
+    free(gblMatFileLoads);
+    gblMatFileLoads    = NULL;
+    gblNumMatFileLoads = 0;
+    gblMaxMatFileLoads = 0;
+    gblInportLoadArgs.fileName = NULL;
+
+    return(errmsg[0] != '\0'? errmsg: NULL);
+
+} /* end rt_RapidJoinMatFileLoads */
+
+
 /* Function:  Interpolate_Datatype================================
  * Abstract:
  *      Performs Lagrange interpolation on a pair of data values of
@@ -1719,7 +2381,26 @@ void rt_RapidFreeGbls(int matFileFormat)
 {
     FreeFNamePairList(gblToFNamepair, gblNumToFiles);
     FreeFNamePairList(gblFrFNamepair, gblNumFrFiles);
+
+    /* MAT-file loads queued but never joined */
+    free(gblMatFileLoads);
+    gblMatFileLoads    = NULL;
+    gblNumMatFileLoads = 0;
+    gblMaxMatFileLoads = 0;
+    gblInportLoadArgs.fileName = NULL;
     
+#ifdef RAPID_INPORT_TU_CACHE
+    if (gblInportTUCacheMap != NULL) {
+        /* the TU tables point into the mapped cache file */
+        free(gblInportTUtables);
+        gblInportTUtables = NULL;
+        (void)munmap(gblInportTUCacheMap, gblInportTUCacheMapSize);
+        gblInportTUCacheMap     = NULL;
+        gblInportTUCacheMapSize = 0;
+        return;
+    }
+#endif
+
     if(gblNumRootInportBlks>0){
         int i;
         if (gblInportTUtables!= NULL){
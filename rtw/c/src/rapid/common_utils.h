@@ -99,10 +99,19 @@ extern "C" {
     int     currTimeIdx;       /* for interpolation */
     bool    isPeriodicFcnCall; /* Should the TU table be interpreted as a
                                 * periodic function call specification */
+    size_t  uNumBytes;         /* bytes in ur, and in ui if complex   */
 } rtInportTUtable;
 
 #define NUM_DATA_TYPES (9)
 
+    /*
+     * MAT-file load run by rt_RapidJoinMatFileLoads. On failure it writes
+     * an error message of less than RAPID_MAT_LOAD_ERRMSG_LEN characters to
+     * errmsg, which is otherwise left empty.
+     */
+#define RAPID_MAT_LOAD_ERRMSG_LEN 1024
+    typedef void (*RapidMatFileLoadFcn)(void *arg, char *errmsg);
+
 
 
     /* consult Foundation Libraries before using mxIsIntVectorWrapper G978320 */
@@ -126,6 +135,20 @@ extern "C" {
                                                   int* matFileFormat,
                                                   int isRaccel);              
 
+    extern const char *rt_RapidQueueMatFileLoad(const char          *fileName,
+                                                RapidMatFileLoadFcn loadFcn,
+                                                void                *arg);
+
+    extern const char *rt_RapidQueueInportsMatFile(const char *inportFileName,
+                                                   int        *matFileFormat,
+                                                   int        isRaccel);
+
+    extern const char *rt_RapidQueueFromFileBlockMatFile(const char *origFileName,
+                                                         int        originalWidth,
+                                                         FrFInfo    *frFInfo);
+
+    extern const char *rt_RapidJoinMatFileLoads(void);
+
     extern void rt_Interpolate_Datatype(void   *x1, void   *x2, void   *yout,
                                         real_T t,   real_T t1,  real_T t2,
                                         int    outputDType);
@@ -52,6 +52,11 @@ extern rtwCAPI_ModelMappingInfo* rt_modelMapInfoPtr;
 void* gblLoggingInterval = NULL;
 static PrmStructData gblPrmStruct;
 
+/* parameter MAT-file read ahead by rt_RapidQueueParamMatFile */
+static bool           gblPrmStructPreloaded = false;
+static PrmStructData *gblPreloadedPrmStruct = NULL;
+static const char    *gblPreloadedPrmResult = NULL;
+
 
 /*==================*
  * NON-Visible routines *
@@ -1283,10 +1288,53 @@ ReplaceRtP(
 } /* end ReplaceRtP */
 
 
+/* Function: rt_LoadParamStructMatFile =======================================
+ * Abstract:
+ *      MAT-file load function queued by rt_RapidQueueParamMatFile (arg is
+ *      the SimStruct). The result is kept for
+ *      rt_RapidReadMatFileAndUpdateParams, which also reports any error, so
+ *      errmsg is left empty.
+ */
+static void rt_LoadParamStructMatFile(void *arg, char *errmsg)
+{
+    gblPreloadedPrmResult = rt_ReadParamStructMatFile(
+        &gblPreloadedPrmStruct,
+        (const SimStruct *)arg,
+        gblParamCellIndex);
+    gblPrmStructPreloaded = true;
+    errmsg[0] = '\0';
+
+} /* end rt_LoadParamStructMatFile */
+
+
 /*==================*
  * Visible routines *
  *==================*/
 
+
+/* Function: rt_RapidQueueParamMatFile =======================================
+ *
+ * Abstract:
+ *      Queue the read of the -p parameter MAT-file with the other startup
+ *      MAT-file loads (see rt_RapidJoinMatFileLoads in common_utils.c).
+ *      rt_RapidReadMatFileAndUpdateParams, called after the join, then
+ *      checks and installs the parameters that were read.
+ *
+ * Returns:
+ *	NULL    : success
+ *      non-NULL: error message
+ */
+const char *rt_RapidQueueParamMatFile(const SimStruct *S)
+{
+    if (gblParamFilename == NULL) return(NULL);
+
+    gblPrmStructPreloaded = false;
+    return(rt_RapidQueueMatFileLoad(gblParamFilename,
+                                    rt_LoadParamStructMatFile,
+                                    (void *)S));
+
+} /* end rt_RapidQueueParamMatFile */
+
 /* Function: rt_RapidReadMatFileAndUpdateParams ========================================
  *
  */
@@ -1300,10 +1348,19 @@ rt_RapidReadMatFileAndUpdateParams(const SimStruct *S)
         goto EXIT_POINT;
 
     /* checksum comparison is performed in rt_ReadParamStructMatFile */
-    result = rt_ReadParamStructMatFile(
-        &paramStructure,
-        S,
-        gblParamCellIndex);
+    if (gblPrmStructPreloaded)
+    {
+        result = gblPreloadedPrmResult;
+        paramStructure = gblPreloadedPrmStruct;
+        gblPrmStructPreloaded = false;
+    }
+    else
+    {
+        result = rt_ReadParamStructMatFile(
+            &paramStructure,
+            S,
+            gblParamCellIndex);
+    }
     
     if (result != NULL)
         goto EXIT_POINT;
@@ -89,6 +89,8 @@
 
     extern void rt_RapidReadMatFileAndUpdateParams(const SimStruct *S);
 
+    extern const char *rt_RapidQueueParamMatFile(const SimStruct *S);
+
 
 #endif /* __RACCEL_UTILS_H__ */
 
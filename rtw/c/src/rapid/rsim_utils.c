@@ -40,6 +40,11 @@ extern int_T         gblParamCellIndex;
 
 static PrmStructData gblPrmStruct;
 
+/* parameter MAT-file read ahead by rt_RapidQueueParamMatFile */
+static bool           gblPrmStructPreloaded = false;
+static PrmStructData *gblPreloadedPrmStruct = NULL;
+static const char    *gblPreloadedPrmResult = NULL;
+
 
 /*==================    *
  * NON-Visible routines *
@@ -369,11 +374,52 @@ EXIT_POINT:
 } /* end ReplaceRtP */
 
 
+/* Function: rt_LoadParamStructMatFile =======================================
+ * Abstract:
+ *      MAT-file load function queued by rt_RapidQueueParamMatFile. The
+ *      result is kept for rt_RapidReadMatFileAndUpdateParams, which also
+ *      reports any error, so errmsg is left empty.
+ */
+static void rt_LoadParamStructMatFile(void *arg, char *errmsg)
+{
+    (void)arg;
+    gblPreloadedPrmResult = rt_ReadParamStructMatFile(&gblPreloadedPrmStruct,
+                                                      gblParamCellIndex);
+    gblPrmStructPreloaded = true;
+    errmsg[0] = '\0';
+
+} /* end rt_LoadParamStructMatFile */
+
+
 /*==================*
  * Visible routines *
  *==================*/
 
 
+/* Function: rt_RapidQueueParamMatFile =======================================
+ *
+ * Abstract:
+ *      Queue the read of the -p parameter MAT-file with the other startup
+ *      MAT-file loads (see rt_RapidJoinMatFileLoads in common_utils.c).
+ *      rt_RapidReadMatFileAndUpdateParams, called after the join, then
+ *      checks and installs the parameters that were read.
+ *
+ * Returns:
+ *	NULL    : success
+ *      non-NULL: error message
+ */
+const char *rt_RapidQueueParamMatFile(const SimStruct *S)
+{
+    if (gblParamFilename == NULL) return(NULL);
+
+    gblPrmStructPreloaded = false;
+    return(rt_RapidQueueMatFileLoad(gblParamFilename,
+                                    rt_LoadParamStructMatFile,
+                                    (void *)S));
+
+} /* end rt_RapidQueueParamMatFile */
+
+
 /* Function: rt_RapidReadMatFileAndUpdateParams ========================================
  *
  */
@@ -384,7 +430,13 @@ void rt_RapidReadMatFileAndUpdateParams(const SimStruct *S)
 
     if (gblParamFilename == NULL) goto EXIT_POINT;
 
-    result = rt_ReadParamStructMatFile(&paramStructure, gblParamCellIndex);
+    if (gblPrmStructPreloaded) {
+        result         = gblPreloadedPrmResult;
+        paramStructure = gblPreloadedPrmStruct;
+        gblPrmStructPreloaded = false;
+    } else {
+        result = rt_ReadParamStructMatFile(&paramStructure, gblParamCellIndex);
+    }
     if (result != NULL) goto EXIT_POINT;
 
     /* be sure checksums all match */
@@ -50,6 +50,8 @@ typedef struct {
 
 extern void rt_RapidReadMatFileAndUpdateParams(const SimStruct *S);
 
+extern const char *rt_RapidQueueParamMatFile(const SimStruct *S);
+
  
 
 
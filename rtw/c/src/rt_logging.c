@@ -10,6 +10,22 @@
  *      major time step and finally written to a MAT-file at the end of the
  *      simulation.
  *
+ *      When compiled with RT_LOGGING_COLUMN_MAJOR, multi-column variables
+ *      are stored column by column during the run, so that they need not
+ *      be transposed before they are written.
+ *
+ *      When compiled with RT_LOGGING_COMPRESS (zlib and POSIX threads),
+ *      the variables are deflated in parallel and written as compressed
+ *      MAT-file elements.
+ *
+ *      When compiled with RT_LOGGING_ASYNC (POSIX threads), the buffers of
+ *      the time, state and output variables are filled in by a background
+ *      thread from snapshots taken at each major time step.
+ *
+ *      When compiled with RT_LOGGING_CHUNKED (and rt_logging_chunked.c for
+ *      the reader), the time, states and outputs can also be written to a
+ *      chunked log file as the simulation runs, see rt_SetChunkedLogFile.
+ *
  *      This file handles redefining the following standard MathWorks types
  *      (see tmwtypes.h):
  *         [u]int8_T     to be int32_T (logged as Matlab [u]int32)
@@ -18,6 +34,10 @@
  *
  */
 
+#if defined(RT_LOGGING_COMPRESS) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L          /* open_memstream */
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -32,6 +52,19 @@
 #include "rt_mxclassid.h"
 #include "rtw_matlogging.h"
 
+#if defined(RT_LOGGING_ASYNC) || defined(RT_LOGGING_COMPRESS)
+#include <pthread.h>
+#endif
+#ifdef RT_LOGGING_ASYNC
+#include <semaphore.h>
+#endif
+#ifdef RT_LOGGING_COMPRESS
+#include <zlib.h>
+#endif
+#ifdef RT_LOGGING_CHUNKED
+#include "rt_logging_chunked.h"
+#endif
+
 #ifndef TMW_NAME_LENGTH_MAX
 #define TMW_NAME_LENGTH_MAX 64
 #endif
@@ -63,6 +96,10 @@
 #define DEFAULT_BUFFER_SIZE      1024  /* used if maxRows=0 and Tfinal=0.0    */
 #endif
 
+#ifndef TRANSPOSE_BLOCK_SIZE
+#define TRANSPOSE_BLOCK_SIZE     32    /* rows and columns per transpose tile */
+#endif
+
 #define FREE(m) if (m != NULL) free(m)
 
 /* Logical definitions */
@@ -89,7 +126,17 @@ typedef struct LogInfo_Tag {
     LogVar       *logVarsList;         /* Linked list of all LogVars          */
     StructLogVar *structLogVarsList;   /* Linked list of all StructLogVars    */
 
+    LogVar       *sharedTime;          /* Time of the structure format states
+                                          and outputs, logged once per step   */
+
     boolean_T   haveLogVars;           /* Are logging one or more vars?       */
+
+#ifdef RT_LOGGING_ASYNC
+    void         *async;               /* Background logging thread, if any   */
+#endif
+#ifdef RT_LOGGING_CHUNKED
+    void         *chunked;             /* Chunked log file writer, if any     */
+#endif
 } LogInfo;
 
 typedef struct MatItem_tag {
@@ -333,22 +380,12 @@ static double rt_GetDblValueFromOverSizedData(
 {
     double retValue = 0;
 
-    double *dblValue = (double *) calloc(numOfChunk, sizeof(double));
-
     int i;    
     double isSignedNeg;
 
-    if(isSigned) {
-        const chunk_T *pData = (const chunk_T *) (pVoid);
-        for (i = 0; i <numOfChunk; i++) {
-            dblValue[i] = (double)(pData[i]);
-        }
-    } else  {
-        const uchunk_T *pData = (const uchunk_T *) (pVoid);
-        for (i = 0; i <numOfChunk; i++) {
-            dblValue[i] = (double)(pData[i]);
-        }
-    }
+    /* Value of chunk k, read in place rather than copied to a buffer */
+#define CHUNK_VALUE(k) (isSigned ? (double)(((const chunk_T *)(pVoid))[k]) : \
+                                   (double)(((const uchunk_T *)(pVoid))[k]))
 
     /* 
        Assuming multi chunks b_n ... b_2 b_1 b_0, and the length of each chunk is N.
@@ -364,22 +401,323 @@ static double rt_GetDblValueFromOverSizedData(
        (b_n + isSigned * (b_(n-1)<0)) * 2^(n*N) +... + (b_1 + isSigned * (b_0<0)) * 2^N + b_0 * 2^0;
     */
 
-    retValue = dblValue[numOfChunk - 1];
+    retValue = CHUNK_VALUE(numOfChunk - 1);
     
     for(i = numOfChunk - 1; i > 0; i--) {
-        isSignedNeg = dblValue[i - 1] < 0 ? (double)isSigned : 0;
+        double chunkValue = CHUNK_VALUE(i - 1);
+
+        isSignedNeg = chunkValue < 0 ? (double)isSigned : 0;
         retValue = retValue + isSignedNeg;
 
-        retValue = ldexp(retValue, bitsPerChunk)+ dblValue[i-1];
+        retValue = ldexp(retValue, bitsPerChunk)+ chunkValue;
     }
     retValue = ldexp( fracSlope * retValue, fixedExp ) + bias;
+#undef CHUNK_VALUE
 
-    FREE(dblValue);
     return (retValue);
 
 } /* end rt_GetDblValueFromOverSizedData */
 
 
+/*
+ * Bulk data type conversion kernels
+ *
+ * For a fixed-size, non-complex, non-frame LogVar logged to double from a
+ * data type that needs conversion, rt_UpdateLogVar converts a whole row with
+ * one of these kernels instead of element by element. Each computes
+ *
+ *     dst[k] = src[k] * convertScale + bias,  convertScale = fracSlope * 2^fixedExp
+ *
+ * which gives the same result as ldexp(fracSlope * src[k], fixedExp) + bias
+ * in the element by element code. The 8, 16 and 32 bit integer kernels use
+ * SSE2 when available; the others are simple enough for the compiler to
+ * vectorize on its own.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LOG_CONVERT_SSE2
+#endif
+
+/* Remainder, or the whole row without SIMD */
+#define LOG_CONVERT_SCALAR(srcType)                                           \
+    for (; k < n; k++) {                                                      \
+        dst[k] = (real_T)(((const srcType *)src)[k]) * scale + bias;          \
+    }
+
+#ifdef LOG_CONVERT_SSE2
+
+/* Function: rt_StoreInt32x4AsDouble ===========================================
+ * Abstract:
+ *      Convert, scale and store four int32 lanes.
+ */
+static void rt_StoreInt32x4AsDouble(real_T *dst, __m128i v,
+                                    __m128d vScale, __m128d vBias)
+{
+    __m128d lo = _mm_cvtepi32_pd(v);
+    __m128d hi = _mm_cvtepi32_pd(_mm_shuffle_epi32(v, 0xEE));
+
+    _mm_storeu_pd(dst,     _mm_add_pd(_mm_mul_pd(lo, vScale), vBias));
+    _mm_storeu_pd(dst + 2, _mm_add_pd(_mm_mul_pd(hi, vScale), vBias));
+
+} /* end rt_StoreInt32x4AsDouble */
+
+
+/* Function: rt_StoreInt16x8AsDouble ===========================================
+ * Abstract:
+ *      Convert, scale and store eight int16 (or, with isSigned false,
+ *      uint16) lanes.
+ */
+static void rt_StoreInt16x8AsDouble(real_T *dst, __m128i v, boolean_T isSigned,
+                                    __m128d vScale, __m128d vBias)
+{
+    if (isSigned) {
+        rt_StoreInt32x4AsDouble(dst, _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16),
+                                vScale, vBias);
+        rt_StoreInt32x4AsDouble(dst + 4, _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16),
+                                vScale, vBias);
+    } else {
+        __m128i zero = _mm_setzero_si128();
+        rt_StoreInt32x4AsDouble(dst, _mm_unpacklo_epi16(v, zero), vScale, vBias);
+        rt_StoreInt32x4AsDouble(dst + 4, _mm_unpackhi_epi16(v, zero), vScale, vBias);
+    }
+
+} /* end rt_StoreInt16x8AsDouble */
+
+#endif /* LOG_CONVERT_SSE2 */
+
+
+/* Function: rt_ConvertInt8Row =================================================
+ * Abstract:
+ *      Convert a row of int8 or, for uint8 and boolean data, uint8 values.
+ */
+static void rt_ConvertInt8Row(const LogVar *var, real_T *dst,
+                              const void *src, int_T n, boolean_T isSigned)
+{
+    const real_T scale = var->convertScale;
+    const real_T bias  = var->data.dataTypeConvertInfo.bias;
+    int_T        k     = 0;
+
+#ifdef LOG_CONVERT_SSE2
+    const __m128d vScale = _mm_set1_pd(scale);
+    const __m128d vBias  = _mm_set1_pd(bias);
+
+    for (; k + 16 <= n; k += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)((const int8_T *)src + k));
+        __m128i lo, hi;
+
+        if (isSigned) {
+            lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+            hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+        } else {
+            lo = _mm_unpacklo_epi8(v, _mm_setzero_si128());
+            hi = _mm_unpackhi_epi8(v, _mm_setzero_si128());
+        }
+        /* both are now int16 lanes, zero extended if unsigned */
+        rt_StoreInt16x8AsDouble(dst + k,     lo, true, vScale, vBias);
+        rt_StoreInt16x8AsDouble(dst + k + 8, hi, true, vScale, vBias);
+    }
+#endif
+    if (isSigned) {
+        LOG_CONVERT_SCALAR(int8_T);
+    } else {
+        LOG_CONVERT_SCALAR(uint8_T);
+    }
+
+} /* end rt_ConvertInt8Row */
+
+
+/* Function: rt_ConvertInt16Row ================================================
+ * Abstract:
+ *      Convert a row of int16 or uint16 values.
+ */
+static void rt_ConvertInt16Row(const LogVar *var, real_T *dst,
+                               const void *src, int_T n, boolean_T isSigned)
+{
+    const real_T scale = var->convertScale;
+    const real_T bias  = var->data.dataTypeConvertInfo.bias;
+    int_T        k     = 0;
+
+#ifdef LOG_CONVERT_SSE2
+    const __m128d vScale = _mm_set1_pd(scale);
+    const __m128d vBias  = _mm_set1_pd(bias);
+
+    for (; k + 8 <= n; k += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)((const int16_T *)src + k));
+        rt_StoreInt16x8AsDouble(dst + k, v, isSigned, vScale, vBias);
+    }
+#endif
+    if (isSigned) {
+        LOG_CONVERT_SCALAR(int16_T);
+    } else {
+        LOG_CONVERT_SCALAR(uint16_T);
+    }
+
+} /* end rt_ConvertInt16Row */
+
+
+static void rt_ConvertInt8ToDouble(const LogVar *var, real_T *dst,
+                                   const void *src, int_T n)
+{
+    rt_ConvertInt8Row(var, dst, src, n, true);
+}
+
+static void rt_ConvertUint8ToDouble(const LogVar *var, real_T *dst,
+                                    const void *src, int_T n)
+{
+    rt_ConvertInt8Row(var, dst, src, n, false);
+}
+
+static void rt_ConvertInt16ToDouble(const LogVar *var, real_T *dst,
+                                    const void *src, int_T n)
+{
+    rt_ConvertInt16Row(var, dst, src, n, true);
+}
+
+static void rt_ConvertUint16ToDouble(const LogVar *var, real_T *dst,
+                                     const void *src, int_T n)
+{
+    rt_ConvertInt16Row(var, dst, src, n, false);
+}
+
+
+/* Function: rt_ConvertInt32ToDouble ===========================================
+ * Abstract:
+ *      Convert a row of int32 values.
+ */
+static void rt_ConvertInt32ToDouble(const LogVar *var, real_T *dst,
+                                    const void *src, int_T n)
+{
+    const real_T scale = var->convertScale;
+    const real_T bias  = var->data.dataTypeConvertInfo.bias;
+    int_T        k     = 0;
+
+#ifdef LOG_CONVERT_SSE2
+    const __m128d vScale = _mm_set1_pd(scale);
+    const __m128d vBias  = _mm_set1_pd(bias);
+
+    for (; k + 4 <= n; k += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)((const int32_T *)src + k));
+        rt_StoreInt32x4AsDouble(dst + k, v, vScale, vBias);
+    }
+#endif
+    LOG_CONVERT_SCALAR(int32_T);
+
+} /* end rt_ConvertInt32ToDouble */
+
+
+/* Function: rt_ConvertUint32ToDouble ==========================================
+ * Abstract:
+ *      Convert a row of uint32 values.
+ */
+static void rt_ConvertUint32ToDouble(const LogVar *var, real_T *dst,
+                                     const void *src, int_T n)
+{
+    const real_T scale = var->convertScale;
+    const real_T bias  = var->data.dataTypeConvertInfo.bias;
+    int_T        k     = 0;
+
+    LOG_CONVERT_SCALAR(uint32_T);
+
+} /* end rt_ConvertUint32ToDouble */
+
+
+/* Function: rt_ConvertSingleToDouble ==========================================
+ * Abstract:
+ *      Convert a row of single values.
+ */
+static void rt_ConvertSingleToDouble(const LogVar *var, real_T *dst,
+                                     const void *src, int_T n)
+{
+    const real_T scale = var->convertScale;
+    const real_T bias  = var->data.dataTypeConvertInfo.bias;
+    int_T        k     = 0;
+
+    LOG_CONVERT_SCALAR(real32_T);
+
+} /* end rt_ConvertSingleToDouble */
+
+
+/* Function: rt_ConvertDoubleToDouble ==========================================
+ * Abstract:
+ *      Scale a row of double values.
+ */
+static void rt_ConvertDoubleToDouble(const LogVar *var, real_T *dst,
+                                     const void *src, int_T n)
+{
+    const real_T scale = var->convertScale;
+    const real_T bias  = var->data.dataTypeConvertInfo.bias;
+    int_T        k     = 0;
+
+    LOG_CONVERT_SCALAR(real_T);
+
+} /* end rt_ConvertDoubleToDouble */
+
+
+/* Function: rt_ConvertMultiwordToDouble =======================================
+ * Abstract:
+ *      Convert a row of multiword values.
+ */
+static void rt_ConvertMultiwordToDouble(const LogVar *var, real_T *dst,
+                                        const void *src, int_T n)
+{
+    const RTWLogDataTypeConvert *pCvt = &var->data.dataTypeConvertInfo;
+    const char                  *pIn  = (const char *)src;
+    int                         dtSize = pCvt->bitsPerChunk*pCvt->numOfChunk/8;
+    int_T                       k;
+
+    for (k = 0; k < n; k++, pIn += dtSize) {
+        dst[k] = rt_GetDblValueFromOverSizedData(pIn, pCvt->bitsPerChunk,
+                                                 pCvt->numOfChunk,
+                                                 pCvt->isSigned,
+                                                 pCvt->fracSlope,
+                                                 pCvt->fixedExp,
+                                                 pCvt->bias);
+    }
+
+} /* end rt_ConvertMultiwordToDouble */
+
+#undef LOG_CONVERT_SCALAR
+
+
+/* Function: rt_SelectConvertKernel ============================================
+ * Abstract:
+ *      Choose the bulk conversion kernel for a LogVar once it is set up.
+ *      Returns NULL when the data must be converted element by element:
+ *      no conversion, complex, frame or variable-size data, logging to a
+ *      type other than double, or data stored column by column.
+ */
+static LogConvertKernel rt_SelectConvertKernel(LogVar *var)
+{
+    const RTWLogDataTypeConvert *pCvt = &var->data.dataTypeConvertInfo;
+
+    if (!pCvt->conversionNeeded || var->data.complex ||
+        var->data.frameData || var->valDims != NULL || var->colMajor ||
+        pCvt->dataTypeIdLoggingTo != SS_DOUBLE) {
+        return(NULL);
+    }
+
+    var->convertScale = ldexp(pCvt->fracSlope, pCvt->fixedExp);
+
+    if (pCvt->numOfChunk > 1) {
+        return(rt_ConvertMultiwordToDouble);
+    }
+    switch (pCvt->dataTypeIdOriginal) {
+      case SS_DOUBLE:  return(rt_ConvertDoubleToDouble);
+      case SS_SINGLE:  return(rt_ConvertSingleToDouble);
+      case SS_INT8:    return(rt_ConvertInt8ToDouble);
+      case SS_UINT8:   return(rt_ConvertUint8ToDouble);
+      case SS_INT16:   return(rt_ConvertInt16ToDouble);
+      case SS_UINT16:  return(rt_ConvertUint16ToDouble);
+      case SS_INT32:   return(rt_ConvertInt32ToDouble);
+      case SS_UINT32:  return(rt_ConvertUint32ToDouble);
+      case SS_BOOLEAN: return(rt_ConvertUint8ToDouble);
+      default:         return(NULL);
+    }
+
+} /* end rt_SelectConvertKernel */
+
+
 /* Function: rt_GetNonBoolMxIdFromDTypeId ======================================
  * Abstract:
  *      Get the mx???_CLASS given the simulink builtin data type id.
@@ -1175,89 +1513,484 @@ static int_T rt_WriteMat5FileHeader(FILE *fp)
 } /* end rt_WriteMat5FileHeader */
 
 
-/* Function: rt_FixupLogVar ====================================================
+#ifdef RT_LOGGING_COMPRESS
+
+/*
+ * Compressed MAT-file output
+ *
+ * With RT_LOGGING_COMPRESS defined (link with zlib and POSIX threads), each
+ * top level variable is written as a MAT v5 miCOMPRESSED element, i.e. the
+ * zlib deflated miMATRIX element, readable by MATLAB 7 and later. The
+ * variables are serialized and deflated by RT_LOGGING_COMPRESS_THREADS
+ * worker threads as soon as they are queued. Each one is written to the
+ * file, in queue order, and freed once it and the ones queued before it are
+ * compressed, so that only the variables in flight are held in memory.
+ *
+ * A variable is serialized into memory with open_memstream (POSIX.1-2008).
+ * Where it is not available, e.g. on Windows, or with
+ * RT_LOGGING_COMPRESS_NO_MEMSTREAM defined, it goes through a tmpfile
+ * instead.
+ */
+
+#ifndef RT_LOGGING_COMPRESS_THREADS
+#define RT_LOGGING_COMPRESS_THREADS  4
+#endif
+
+#ifndef RT_LOGGING_COMPRESS_LEVEL
+#define RT_LOGGING_COMPRESS_LEVEL    Z_BEST_SPEED
+#endif
+
+#if defined(_WIN32) && !defined(RT_LOGGING_COMPRESS_NO_MEMSTREAM)
+#define RT_LOGGING_COMPRESS_NO_MEMSTREAM
+#endif
+
+#define matCOMPRESSED               15
+
+typedef struct CompressedItem_Tag {
+    MatItem      item;                 /* Top level variable                  */
+    ItemDataKind itemKind;
+    Bytef        *data;                /* Deflated miMATRIX element           */
+    uLongf       nbytes;
+    int_T        status;               /* Non-zero upon failure               */
+    boolean_T    done;                 /* Compressed, guarded by lock         */
+} CompressedItem;
+
+typedef struct MatCompressor_Tag {
+    CompressedItem  **items;           /* NULL once written                   */
+    int_T           numItems;
+    int_T           maxItems;
+    int_T           nextItem;          /* Next item to compress               */
+    int_T           nextWrite;         /* Next item to write, model thread    */
+    int_T           status;            /* Non-zero once a write failed        */
+    boolean_T       closed;            /* Worker threads exit                 */
+    int_T           numThreads;
+    pthread_t       threads[RT_LOGGING_COMPRESS_THREADS];
+    pthread_mutex_t lock;
+    pthread_cond_t  queued;            /* An item was queued, or closed       */
+    pthread_cond_t  compressed;        /* An item is done                     */
+} MatCompressor;
+
+
+/* Function: rt_CompressItem ===================================================
  * Abstract:
- *	Make the logged variable suitable for MATLAB.
+ *      Serialize one variable into memory with rt_WriteItemToMatFile and
+ *      deflate it.
  */
-static const char_T *rt_FixupLogVar(LogVar *var,int verbose)
+static void rt_CompressItem(CompressedItem *ci)
 {
-    int_T  nCols   = var->data.nCols;
-    int_T  maxRows = var->data.nRows;
-    int_T  nDims   = var->data.nDims;
-    size_t elSize  = var->data.elSize;
-    int_T  nRows   = (var->wrapped ?  maxRows : var->rowIdx);
+    char   *buf  = NULL;
+    size_t size  = 0;
+#ifndef RT_LOGGING_COMPRESS_NO_MEMSTREAM
+    FILE   *mfp  = open_memstream(&buf, &size);
+
+    if (mfp == NULL) {
+        ci->status = 1;
+        return;
+    }
+    ci->status = rt_WriteItemToMatFile(mfp, &ci->item, ci->itemKind);
+    if (fclose(mfp) != 0) ci->status = 1;
+#else
+    FILE   *mfp  = tmpfile();
+    long   pos;
 
-    var->nDataPoints = var->rowIdx + var->wrapped * maxRows;
+    if (mfp == NULL) {
+        ci->status = 1;
+        return;
+    }
+    ci->status = rt_WriteItemToMatFile(mfp, &ci->item, ci->itemKind);
+    if (ci->status == 0) {
+        if ((pos = ftell(mfp)) < 0 || fseek(mfp, 0L, SEEK_SET) != 0 ||
+            (buf = malloc((size_t)pos + 1)) == NULL ||
+            fread(buf, 1, (size_t)pos, mfp) != (size_t)pos) {
+            ci->status = 1;
+        } else {
+            size = (size_t)pos;
+        }
+    }
+    (void)fclose(mfp);
+#endif
 
-    if (var->wrapped > 1 || (var->wrapped == 1 && var->rowIdx != 0)) {
-        /*
-         * Warn the user the circular buffer has wrapped, implying that
-         * some data has been lost.
-         */
-        if( verbose) {
-            (void)fprintf(stdout,
-                          "*** Log variable %s has wrapped %d times\n"
-                          "    using a circular buffer of size %d\n",
-                          var->data.name, var->wrapped, var->data.nRows);
+    if (ci->status == 0) {
+        ci->nbytes = compressBound((uLong)size);
+        if ((ci->data = malloc(ci->nbytes)) == NULL ||
+            compress2(ci->data, &ci->nbytes, (const Bytef *)buf, (uLong)size,
+                      RT_LOGGING_COMPRESS_LEVEL) != Z_OK) {
+            ci->status = 1;
         }
-        if (var->usingDefaultBufSize) {
-            /*
-             * If wrapping occurred using the default buffer size,
-             * let the user know what size buffer to use in the
-             * future to avoid wrapping.  If the default buffer
-             * size was not used, the user has no control to specify
-             * the correct value.  Wrapping may occur when not using
-             * the default buffer if we allocated too small a buffer
-             * size for this logvar.  One common case is a toWorkspace
-             * block inside of an iterative subsystem - we can not take
-             * the number of iterations into account (they may be
-             * variable) when allocating the buffer.  In this case,
-             * just warn the buffer wrapped and don't tell user they
-             * can override the buffer size.
-             */
-            if( verbose ) {
-                (void)fprintf(stdout,
-                              "*** To avoid wrapping, explicitly specify a\n"
-                              "    buffer size of %d in your Simulink model\n"
-                              "    by adding OPTS=\"-DDEFAULT_BUFFER_SIZE=%d\"\n"
-                              "    as an argument to the ConfigSet MakeCommand\n"
-                              "    parameter\n",
-                              var->nDataPoints, var->nDataPoints);
-            }
+    }
+    FREE(buf);
+
+} /* end rt_CompressItem */
+
+
+/* Function: rt_CompressWorker =================================================
+ * Abstract:
+ *      Worker thread: compress the queued items until the compressor is
+ *      closed.
+ */
+static void *rt_CompressWorker(void *arg)
+{
+    MatCompressor *c = (MatCompressor *)arg;
+
+    for (;;) {
+        CompressedItem *ci;
+
+        (void)pthread_mutex_lock(&c->lock);
+        while (c->nextItem == c->numItems && !c->closed) {
+            (void)pthread_cond_wait(&c->queued, &c->lock);
+        }
+        if (c->nextItem == c->numItems) {
+            (void)pthread_mutex_unlock(&c->lock);
+            break;
         }
+        ci = c->items[c->nextItem++];
+        (void)pthread_mutex_unlock(&c->lock);
+
+        rt_CompressItem(ci);
+
+        (void)pthread_mutex_lock(&c->lock);
+        ci->done = true;
+        (void)pthread_cond_broadcast(&c->compressed);
+        (void)pthread_mutex_unlock(&c->lock);
     }
+    return(NULL);
 
-    if (nDims < 2 && nCols > 1) {  /* Transpose? */
-        /* Don't need to transpose valueDimensions */
-        int_T  nEl    = nRows*nCols;
-        char   *src   = var->data.re;
-        char   *pmT;
-        int_T  k;
+} /* end rt_CompressWorker */
 
-        /**********************************
-         * If memory cannot be allocated, *
-         * write to a temporary buffer    *
-         **********************************/
-        if ((pmT = malloc(nEl*elSize)) == NULL) {
-            FILE  *fptr;
-            char  fName[mxMAXNAM];
 
-            (void)sprintf(fName, "%s%s", var->data.name, "_rtw_tmw.tmw");
-            if ((fptr=fopen(fName,"w+b")) == NULL) {
-                (void)fprintf(stderr,"*** Error opening %s",fName);
-                return("unable to open data file\n");
-            }
+/* Function: rt_InitMatCompressor =============================================
+ * Abstract:
+ *      Initialize an empty compression queue and start the worker threads.
+ *      If no worker can be started, the items are compressed by the model
+ *      thread when they are written.
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_InitMatCompressor(MatCompressor *c)
+{
+    (void)memset(c, 0, sizeof(MatCompressor));
+    if (pthread_mutex_init(&c->lock, NULL) != 0) return(1);
+    if (pthread_cond_init(&c->queued, NULL) != 0) {
+        (void)pthread_mutex_destroy(&c->lock);
+        return(1);
+    }
+    if (pthread_cond_init(&c->compressed, NULL) != 0) {
+        (void)pthread_cond_destroy(&c->queued);
+        (void)pthread_mutex_destroy(&c->lock);
+        return(1);
+    }
+    while (c->numThreads < RT_LOGGING_COMPRESS_THREADS &&
+           pthread_create(&c->threads[c->numThreads], NULL,
+                          rt_CompressWorker, c) == 0) {
+        c->numThreads++;
+    }
+    return(0);
 
-            /****************************
-             * Write the data to a file *
-             ****************************/
-            for (k=0; k<nEl; k++) {
-                int_T kT   = nCols*(k%nRows) + (k/nRows);
-                char  *dst = src + kT*elSize;
-                (void)fwrite(dst, elSize, 1, fptr);
+} /* end rt_InitMatCompressor */
+
+
+/* Function: rt_WriteDoneItems =================================================
+ * Abstract:
+ *      Write the items at the front of the queue to fp as miCOMPRESSED
+ *      elements and free them. Stops at the first item not compressed yet,
+ *      unless wait is true, in which case the remaining items are waited
+ *      for, or compressed here if no worker has taken them. Once a write
+ *      has failed, the items are freed without being written.
+ */
+static void rt_WriteDoneItems(FILE *fp, MatCompressor *c, boolean_T wait)
+{
+    while (c->nextWrite < c->numItems) {
+        CompressedItem *ci = c->items[c->nextWrite];
+        boolean_T      compressHere = false;
+        uint32_T       tag[2];
+
+        (void)pthread_mutex_lock(&c->lock);
+        if (!ci->done) {
+            if (!wait) {
+                (void)pthread_mutex_unlock(&c->lock);
+                break;
             }
-            if (var->data.complex) {
-                char *pmiT = var->data.re;
+            if (c->nextItem == c->nextWrite) {
+                c->nextItem++;
+                compressHere = true;
+            } else {
+                while (!ci->done) {
+                    (void)pthread_cond_wait(&c->compressed, &c->lock);
+                }
+            }
+        }
+        (void)pthread_mutex_unlock(&c->lock);
+        if (compressHere) rt_CompressItem(ci);
+
+        tag[0] = matCOMPRESSED;
+        tag[1] = (uint32_T)ci->nbytes;
+        if (c->status == 0 &&
+            (ci->status != 0 ||
+             fwrite(tag, 1, matTAG_SIZE, fp) != matTAG_SIZE ||
+             fwrite(ci->data, 1, ci->nbytes, fp) != (size_t)ci->nbytes)) {
+            c->status = 1;
+        }
+        FREE(ci->data);
+        free(ci);
+        c->items[c->nextWrite++] = NULL;
+    }
+
+} /* end rt_WriteDoneItems */
+
+
+/* Function: rt_AddCompressedItem ==============================================
+ * Abstract:
+ *      Queue a top level variable for compression, then write the items
+ *      already compressed at the front of the queue. The data the item
+ *      refers to must stay valid until rt_WriteCompressedItems returns.
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_AddCompressedItem(FILE          *fp,
+                                  MatCompressor *c,
+                                  const MatItem *pItem,
+                                  ItemDataKind  itemKind)
+{
+    CompressedItem *ci = calloc(1, sizeof(CompressedItem));
+
+    if (ci == NULL) return(1);
+    ci->item     = *pItem;
+    ci->itemKind = itemKind;
+
+    (void)pthread_mutex_lock(&c->lock);
+    if (c->numItems == c->maxItems) {
+        int_T          maxItems = (c->maxItems > 0) ? 2*c->maxItems : 16;
+        CompressedItem **tmp    = realloc(c->items,
+                                          maxItems*sizeof(CompressedItem *));
+        if (tmp == NULL) {
+            (void)pthread_mutex_unlock(&c->lock);
+            free(ci);
+            return(1);
+        }
+        c->items    = tmp;
+        c->maxItems = maxItems;
+    }
+    c->items[c->numItems++] = ci;
+    (void)pthread_cond_signal(&c->queued);
+    (void)pthread_mutex_unlock(&c->lock);
+
+    rt_WriteDoneItems(fp, c, false);
+    return(c->status);
+
+} /* end rt_AddCompressedItem */
+
+
+/* Function: rt_WriteCompressedItems ===========================================
+ * Abstract:
+ *      Wait for the queued items to be compressed and write them to fp, in
+ *      the order they were queued. On return, no item refers to its data
+ *      anymore, even upon failure.
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_WriteCompressedItems(FILE *fp, MatCompressor *c)
+{
+    rt_WriteDoneItems(fp, c, true);
+    return(c->status);
+
+} /* end rt_WriteCompressedItems */
+
+
+/* Function: rt_DestroyMatCompressor ===========================================
+ * Abstract:
+ *      Stop the worker threads and free the items left in the queue.
+ */
+static void rt_DestroyMatCompressor(MatCompressor *c)
+{
+    int_T i;
+
+    (void)pthread_mutex_lock(&c->lock);
+    c->nextItem = c->numItems;         /* items not taken are dropped         */
+    c->closed   = true;
+    (void)pthread_cond_broadcast(&c->queued);
+    (void)pthread_mutex_unlock(&c->lock);
+    for (i = 0; i < c->numThreads; i++) {
+        (void)pthread_join(c->threads[i], NULL);
+    }
+
+    for (i = c->nextWrite; i < c->numItems; i++) {
+        FREE(c->items[i]->data);
+        free(c->items[i]);
+    }
+    FREE(c->items);
+    (void)pthread_cond_destroy(&c->compressed);
+    (void)pthread_cond_destroy(&c->queued);
+    (void)pthread_mutex_destroy(&c->lock);
+
+} /* end rt_DestroyMatCompressor */
+
+#endif /* RT_LOGGING_COMPRESS */
+
+
+/* Function: rt_TransposeBlocked ===============================================
+ * Abstract:
+ *	Transpose the nRows x nCols row-major matrix at src into the column-major
+ *	matrix at dst, one TRANSPOSE_BLOCK_SIZE square tile at a time so that
+ *	both the strided reads and the writes stay in cache.
+ */
+static void rt_TransposeBlocked(char_T       *dst,
+                                const char_T *src,
+                                int_T        nRows,
+                                int_T        nCols,
+                                size_t       elSize)
+{
+    size_t srcStride = elSize * nCols;
+    int_T  r0, c0, r, c;
+
+/* Copy with a constant size, so that the compiler turns it into a move */
+#define TRANSPOSE_TILE_COLUMN(n)                   \
+    for (r = r0; r < rEnd; r++) {                  \
+        (void)memcpy(d, s, n);                     \
+        d += n;   s += srcStride;                  \
+    }
+
+    for (r0 = 0; r0 < nRows; r0 += TRANSPOSE_BLOCK_SIZE) {
+        int_T rEnd = (nRows - r0 < TRANSPOSE_BLOCK_SIZE) ?
+                     nRows : r0 + TRANSPOSE_BLOCK_SIZE;
+
+        for (c0 = 0; c0 < nCols; c0 += TRANSPOSE_BLOCK_SIZE) {
+            int_T cEnd = (nCols - c0 < TRANSPOSE_BLOCK_SIZE) ?
+                         nCols : c0 + TRANSPOSE_BLOCK_SIZE;
+
+            for (c = c0; c < cEnd; c++) {
+                char_T       *d = dst + ((size_t)c * nRows + r0) * elSize;
+                const char_T *s = src + (size_t)r0 * srcStride + c * elSize;
+
+                switch (elSize) {
+                  case 8:  TRANSPOSE_TILE_COLUMN(8);      break;
+                  case 4:  TRANSPOSE_TILE_COLUMN(4);      break;
+                  case 2:  TRANSPOSE_TILE_COLUMN(2);      break;
+                  case 1:  TRANSPOSE_TILE_COLUMN(1);      break;
+                  default: TRANSPOSE_TILE_COLUMN(elSize); break;
+                }
+            }
+        }
+    }
+#undef TRANSPOSE_TILE_COLUMN
+
+} /* end rt_TransposeBlocked */
+
+
+/* Function: rt_CompactColumns =================================================
+ * Abstract:
+ *	Close the gaps between the columns of a column-major buffer with a
+ *	column stride of maxRows, of which only the first nRows rows are used.
+ */
+static void rt_CompactColumns(char_T *buf,
+                              int_T  nRows,
+                              int_T  maxRows,
+                              int_T  nCols,
+                              size_t elSize)
+{
+    int_T c;
+
+    for (c = 1; c < nCols; c++) {
+        (void)memmove(buf + (size_t)c * nRows * elSize,
+                      buf + (size_t)c * maxRows * elSize,
+                      (size_t)nRows * elSize);
+    }
+
+} /* end rt_CompactColumns */
+
+
+/* Function: rt_FixupLogVar ====================================================
+ * Abstract:
+ *	Make the logged variable suitable for MATLAB.
+ */
+static const char_T *rt_FixupLogVar(LogVar *var,int verbose)
+{
+    int_T  nCols   = var->data.nCols;
+    int_T  maxRows = var->data.nRows;
+    int_T  nDims   = var->data.nDims;
+    size_t elSize  = var->data.elSize;
+    int_T  nRows   = (var->wrapped ?  maxRows : var->rowIdx);
+
+    var->nDataPoints = var->rowIdx + var->wrapped * maxRows;
+
+    if (var->wrapped > 1 || (var->wrapped == 1 && var->rowIdx != 0)) {
+        /*
+         * Warn the user the circular buffer has wrapped, implying that
+         * some data has been lost.
+         */
+        if( verbose) {
+            (void)fprintf(stdout,
+                          "*** Log variable %s has wrapped %d times\n"
+                          "    using a circular buffer of size %d\n",
+                          var->data.name, var->wrapped, var->data.nRows);
+        }
+        if (var->usingDefaultBufSize) {
+            /*
+             * If wrapping occurred using the default buffer size,
+             * let the user know what size buffer to use in the
+             * future to avoid wrapping.  If the default buffer
+             * size was not used, the user has no control to specify
+             * the correct value.  Wrapping may occur when not using
+             * the default buffer if we allocated too small a buffer
+             * size for this logvar.  One common case is a toWorkspace
+             * block inside of an iterative subsystem - we can not take
+             * the number of iterations into account (they may be
+             * variable) when allocating the buffer.  In this case,
+             * just warn the buffer wrapped and don't tell user they
+             * can override the buffer size.
+             */
+            if( verbose ) {
+                (void)fprintf(stdout,
+                              "*** To avoid wrapping, explicitly specify a\n"
+                              "    buffer size of %d in your Simulink model\n"
+                              "    by adding OPTS=\"-DDEFAULT_BUFFER_SIZE=%d\"\n"
+                              "    as an argument to the ConfigSet MakeCommand\n"
+                              "    parameter\n",
+                              var->nDataPoints, var->nDataPoints);
+            }
+        }
+    }
+
+    if (var->colMajor) {  /* Already in MATLAB order */
+        if (nRows < maxRows) {
+            rt_CompactColumns(var->data.re, nRows, maxRows, nCols, elSize);
+            if (var->data.complex) {
+                rt_CompactColumns(var->data.im, nRows, maxRows, nCols, elSize);
+            }
+        }
+    } else if (nDims < 2 && nCols > 1) {  /* Transpose? */
+        /* Don't need to transpose valueDimensions */
+        int_T  nEl    = nRows*nCols;
+        char   *src   = var->data.re;
+        char   *pmT;
+        int_T  k;
+
+        /**********************************
+         * If memory cannot be allocated, *
+         * write to a temporary buffer    *
+         **********************************/
+        if ((pmT = malloc(nEl*elSize)) == NULL) {
+            FILE  *fptr;
+            char  fName[mxMAXNAM];
+
+            (void)sprintf(fName, "%s%s", var->data.name, "_rtw_tmw.tmw");
+            if ((fptr=fopen(fName,"w+b")) == NULL) {
+                (void)fprintf(stderr,"*** Error opening %s",fName);
+                return("unable to open data file\n");
+            }
+
+            /****************************
+             * Write the data to a file *
+             ****************************/
+            for (k=0; k<nEl; k++) {
+                int_T kT   = nCols*(k%nRows) + (k/nRows);
+                char  *dst = src + kT*elSize;
+                (void)fwrite(dst, elSize, 1, fptr);
+            }
+            if (var->data.complex) {
+                char *pmiT = var->data.re;
                 src  = var->data.im;
                 for (k=0; k<nEl; k++) {
                     int_T kT   = nRows*(k%nCols) + (k/nCols);
@@ -1277,21 +2010,10 @@ static const char_T *rt_FixupLogVar(LogVar *var,int verbose)
             (void)fclose(fptr);
             (void)remove(fName);
         } else {
-            for (k=0; k<nEl; k++) {
-                int_T kT   = nRows*(k%nCols) + (k/nCols);
-                char  *dst = pmT + kT*elSize;
-                (void)memcpy(dst, src, elSize);
-                src += elSize;
-            }
+            rt_TransposeBlocked(pmT, src, nRows, nCols, elSize);
             if (var->data.complex) {
                 char *pmiT = var->data.re;
-                src  = var->data.im;
-                for (k=0; k<nEl; k++) {
-                    int_T kT   = nRows*(k%nCols) + (k/nCols);
-                    char  *dst = pmiT + kT*elSize;
-                    (void)memcpy(dst, src, elSize);
-                    src += elSize;
-                }
+                rt_TransposeBlocked(pmiT, var->data.im, nRows, nCols, elSize);
                 var->data.re = var->data.im;
                 var->data.im = pmiT;
             }
@@ -1495,7 +2217,8 @@ static void rt_DestroyStructLogVar(StructLogVar *head)
 
         head = var->next;
 
-        if (var->logTime) { /* time is LogVar */
+        if (var->sharedTime) { /* time is owned by the LogInfo */
+        } else if (var->logTime) { /* time is LogVar */
             rt_DestroyLogVar(var->time);
         } else {        /* time is MatrixData */
             FREE(var->time);
@@ -2083,7 +2806,8 @@ static StructLogVar *local_CreateStructLogVar(
     int_T                   decimation,
     real_T                  sampleTime,
     const RTWLogSignalInfo  *sigInfo,
-    const char_T            *blockName)
+    const char_T            *blockName,
+    boolean_T               shareTime)
 {
     StructLogVar *var;
     LogInfo      *logInfo = rtliGetLogInfo(li);
@@ -2099,7 +2823,19 @@ static StructLogVar *local_CreateStructLogVar(
     rt_LoadModifiedLogVarName(li,varName,var->name);
 
     /* time field */
-    if (logTime) {
+    if (logTime && shareTime) {
+        /* all variables logged at each major time step share one time */
+        if (logInfo->sharedTime == NULL) {
+            int_T dims = 1;
+            logInfo->sharedTime = rt_CreateLogVarWithConvert(
+                li, startTime, finalTime, inStepSize, errStatus,
+                &TIME_FIELD_NAME, SS_DOUBLE, NULL, 0, 0, 0, 1, 1, &dims,
+                NO_LOGVALDIMS, NULL, NULL, maxRows, decimation, sampleTime, 0);
+            if (logInfo->sharedTime == NULL) goto ERROR_EXIT;
+        }
+        var->time       = logInfo->sharedTime;
+        var->sharedTime = true;
+    } else if (logTime) {
         /* need to create a LogVar to log time */
         int_T dims = 1;
         var->time = rt_CreateLogVarWithConvert(li, startTime, finalTime,
@@ -2335,7 +3071,8 @@ static const char_T *rt_StartDataLoggingForOutput(RTWLogInfo   *li,
                                                             errStatus, name,
                                                             logTime, maxRows,
                                                             decimation, sampleTime,
-                                                            &yInfo[yIdx], NULL);
+                                                            &yInfo[yIdx], NULL,
+                                                            true);
                 if (logInfo->y[yIdx] == NULL) goto ERROR_EXIT;
             }
             ++yIdx;
@@ -2352,213 +3089,1195 @@ static const char_T *rt_StartDataLoggingForOutput(RTWLogInfo   *li,
     if (*errStatus == NULL) {
         *errStatus = rtMemAllocError;
     }
-    if (logInfo) {
-        rt_DestroyLogVar(logInfo->logVarsList);
-        logInfo->logVarsList = NULL;
-        rt_DestroyStructLogVar(logInfo->structLogVarsList);
-        logInfo->structLogVarsList = NULL;
-        FREE(logInfo->y);
-        logInfo->y = NULL;
+    if (logInfo) {
+        rt_DestroyLogVar(logInfo->logVarsList);
+        logInfo->logVarsList = NULL;
+        rt_DestroyStructLogVar(logInfo->structLogVarsList);
+        logInfo->structLogVarsList = NULL;
+        rt_DestroyLogVar(logInfo->sharedTime);
+        logInfo->sharedTime = NULL;
+        FREE(logInfo->y);
+        logInfo->y = NULL;
+    }
+    return(*errStatus);
+
+} /* end rt_StartDataLoggingForOutput */
+
+
+/* Function: rt_ReallocLogVar ==================================================
+ * Abstract:
+ *   Allocate more memory for the data buffers in the log variable.
+ *   Exit if unable to allocate more memory.
+ */
+static void rt_ReallocLogVar(LogVar *var, boolean_T isVarDims)
+{
+    void *tmp;
+    int_T nCols = var->data.nCols;
+    int_T nRows = var->data.nRows + DEFAULT_BUFFER_SIZE;
+    size_t elSize = var->data.elSize;
+    
+    tmp = realloc(var->data.re, nRows*nCols*elSize);
+    if (tmp == NULL) {
+        (void)fprintf(stderr,
+                      "*** Memory allocation error.\n");
+        (void)fprintf(stderr, ""
+                      "    varName          = %s%s\n"
+                      "    nRows            = %d\n"
+                      "    nCols            = %d\n"
+                      "    elementSize      = %lu\n"
+                      "    Current Size     = %.16g\n"
+                      "    Failed resize    = %.16g\n\n",
+                      var->data.name,
+                      var->data.complex ? " (real part)" : "",
+                      var->data.nRows,
+                      var->data.nCols,
+                      (long)  var->data.elSize,
+                      (double)nRows*nCols*elSize,
+                      (double)(nRows+DEFAULT_BUFFER_SIZE)*nCols*elSize);
+        exit(1);
+    }
+    var->data.re = tmp;
+
+    if (var->data.complex) {
+        tmp = realloc(var->data.im, nRows*nCols*elSize);
+        if (tmp == NULL) {
+            (void)fprintf(stderr,
+                          "*** Memory allocation error.\n");
+            (void)fprintf(stderr, ""
+                          "    varName          = %s (complex part)\n"
+                          "    nRows            = %d\n"
+                          "    nCols            = %d\n"
+                          "    elementSize      = %lu\n"
+                          "    Current Size     = %.16g\n"
+                          "    Failed resize    = %.16g\n\n",
+                          var->data.name,
+                          var->data.nRows,
+                          var->data.nCols,
+                          (long)  var->data.elSize,
+                          (double)nRows*nCols*elSize,
+                          (double)(nRows+DEFAULT_BUFFER_SIZE)*nCols*elSize);
+            exit(1);
+        }
+        var->data.im = tmp;
+    }
+
+    /* Move the columns apart to the new column stride, last one first */
+    if (var->colMajor) {
+        int_T  oldRows = var->data.nRows;
+        int_T  c;
+
+        for (c = nCols-1; c > 0; c--) {
+            (void)memmove((char_T*)(var->data.re) + (size_t)c*nRows*elSize,
+                          (char_T*)(var->data.re) + (size_t)c*oldRows*elSize,
+                          (size_t)oldRows*elSize);
+            if (var->data.complex) {
+                (void)memmove((char_T*)(var->data.im) + (size_t)c*nRows*elSize,
+                              (char_T*)(var->data.im) + (size_t)c*oldRows*elSize,
+                              (size_t)oldRows*elSize);
+            }
+        }
+    }
+    var->data.nRows = nRows;
+
+    /* Also reallocate memory for "valueDimensions" 
+       when logging the variable-size signal
+    */
+    if(isVarDims){
+        int_T k;
+        
+        nCols = var->valDims->nCols;
+        nRows = var->valDims->nRows + DEFAULT_BUFFER_SIZE;
+        elSize = sizeof(real_T);
+        tmp = realloc(var->valDims->dimsData, nRows*nCols*elSize);
+        if (tmp == NULL) {
+            (void)fprintf(stderr,
+                          "*** Memory allocation error.\n");
+            (void)fprintf(stderr, ""
+                          "    varName          = %s\n"
+                          "    nRows            = %d\n"
+                          "    nCols            = %d\n"
+                          "    elementSize      = %lu\n"
+                          "    Current Size     = %.16g\n"
+                          "    Failed resize    = %.16g\n\n",
+                          var->valDims->name,
+                          var->valDims->nRows,
+                          var->valDims->nCols,
+                          (long)  elSize,
+                          (double)nRows*nCols*elSize,
+                          (double)(nRows+DEFAULT_BUFFER_SIZE)*nCols*elSize);
+            exit(1);
+        }
+
+        /*
+         * valueDimensions data is stored in array format and must be
+         * adjusted after reallocation (see also rt_FixupLogVar())
+         *
+         * Example: maxRows = 4; nRows = 4; nDims = 3;
+         * Before realloc of the logVar, the locations of data are as below:
+         * (x, y, z -- useful data / o -- junk, don't care)
+         * a[0] = x    a[4] = y    a[8] = z
+         * a[1] = x    a[5] = y    a[9] = z
+         * a[2] = x    a[6] = y    a[10]= z
+         * a[3] = x    a[7] = y    a[11]= z
+         *
+         * After realloc of the logVar (suppose 2 extra rows are added),
+         * the locations of data are as below:
+         * a[0] = x    a[6] = y    a[12]= o
+         * a[1] = x    a[7] = y    a[13]= o
+         * a[2] = x    a[8] = z    a[14]= o
+         * a[3] = x    a[9] = z    a[15]= o
+         * a[4] = y    a[10]= z    a[16]= o
+         * a[5] = y    a[11]= z    a[17]= o
+         *
+         * The data must be adjusted as below:
+         * a[0] = x    a[6] = y    a[12]= z
+         * a[1] = x    a[7] = y    a[13]= z
+         * a[2] = x    a[8] = y    a[14]= z
+         * a[3] = x    a[9] = y    a[15]= z
+         * a[4] = o    a[10]= o    a[16]= o
+         * a[5] = o    a[11]= o    a[17]= o
+         */
+        for(k = var->data.nDims-1; k > 0; k--){
+            (void) memcpy((real_T*)tmp + k*nRows, 
+                          (real_T*)tmp + k*var->valDims->nRows,
+                          elSize * var->valDims->nRows);
+        }
+
+        var->valDims->dimsData = tmp;
+        var->valDims->nRows = nRows;
+    }
+
+} /* end rt_ReallocLogVar */
+
+
+/* Function: rt_UpdateLogVarWithDiscontiguousData ==============================
+ * Abstract:
+ *      Log one row of the LogVar with data that is not contiguous.
+ */
+static void rt_UpdateLogVarWithDiscontiguousData(LogVar            *var,
+                                                 LogSignalPtrsType data,
+                                                 const int_T       *segmentLengths,
+                                                 int_T             nSegments)
+{
+    size_t elSize  = 0;
+    size_t offset  = 0;
+    size_t dstStep = 0;
+    int    segIdx  = 0;
+
+    if (++var->numHits % var->decimation) return;
+    var->numHits = 0;
+
+    /*
+     * Reallocate or wrap the LogVar
+     */
+    if (var->rowIdx == var->data.nRows) {
+        if (var->okayToRealloc == 1) {
+            rt_ReallocLogVar(var, false);
+        } else {
+            /* Circular buffer */
+            var->rowIdx = 0;
+            ++(var->wrapped); /* increment the wrap around counter */
+        }
+    }
+
+    /* This function is only used to log states, there's no var-dims issue. */
+    elSize = var->data.elSize;
+    if (var->colMajor) {
+        offset  = (size_t)(elSize * var->rowIdx);
+        dstStep = (size_t)(elSize * var->data.nRows);
+    } else {
+        offset  = (size_t)(elSize * var->rowIdx * var->data.nCols);
+        dstStep = elSize;
+    }
+
+    if (var->data.complex || var->colMajor) {
+        char_T *dstRe = (char_T*)(var->data.re) + offset;
+        char_T *dstIm = var->data.complex ?
+                        (char_T*)(var->data.im) + offset : NULL;
+
+        for (segIdx = 0; segIdx < nSegments; segIdx++) {
+            int_T         nEl  = segmentLengths[segIdx];
+            const  char_T *src = (const void *)data[segIdx];
+            int_T         el;
+
+            for (el = 0; el < nEl; el++) {
+                (void)memcpy(dstRe, src, elSize);
+                dstRe += dstStep;   src += elSize;
+                if (dstIm != NULL) {
+                    (void)memcpy(dstIm, src, elSize);
+                    dstIm += dstStep;   src += elSize;
+                }
+            }
+        }
+    } else {
+        char_T *dst = (char_T*)(var->data.re) + offset;
+
+        for (segIdx = 0; segIdx < nSegments; segIdx++) {
+            size_t      segSize = elSize*segmentLengths[segIdx];
+            const  void *src    = data[segIdx];
+
+            (void)memcpy(dst, src, segSize);
+            dst += segSize;
+        }
+    }
+
+    ++var->rowIdx;
+    return;
+
+} /* end rt_UpdateLogVarWithDiscontiguousData */
+
+
+#ifdef RT_LOGGING_ASYNC
+
+/*
+ * Asynchronous logging
+ *
+ * With RT_LOGGING_ASYNC defined, rt_StartDataLogging starts a background
+ * thread that owns the time, state and output log variables. At each call
+ * of rt_UpdateTXXFYLogVars the model thread only copies the data reachable
+ * through the logging signal pointers into a preallocated snapshot and
+ * queues it. The logging thread then does the decimation, buffer wrapping,
+ * reallocation and data type conversion on the snapshot, exactly as the
+ * synchronous update would on the live signals. The model thread blocks
+ * only when all RT_LOGGING_ASYNC_SLOTS snapshots are queued.
+ * rt_StopDataLogging drains the queue and joins the thread before the
+ * MAT-file is written.
+ *
+ * Models that log variable-size signals are logged synchronously, since
+ * the size of a snapshot is not known up front. Log variables updated
+ * directly with rt_UpdateLogVar, e.g. by To Workspace blocks, are not
+ * affected.
+ */
+
+#ifndef RT_LOGGING_ASYNC_SLOTS
+#define RT_LOGGING_ASYNC_SLOTS   256   /* snapshots queued at most            */
+#endif
+
+#define ASYNC_LOG_ALIGN(n)       (((n) + 15) & ~((size_t)15))
+
+typedef struct AsyncLogPtrs_Tag {
+    LogSignalPtrsType ptrs;            /* The model's signal pointers         */
+    int_T             numPtrs;         /* Number of signal pointers read      */
+    size_t            *offset;         /* Offset of each signal in a snapshot */
+    size_t            *nBytes;         /* Bytes read through each pointer     */
+    const int8_T      **shadow;        /* Signal pointers into a snapshot     */
+} AsyncLogPtrs;
+
+typedef struct AsyncLogSlot_Tag {
+    time_T       t;                    /* Time of the snapshot                */
+    boolean_T    updateTXY;            /* As passed to rt_UpdateTXXFYLogVars  */
+    boolean_T    stop;                 /* Last slot, logging thread exits     */
+    char_T       *data;                /* Copy of the logged signals          */
+    const char_T *errStatus;           /* Result of logging the snapshot      */
+} AsyncLogSlot;
+
+typedef struct AsyncLog_Tag {
+    RTWLogInfo   li;                   /* The model's RTWLogInfo with the
+                                          signal pointers of a snapshot       */
+    AsyncLogPtrs x;
+    AsyncLogPtrs y;
+    int_T        numSlots;
+    AsyncLogSlot *slots;
+    int_T        head;                 /* Next slot filled by model thread    */
+    int_T        tail;                 /* Next slot logged by logging thread  */
+    sem_t        numFree;
+    sem_t        numFilled;
+    pthread_t    thread;
+} AsyncLog;
+
+static const char_T *rt_UpdateTXXFYLogVarsImpl(RTWLogInfo *li,
+                                               time_T     *tPtr,
+                                               boolean_T  updateTXY);
+
+
+/* Function: rt_GetLogVarInputSize =============================================
+ * Abstract:
+ *      Return the number of bytes rt_UpdateLogVar reads from its data
+ *      pointer when updating var.
+ */
+static size_t rt_GetLogVarInputSize(const LogVar *var)
+{
+    const RTWLogDataTypeConvert *pCvt = &var->data.dataTypeConvertInfo;
+    size_t nPoints = (size_t)var->data.nCols *
+                     (var->data.frameData ? var->data.frameSize : 1);
+    size_t pointSize;
+
+    if (!pCvt->conversionNeeded) {
+        pointSize = var->data.complex ?
+            rt_GetSizeofComplexType(var->data.dTypeID) : var->data.elSize;
+    } else if (pCvt->numOfChunk > 1) {
+        pointSize = (size_t)(pCvt->bitsPerChunk * pCvt->numOfChunk / 8) *
+                    (var->data.complex ? 2 : 1);
+    } else {
+        pointSize = var->data.complex ?
+            rt_GetSizeofComplexType(pCvt->dataTypeIdOriginal) :
+            rt_GetSizeofDataType(pCvt->dataTypeIdOriginal);
+    }
+    return(nPoints * pointSize);
+
+} /* end rt_GetLogVarInputSize */
+
+
+/* Function: rt_AsyncLogNoteRead ===============================================
+ * Abstract:
+ *      Record that nBytes are read through signal pointer idx. On the first
+ *      planning pass nBytes is not yet allocated and only the number of
+ *      pointers is counted.
+ */
+static void rt_AsyncLogNoteRead(AsyncLogPtrs *p, int_T idx, size_t nBytes)
+{
+    if (idx >= p->numPtrs) {
+        p->numPtrs = idx + 1;
+    }
+    if (p->nBytes != NULL && nBytes > p->nBytes[idx]) {
+        p->nBytes[idx] = nBytes;
+    }
+
+} /* end rt_AsyncLogNoteRead */
+
+
+/* Function: rt_AsyncLogPlan ===================================================
+ * Abstract:
+ *      Walk the log variables in the same order as rt_UpdateTXXFYLogVarsImpl
+ *      and record which signal pointers it reads and how many bytes through
+ *      each. Keep the two in step.
+ *
+ * Returns:
+ *      false if a variable-size signal is logged, true otherwise.
+ */
+static boolean_T rt_AsyncLogPlan(RTWLogInfo *li, AsyncLog *async)
+{
+    LogInfo *logInfo = rtliGetLogInfo(li);
+    int_T   i;
+
+    if (rtliGetLogFormat(li) == 0) {                         /* MATRIX_FORMAT */
+        /* states */
+        if (logInfo->x != NULL || logInfo->xFinal != NULL) {
+            const RTWLogSignalInfo *xInfo = rtliGetLogXSignalInfo(li);
+            const LogVar           *var   = (logInfo->x != NULL) ?
+                (const LogVar*)logInfo->x : (const LogVar*)logInfo->xFinal;
+            size_t pointSize = var->data.elSize * (var->data.complex ? 2 : 1);
+
+            for (i = 0; i < xInfo->numSignals; i++) {
+                rt_AsyncLogNoteRead(&async->x, i, pointSize*xInfo->numCols[i]);
+            }
+        }
+        /* outputs */
+        if (logInfo->y != NULL) {
+            LogVar            **var = (LogVar**) (logInfo->y);
+            LogSignalPtrsType data  = rtliGetLogYSignalPtrs(li);
+            int_T             yIdx;
+
+            for (i = 0, yIdx = 0; i < logInfo->ny; i++) {
+                rt_AsyncLogNoteRead(&async->y, i, (data[i] != NULL) ?
+                                    rt_GetLogVarInputSize(var[yIdx++]) : 0);
+            }
+        }
+    } else {                                              /* STRUCTURE_FORMAT */
+        StructLogVar *xVars[2];
+        int_T        k;
+
+        /* states and final state */
+        xVars[0] = logInfo->x;
+        xVars[1] = logInfo->xFinal;
+        for (k = 0; k < 2; k++) {
+            if (xVars[k] != NULL) {
+                LogVar *val = xVars[k]->signals.values;
+
+                for (i = 0; i < xVars[k]->signals.numSignals; i++) {
+                    rt_AsyncLogNoteRead(&async->x, i, rt_GetLogVarInputSize(val));
+                    val = val->next;
+                }
+            }
+        }
+
+        /* outputs */
+        if (logInfo->y != NULL) {
+            int_T             ny    = logInfo->ny;
+            LogSignalPtrsType data  = rtliGetLogYSignalPtrs(li);
+            StructLogVar      **var = (StructLogVar**) (logInfo->y);
+            int_T             dataIdx;
+
+            if (ny == 1) {
+                LogVar *val = var[0]->signals.values;
+
+                for (i = 0, dataIdx = 0; i < var[0]->signals.numSignals; i++) {
+                    while (data[dataIdx] == NULL) {
+                        ++dataIdx;
+                    }
+                    if (var[0]->signals.isVarDims[i]) return(false);
+                    rt_AsyncLogNoteRead(&async->y, dataIdx,
+                                        rt_GetLogVarInputSize(val));
+                    val = val->next;
+                    ++dataIdx;
+                }
+            } else {
+                for (i = 0, dataIdx = 0; i < ny && var[i] != NULL; i++) {
+                    while (data[dataIdx] == NULL) {
+                        ++dataIdx;
+                    }
+                    if (var[i]->signals.isVarDims[0]) return(false);
+                    rt_AsyncLogNoteRead(&async->y, dataIdx,
+                                        rt_GetLogVarInputSize(var[i]->signals.values));
+                    ++dataIdx;
+                }
+            }
+        }
+    }
+    return(true);
+
+} /* end rt_AsyncLogPlan */
+
+
+/* Function: rt_AsyncLogAllocPtrs ==============================================
+ * Abstract:
+ *      Allocate the per pointer arrays once the number of pointers is known.
+ */
+static boolean_T rt_AsyncLogAllocPtrs(AsyncLogPtrs *p)
+{
+    if (p->numPtrs == 0) return(true);
+
+    p->offset = calloc(p->numPtrs, sizeof(size_t));
+    p->nBytes = calloc(p->numPtrs, sizeof(size_t));
+    p->shadow = calloc(p->numPtrs, sizeof(const int8_T *));
+    return((boolean_T)(p->offset != NULL && p->nBytes != NULL &&
+                       p->shadow != NULL));
+
+} /* end rt_AsyncLogAllocPtrs */
+
+
+/* Function: rt_AsyncLogCopy ===================================================
+ * Abstract:
+ *      Copy the signals read through p into a snapshot.
+ */
+static void rt_AsyncLogCopy(const AsyncLogPtrs *p, char_T *snapshot)
+{
+    int_T i;
+
+    for (i = 0; i < p->numPtrs; i++) {
+        if (p->nBytes[i] > 0) {
+            (void)memcpy(snapshot + p->offset[i], p->ptrs[i], p->nBytes[i]);
+        }
+    }
+
+} /* end rt_AsyncLogCopy */
+
+
+/* Function: rt_AsyncLogRepoint ================================================
+ * Abstract:
+ *      Point the shadow signal pointers at a snapshot. Pointers that are
+ *      NULL in the model stay NULL so that they are skipped in the same way.
+ */
+static void rt_AsyncLogRepoint(AsyncLogPtrs *p, const char_T *snapshot)
+{
+    int_T i;
+
+    for (i = 0; i < p->numPtrs; i++) {
+        p->shadow[i] = (p->ptrs[i] != NULL) ?
+            (const int8_T *)(snapshot + p->offset[i]) : NULL;
+    }
+
+} /* end rt_AsyncLogRepoint */
+
+
+/* Function: rt_AsyncLogPut ====================================================
+ * Abstract:
+ *      Model thread: queue a snapshot of the logged signals, or the request
+ *      to stop. Blocks only while the queue is full.
+ *
+ * Returns:
+ *	The error, if any, of logging the snapshot previously held by the
+ *	slot, so that logging errors reach the model thread one lap of the
+ *	queue later.
+ */
+static const char_T *rt_AsyncLogPut(AsyncLog        *async,
+                                    const time_T    *tPtr,
+                                    boolean_T       updateTXY,
+                                    boolean_T       stop)
+{
+    AsyncLogSlot *slot;
+    const char_T *errStatus;
+
+    while (sem_wait(&async->numFree) != 0) {
+        /* interrupted by a signal, retry */
+    }
+    slot = &async->slots[async->head];
+    errStatus       = slot->errStatus;
+    slot->errStatus = NULL;
+    if (!stop) {
+        rt_AsyncLogCopy(&async->x, slot->data);
+        rt_AsyncLogCopy(&async->y, slot->data);
+        slot->t = (tPtr != NULL) ? *tPtr : 0.0;
+    }
+    slot->updateTXY = updateTXY;
+    slot->stop      = stop;
+    async->head     = (async->head + 1) % async->numSlots;
+    (void)sem_post(&async->numFilled);
+    return(errStatus);
+
+} /* end rt_AsyncLogPut */
+
+
+/* Function: rt_AsyncLogThread =================================================
+ * Abstract:
+ *      Logging thread: update the log variables from the queued snapshots
+ *      until the stop request.
+ */
+static void *rt_AsyncLogThread(void *arg)
+{
+    AsyncLog *async = (AsyncLog *)arg;
+
+    for (;;) {
+        AsyncLogSlot *slot;
+
+        while (sem_wait(&async->numFilled) != 0) {
+            /* interrupted by a signal, retry */
+        }
+        slot = &async->slots[async->tail];
+        if (slot->stop) break;
+
+        rt_AsyncLogRepoint(&async->x, slot->data);
+        rt_AsyncLogRepoint(&async->y, slot->data);
+        slot->errStatus = rt_UpdateTXXFYLogVarsImpl(&async->li, &slot->t,
+                                                    slot->updateTXY);
+
+        async->tail = (async->tail + 1) % async->numSlots;
+        (void)sem_post(&async->numFree);
+    }
+    return(NULL);
+
+} /* end rt_AsyncLogThread */
+
+
+/* Function: rt_DestroyAsyncLog ================================================
+ * Abstract:
+ *      Free an AsyncLog whose thread is not running.
+ */
+static void rt_DestroyAsyncLog(AsyncLog *async)
+{
+    int_T i;
+
+    if (async->slots != NULL) {
+        for (i = 0; i < async->numSlots; i++) {
+            FREE(async->slots[i].data);
+        }
+        free(async->slots);
+    }
+    FREE(async->x.offset);
+    FREE(async->x.nBytes);
+    FREE(async->x.shadow);
+    FREE(async->y.offset);
+    FREE(async->y.nBytes);
+    FREE(async->y.shadow);
+    free(async);
+
+} /* end rt_DestroyAsyncLog */
+
+
+/* Function: rt_StartAsyncLogging ==============================================
+ * Abstract:
+ *      Size the snapshots, allocate the queue and start the logging thread.
+ *      If variable-size signals are logged or the thread cannot be started,
+ *      logging stays synchronous.
+ *
+ * Returns:
+ *	== NULL  => success
+ *	!= NULL  => memory allocation error
+ */
+static const char_T *rt_StartAsyncLogging(RTWLogInfo *li, LogInfo *logInfo)
+{
+    AsyncLog *async;
+    size_t   slotSize = 0;
+    int_T    i;
+
+    if ((async = calloc(1, sizeof(AsyncLog))) == NULL) {
+        return(rtMemAllocError);
+    }
+    async->li     = *li;
+    async->x.ptrs = rtliGetLogXSignalPtrs(li);
+    async->y.ptrs = rtliGetLogYSignalPtrs(li);
+
+    /* First pass counts the signal pointers, second one sizes them */
+    if (!rt_AsyncLogPlan(li, async)) {
+        rt_DestroyAsyncLog(async);
+        return(NULL);
+    }
+    if (!rt_AsyncLogAllocPtrs(&async->x) || !rt_AsyncLogAllocPtrs(&async->y)) {
+        goto ERROR_EXIT;
+    }
+    (void)rt_AsyncLogPlan(li, async);
+
+    /* Each signal aligned as the conversion routines dereference it */
+    for (i = 0; i < async->x.numPtrs; i++) {
+        async->x.offset[i] = slotSize;
+        slotSize += ASYNC_LOG_ALIGN(async->x.nBytes[i]);
+    }
+    for (i = 0; i < async->y.numPtrs; i++) {
+        async->y.offset[i] = slotSize;
+        slotSize += ASYNC_LOG_ALIGN(async->y.nBytes[i]);
+    }
+
+    async->numSlots = RT_LOGGING_ASYNC_SLOTS;
+    if ((async->slots = calloc(async->numSlots, sizeof(AsyncLogSlot))) == NULL) {
+        goto ERROR_EXIT;
+    }
+    for (i = 0; i < async->numSlots; i++) {
+        if ((async->slots[i].data = malloc(slotSize + 1)) == NULL) {
+            goto ERROR_EXIT;
+        }
+    }
+
+    rtliSetLogXSignalPtrs(&async->li, (LogSignalPtrsType)async->x.shadow);
+    rtliSetLogYSignalPtrs(&async->li, (LogSignalPtrsType)async->y.shadow);
+
+    if (sem_init(&async->numFree, 0, (unsigned int)async->numSlots) != 0) {
+        rt_DestroyAsyncLog(async);
+        return(NULL);
+    }
+    if (sem_init(&async->numFilled, 0, 0) != 0) {
+        (void)sem_destroy(&async->numFree);
+        rt_DestroyAsyncLog(async);
+        return(NULL);
+    }
+    if (pthread_create(&async->thread, NULL, rt_AsyncLogThread, async) != 0) {
+        (void)sem_destroy(&async->numFree);
+        (void)sem_destroy(&async->numFilled);
+        rt_DestroyAsyncLog(async);
+        return(NULL);
+    }
+
+    logInfo->async = async;
+    return(NULL);
+
+ ERROR_EXIT:
+    rt_DestroyAsyncLog(async);
+    return(rtMemAllocError);
+
+} /* end rt_StartAsyncLogging */
+
+
+/* Function: rt_StopAsyncLogging ===============================================
+ * Abstract:
+ *      Log the queued snapshots, then stop the logging thread. The log
+ *      variables are owned by the model thread again on return.
+ *
+ * Returns:
+ *	The first error, in queue order, of logging the snapshots whose
+ *	result had not reached the model thread yet, or NULL.
+ */
+static const char_T *rt_StopAsyncLogging(LogInfo *logInfo)
+{
+    AsyncLog     *async = (AsyncLog *)logInfo->async;
+    const char_T *errStatus;
+    int_T        i;
+
+    if (async == NULL) return(NULL);
+
+    errStatus = rt_AsyncLogPut(async, NULL, false, true);
+    (void)pthread_join(async->thread, NULL);
+
+    /* The stop request went into the oldest slot; the others, from the
+     * head on, hold the results of the last lap */
+    for (i = 0; errStatus == NULL && i < async->numSlots; i++) {
+        errStatus = async->slots[(async->head + i) % async->numSlots].errStatus;
+    }
+
+    (void)sem_destroy(&async->numFree);
+    (void)sem_destroy(&async->numFilled);
+    rt_DestroyAsyncLog(async);
+    logInfo->async = NULL;
+    return(errStatus);
+
+} /* end rt_StopAsyncLogging */
+
+#endif /* RT_LOGGING_ASYNC */
+
+
+#ifdef RT_LOGGING_CHUNKED
+
+/*
+ * Chunked log file
+ *
+ * With RT_LOGGING_CHUNKED defined and a file set with rt_SetChunkedLogFile,
+ * rt_StartDataLogging also creates a chunked log file (rt_logging_chunked.h)
+ * with the time, states and outputs. Every chunkRows logged time steps, the
+ * rows just logged are copied out of the log variables' buffers into a
+ * chunk, one column after the other, and appended to the file. The chunk
+ * index is written by rt_StopDataLogging.
+ *
+ * Since the chunks are taken from the buffers, the log variables are made
+ * circular: the MAT-file then only holds the last maxRows rows (the default
+ * buffer size if maxRows is 0), and chunkRows is reduced to the size of the
+ * smallest buffer if needed. Frame-based and variable-size signals, and the
+ * final states, are not written to the chunked log.
+ */
+
+typedef struct ChunkedLogIndexEntry_Tag {
+    uint64_T offset;
+    uint64_T firstRow;
+    uint32_T nRows;
+    real_T   tFirst;
+    real_T   tLast;
+} ChunkedLogIndexEntry;
+
+typedef struct ChunkedLog_Tag {
+    FILE                 *fp;
+    int_T                chunkRows;
+    int_T                decimation;
+    int_T                numHits;      /* decimation, as in rt_UpdateLogVar   */
+    int_T                numVars;
+    LogVar               **vars;       /* signals written to each chunk       */
+    char_T               **names;
+    const char_T         **blockNames;
+    real_T               *time;        /* times of the rows not yet written   */
+    int_T                nPending;
+    uint64_T             nRowsWritten;
+    uint64_T             fileSize;
+    char_T               *buf;         /* one signal of one chunk             */
+    int_T                numChunks;
+    int_T                maxChunks;
+    ChunkedLogIndexEntry *index;
+} ChunkedLog;
+
+static const char_T *rtChunkedLogFile = NULL;
+static int_T        rtChunkedLogRows  = 0;
+
+static const char_T rtChunkedLogOpenError[]  = "unable to open chunked log file";
+static const char_T rtChunkedLogWriteError[] = "unable to write chunked log file";
+
+
+/* Function: rt_ChunkedLogWrite ================================================
+ * Abstract:
+ *      Append nBytes to the chunked log file.
+ */
+static boolean_T rt_ChunkedLogWrite(ChunkedLog *cl, const void *data, size_t nBytes)
+{
+    if (fwrite(data, 1, nBytes, cl->fp) != nBytes) return(false);
+    cl->fileSize += nBytes;
+    return(true);
+
+} /* end rt_ChunkedLogWrite */
+
+
+/* Function: rt_ChunkedLogWriteU32 =============================================
+ * Abstract:
+ *      Append a uint32_T to the chunked log file.
+ */
+static boolean_T rt_ChunkedLogWriteU32(ChunkedLog *cl, uint32_T value)
+{
+    return(rt_ChunkedLogWrite(cl, &value, sizeof(value)));
+
+} /* end rt_ChunkedLogWriteU32 */
+
+
+/* Function: rt_ChunkedLogAddVar ===============================================
+ * Abstract:
+ *      Add a log variable to the signals written to each chunk. The name is
+ *      varName, or varName.signals(sigIdx+1) for a signal of a structure.
+ */
+static const char_T *rt_ChunkedLogAddVar(ChunkedLog   *cl,
+                                         LogVar       *var,
+                                         const char_T *varName,
+                                         int_T        sigIdx,
+                                         const char_T *blockName)
+{
+    char_T *name;
+
+    if (var->data.frameData || var->valDims != NULL) {
+        (void)fprintf(stderr, "*** Frame-based or variable-size signal %s "
+                      "not written to the chunked log\n", varName);
+        return(NULL);
+    }
+    if ((name = malloc(strlen(varName) + 32)) == NULL) return(rtMemAllocError);
+    if (sigIdx < 0) {
+        (void)strcpy(name, varName);
+    } else {
+        (void)sprintf(name, "%s.signals(%d)", varName, sigIdx + 1);
+    }
+
+    cl->vars[cl->numVars]       = var;
+    cl->names[cl->numVars]      = name;
+    cl->blockNames[cl->numVars] = (blockName != NULL) ? blockName : "";
+    cl->numVars++;
+
+    if (var->data.nRows < cl->chunkRows) {
+        cl->chunkRows = var->data.nRows;
+    }
+    return(NULL);
+
+} /* end rt_ChunkedLogAddVar */
+
+
+/* Function: rt_ChunkedLogAddStructVar =========================================
+ * Abstract:
+ *      Add the signals of a structure log variable, with their block names
+ *      from sigInfo.
+ */
+static const char_T *rt_ChunkedLogAddStructVar(ChunkedLog             *cl,
+                                               StructLogVar           *svar,
+                                               const RTWLogSignalInfo *sigInfo)
+{
+    const char_T **blockNames = (sigInfo != NULL) ? sigInfo->blockNames.cptr : NULL;
+    LogVar       *val         = svar->signals.values;
+    int_T        i;
+
+    for (i = 0; i < svar->signals.numSignals && val != NULL; i++) {
+        const char_T *errStatus = rt_ChunkedLogAddVar(
+            cl, val, svar->name, i,
+            (blockNames != NULL && i < sigInfo->numSignals) ? blockNames[i] : NULL);
+        if (errStatus != NULL) return(errStatus);
+        val = val->next;
+    }
+    return(NULL);
+
+} /* end rt_ChunkedLogAddStructVar */
+
+
+/* Function: rt_ChunkedLogWriteHeader ==========================================
+ * Abstract:
+ *      Write the file header and the signal descriptors.
+ */
+static boolean_T rt_ChunkedLogWriteHeader(ChunkedLog *cl)
+{
+    int_T i;
+
+    if (!rt_ChunkedLogWrite(cl, RT_CHUNKED_LOG_MAGIC, 8) ||
+        !rt_ChunkedLogWriteU32(cl, RT_CHUNKED_LOG_VERSION) ||
+        !rt_ChunkedLogWriteU32(cl, RT_CHUNKED_LOG_BYTE_ORDER) ||
+        !rt_ChunkedLogWriteU32(cl, (uint32_T)cl->chunkRows) ||
+        !rt_ChunkedLogWriteU32(cl, (uint32_T)cl->numVars)) {
+        return(false);
+    }
+    for (i = 0; i < cl->numVars; i++) {
+        const MatrixData *data = &cl->vars[i]->data;
+        uint32_T         nameLen  = (uint32_T)strlen(cl->names[i]);
+        uint32_T         blockLen = (uint32_T)strlen(cl->blockNames[i]);
+        int_T            d;
+
+        if (!rt_ChunkedLogWriteU32(cl, nameLen) ||
+            !rt_ChunkedLogWrite(cl, cl->names[i], nameLen) ||
+            !rt_ChunkedLogWriteU32(cl, blockLen) ||
+            !rt_ChunkedLogWrite(cl, cl->blockNames[i], blockLen) ||
+            !rt_ChunkedLogWriteU32(cl, (uint32_T)data->dTypeID) ||
+            !rt_ChunkedLogWriteU32(cl, (uint32_T)data->elSize) ||
+            !rt_ChunkedLogWriteU32(cl, data->complex ? 1U : 0U) ||
+            !rt_ChunkedLogWriteU32(cl, (uint32_T)data->nCols) ||
+            !rt_ChunkedLogWriteU32(cl, (uint32_T)data->nDims)) {
+            return(false);
+        }
+        for (d = 0; d < data->nDims; d++) {
+            int32_T dim = (int32_T)data->dims[d];
+            if (!rt_ChunkedLogWrite(cl, &dim, sizeof(dim))) return(false);
+        }
+    }
+    return(true);
+
+} /* end rt_ChunkedLogWriteHeader */
+
+
+/* Function: rt_ChunkedLogWriteColumns =========================================
+ * Abstract:
+ *      Write the last nRows rows logged in buffer re (or im) of var, one
+ *      column after the other.
+ */
+static boolean_T rt_ChunkedLogWriteColumns(ChunkedLog   *cl,
+                                           const LogVar *var,
+                                           const char_T *re,
+                                           int_T        nRows)
+{
+    size_t elSize    = var->data.elSize;
+    int_T  nCols     = var->data.nCols;
+    int_T  bufRows   = var->data.nRows;
+    int_T  firstRow  = var->rowIdx - nRows;  /* may be negative if wrapped */
+    size_t rowStep   = var->colMajor ? elSize : elSize * nCols;
+    size_t colStep   = var->colMajor ? elSize * bufRows : elSize;
+    char_T *dst      = cl->buf;
+    int_T  c, k;
+
+    if (firstRow < 0) firstRow += bufRows;
+
+    for (c = 0; c < nCols; c++) {
+        const char_T *src = re + c * colStep;
+        int_T        r    = firstRow;
+
+        for (k = 0; k < nRows; k++) {
+            (void)memcpy(dst, src + r * rowStep, elSize);
+            dst += elSize;
+            if (++r == bufRows) r = 0;
+        }
+    }
+    return(rt_ChunkedLogWrite(cl, cl->buf, (size_t)nRows * nCols * elSize));
+
+} /* end rt_ChunkedLogWriteColumns */
+
+
+/* Function: rt_ChunkedLogFlush ================================================
+ * Abstract:
+ *      Write the rows logged since the last chunk as a new chunk.
+ */
+static boolean_T rt_ChunkedLogFlush(ChunkedLog *cl)
+{
+    ChunkedLogIndexEntry *entry;
+    int_T                nRows = cl->nPending;
+    int_T                i;
+
+    if (nRows == 0) return(true);
+
+    if (cl->numChunks == cl->maxChunks) {
+        int_T                maxChunks = (cl->maxChunks == 0) ? 64 : 2 * cl->maxChunks;
+        ChunkedLogIndexEntry *index    = realloc(cl->index,
+                                                 maxChunks * sizeof(ChunkedLogIndexEntry));
+        if (index == NULL) return(false);
+        cl->index     = index;
+        cl->maxChunks = maxChunks;
+    }
+    entry           = &cl->index[cl->numChunks++];
+    entry->offset   = cl->fileSize;
+    entry->firstRow = cl->nRowsWritten;
+    entry->nRows    = (uint32_T)nRows;
+    entry->tFirst   = cl->time[0];
+    entry->tLast    = cl->time[nRows-1];
+
+    if (!rt_ChunkedLogWrite(cl, RT_CHUNKED_LOG_CHUNK_MAGIC, 4) ||
+        !rt_ChunkedLogWriteU32(cl, entry->nRows) ||
+        !rt_ChunkedLogWrite(cl, &entry->firstRow, sizeof(entry->firstRow)) ||
+        !rt_ChunkedLogWrite(cl, &entry->tFirst, sizeof(entry->tFirst)) ||
+        !rt_ChunkedLogWrite(cl, &entry->tLast, sizeof(entry->tLast)) ||
+        !rt_ChunkedLogWrite(cl, cl->time, nRows * sizeof(real_T))) {
+        return(false);
+    }
+    for (i = 0; i < cl->numVars; i++) {
+        const LogVar *var = cl->vars[i];
+
+        if (!rt_ChunkedLogWriteColumns(cl, var, var->data.re, nRows)) return(false);
+        if (var->data.complex &&
+            !rt_ChunkedLogWriteColumns(cl, var, var->data.im, nRows)) {
+            return(false);
+        }
+    }
+
+    /* complete chunks can be read while the simulation runs */
+    if (fflush(cl->fp) != 0) return(false);
+
+    cl->nRowsWritten += nRows;
+    cl->nPending      = 0;
+    return(true);
+
+} /* end rt_ChunkedLogFlush */
+
+
+/* Function: rt_DestroyChunkedLog ==============================================
+ * Abstract:
+ *      Close the file, without writing the index, and free the writer.
+ */
+static void rt_DestroyChunkedLog(ChunkedLog *cl)
+{
+    int_T i;
+
+    if (cl == NULL) return;
+
+    if (cl->fp != NULL) {
+        (void)fclose(cl->fp);
+    }
+    if (cl->names != NULL) {
+        for (i = 0; i < cl->numVars; i++) {
+            FREE(cl->names[i]);
+        }
+        free(cl->names);
     }
-    return(*errStatus);
+    FREE(cl->vars);
+    FREE(cl->blockNames);
+    FREE(cl->time);
+    FREE(cl->buf);
+    FREE(cl->index);
+    free(cl);
 
-} /* end rt_StartDataLoggingForOutput */
+} /* end rt_DestroyChunkedLog */
 
 
-/* Function: rt_ReallocLogVar ==================================================
+/* Function: rt_StartChunkedLogging ============================================
  * Abstract:
- *   Allocate more memory for the data buffers in the log variable.
- *   Exit if unable to allocate more memory.
+ *      Create the chunked log file set with rt_SetChunkedLogFile, if any,
+ *      for the time, state and output log variables just created.
+ *
+ * Returns:
+ *	== NULL  => success
+ *	!= NULL  => error message
  */
-static void rt_ReallocLogVar(LogVar *var, boolean_T isVarDims)
+static const char_T *rt_StartChunkedLogging(RTWLogInfo *li, LogInfo *logInfo)
 {
-    void *tmp;
-    int_T nCols = var->data.nCols;
-    int_T nRows = var->data.nRows + DEFAULT_BUFFER_SIZE;
-    size_t elSize = var->data.elSize;
-    
-    tmp = realloc(var->data.re, nRows*nCols*elSize);
-    if (tmp == NULL) {
-        (void)fprintf(stderr,
-                      "*** Memory allocation error.\n");
-        (void)fprintf(stderr, ""
-                      "    varName          = %s%s\n"
-                      "    nRows            = %d\n"
-                      "    nCols            = %d\n"
-                      "    elementSize      = %lu\n"
-                      "    Current Size     = %.16g\n"
-                      "    Failed resize    = %.16g\n\n",
-                      var->data.name,
-                      var->data.complex ? " (real part)" : "",
-                      var->data.nRows,
-                      var->data.nCols,
-                      (long)  var->data.elSize,
-                      (double)nRows*nCols*elSize,
-                      (double)(nRows+DEFAULT_BUFFER_SIZE)*nCols*elSize);
-        exit(1);
+    ChunkedLog             *cl;
+    const RTWLogSignalInfo *xInfo = rtliGetLogXSignalInfo(li);
+    const RTWLogSignalInfo *yInfo = rtliGetLogYSignalInfo(li);
+    const char_T           *errStatus = NULL;
+    LogVar                 *var;
+    StructLogVar           *svar;
+    size_t                 maxBytes = 0;
+    int_T                  maxVars = 0;
+    int_T                  i;
+
+    if (rtChunkedLogFile == NULL || rtChunkedLogRows <= 0) return(NULL);
+
+    if ((cl = calloc(1, sizeof(ChunkedLog))) == NULL) return(rtMemAllocError);
+    cl->chunkRows  = rtChunkedLogRows;
+    cl->decimation = rtliGetLogDecimation(li);
+    cl->numHits    = -1;  /* so first point gets logged */
+
+    /* at most one entry per log variable */
+    for (var = logInfo->logVarsList; var != NULL; var = var->next) {
+        maxVars++;
+    }
+    for (svar = logInfo->structLogVarsList; svar != NULL; svar = svar->next) {
+        maxVars += svar->signals.numSignals;
+    }
+    if (maxVars == 0) goto EXIT_POINT;
+    if ((cl->vars = calloc(maxVars, sizeof(LogVar*))) == NULL ||
+        (cl->names = calloc(maxVars, sizeof(char_T*))) == NULL ||
+        (cl->blockNames = calloc(maxVars, sizeof(char_T*))) == NULL) {
+        errStatus = rtMemAllocError;
+        goto EXIT_POINT;
     }
-    var->data.re = tmp;
 
-    if (var->data.complex) {
-        tmp = realloc(var->data.im, nRows*nCols*elSize);
-        if (tmp == NULL) {
-            (void)fprintf(stderr,
-                          "*** Memory allocation error.\n");
-            (void)fprintf(stderr, ""
-                          "    varName          = %s (complex part)\n"
-                          "    nRows            = %d\n"
-                          "    nCols            = %d\n"
-                          "    elementSize      = %lu\n"
-                          "    Current Size     = %.16g\n"
-                          "    Failed resize    = %.16g\n\n",
-                          var->data.name,
-                          var->data.nRows,
-                          var->data.nCols,
-                          (long)  var->data.elSize,
-                          (double)nRows*nCols*elSize,
-                          (double)(nRows+DEFAULT_BUFFER_SIZE)*nCols*elSize);
-            exit(1);
+    /* in the order rt_UpdateTXXFYLogVarsImpl updates them */
+    if (rtliGetLogFormat(li) == 0) {
+        if (logInfo->x != NULL) {
+            LogVar *x = logInfo->x;
+            errStatus = rt_ChunkedLogAddVar(cl, x, x->data.name, -1, NULL);
+            if (errStatus != NULL) goto EXIT_POINT;
+        }
+        for (i = 0; logInfo->y != NULL && i < logInfo->ny; i++) {
+            LogVar *y = ((LogVar**) (logInfo->y))[i];
+            if (y == NULL) continue;
+            errStatus = rt_ChunkedLogAddVar(cl, y, y->data.name, -1, NULL);
+            if (errStatus != NULL) goto EXIT_POINT;
+        }
+    } else {
+        if (logInfo->x != NULL) {
+            errStatus = rt_ChunkedLogAddStructVar(cl, logInfo->x, xInfo);
+            if (errStatus != NULL) goto EXIT_POINT;
+        }
+        for (i = 0; logInfo->y != NULL && i < logInfo->ny; i++) {
+            StructLogVar *y = ((StructLogVar**) (logInfo->y))[i];
+            if (y == NULL) break;
+            errStatus = rt_ChunkedLogAddStructVar(cl, y, &yInfo[i]);
+            if (errStatus != NULL) goto EXIT_POINT;
         }
-        var->data.im = tmp;
     }
-    var->data.nRows = nRows;
+    if (cl->numVars == 0) goto EXIT_POINT;
 
-    /* Also reallocate memory for "valueDimensions" 
-       when logging the variable-size signal
-    */
-    if(isVarDims){
-        int_T k;
-        
-        nCols = var->valDims->nCols;
-        nRows = var->valDims->nRows + DEFAULT_BUFFER_SIZE;
-        elSize = sizeof(real_T);
-        tmp = realloc(var->valDims->dimsData, nRows*nCols*elSize);
-        if (tmp == NULL) {
-            (void)fprintf(stderr,
-                          "*** Memory allocation error.\n");
-            (void)fprintf(stderr, ""
-                          "    varName          = %s\n"
-                          "    nRows            = %d\n"
-                          "    nCols            = %d\n"
-                          "    elementSize      = %lu\n"
-                          "    Current Size     = %.16g\n"
-                          "    Failed resize    = %.16g\n\n",
-                          var->valDims->name,
-                          var->valDims->nRows,
-                          var->valDims->nCols,
-                          (long)  elSize,
-                          (double)nRows*nCols*elSize,
-                          (double)(nRows+DEFAULT_BUFFER_SIZE)*nCols*elSize);
-            exit(1);
-        }
+    for (i = 0; i < cl->numVars; i++) {
+        size_t nBytes = (size_t)cl->chunkRows * cl->vars[i]->data.nCols *
+                        cl->vars[i]->data.elSize;
+        if (nBytes > maxBytes) maxBytes = nBytes;
+    }
+    if ((cl->time = malloc(cl->chunkRows * sizeof(real_T))) == NULL ||
+        (cl->buf = malloc(maxBytes)) == NULL) {
+        errStatus = rtMemAllocError;
+        goto EXIT_POINT;
+    }
 
-        /*
-         * valueDimensions data is stored in array format and must be
-         * adjusted after reallocation (see also rt_FixupLogVar())
-         *
-         * Example: maxRows = 4; nRows = 4; nDims = 3;
-         * Before realloc of the logVar, the locations of data are as below:
-         * (x, y, z -- useful data / o -- junk, don't care)
-         * a[0] = x    a[4] = y    a[8] = z
-         * a[1] = x    a[5] = y    a[9] = z
-         * a[2] = x    a[6] = y    a[10]= z
-         * a[3] = x    a[7] = y    a[11]= z
-         *
-         * After realloc of the logVar (suppose 2 extra rows are added),
-         * the locations of data are as below:
-         * a[0] = x    a[6] = y    a[12]= o
-         * a[1] = x    a[7] = y    a[13]= o
-         * a[2] = x    a[8] = z    a[14]= o
-         * a[3] = x    a[9] = z    a[15]= o
-         * a[4] = y    a[10]= z    a[16]= o
-         * a[5] = y    a[11]= z    a[17]= o
-         *
-         * The data must be adjusted as below:
-         * a[0] = x    a[6] = y    a[12]= z
-         * a[1] = x    a[7] = y    a[13]= z
-         * a[2] = x    a[8] = y    a[14]= z
-         * a[3] = x    a[9] = y    a[15]= z
-         * a[4] = o    a[10]= o    a[16]= o
-         * a[5] = o    a[11]= o    a[17]= o
-         */
-        for(k = var->data.nDims-1; k > 0; k--){
-            (void) memcpy((real_T*)tmp + k*nRows, 
-                          (real_T*)tmp + k*var->valDims->nRows,
-                          elSize * var->valDims->nRows);
-        }
+    if ((cl->fp = fopen(rtChunkedLogFile, "wb")) == NULL) {
+        (void)fprintf(stderr, "*** Error opening %s\n", rtChunkedLogFile);
+        errStatus = rtChunkedLogOpenError;
+        goto EXIT_POINT;
+    }
+    if (!rt_ChunkedLogWriteHeader(cl)) {
+        (void)fprintf(stderr, "*** Error writing to %s\n", rtChunkedLogFile);
+        errStatus = rtChunkedLogWriteError;
+        goto EXIT_POINT;
+    }
 
-        var->valDims->dimsData = tmp;
-        var->valDims->nRows = nRows;
+    /* the chunks are copied out of the buffers, which must therefore wrap
+     * instead of growing; a failed start leaves them unchanged */
+    for (i = 0; i < cl->numVars; i++) {
+        cl->vars[i]->okayToRealloc = 0;
     }
+    logInfo->chunked = cl;
+    return(NULL);
 
-} /* end rt_ReallocLogVar */
+ EXIT_POINT:
+    rt_DestroyChunkedLog(cl);
+    return(errStatus);
 
+} /* end rt_StartChunkedLogging */
 
-/* Function: rt_UpdateLogVarWithDiscontiguousData ==============================
+
+/* Function: rt_UpdateChunkedLog ===============================================
  * Abstract:
- *      Log one row of the LogVar with data that is not contiguous.
+ *      Called after the log variables are updated at time t. Writes a chunk
+ *      once chunkRows rows have been logged. On a write error, the chunked
+ *      log is closed.
+ *
+ * Returns:
+ *	== NULL  => success
+ *	!= NULL  => error message
  */
-static void rt_UpdateLogVarWithDiscontiguousData(LogVar            *var,
-                                                 LogSignalPtrsType data,
-                                                 const int_T       *segmentLengths,
-                                                 int_T             nSegments)
+static const char_T *rt_UpdateChunkedLog(LogInfo *logInfo, real_T t)
 {
-    size_t elSize = 0;
-    size_t offset = 0;
-    int    segIdx = 0;
+    ChunkedLog *cl = (ChunkedLog *)logInfo->chunked;
 
-    if (++var->numHits % var->decimation) return;
-    var->numHits = 0;
+    if (++cl->numHits % cl->decimation) return(NULL);
+    cl->numHits = 0;
 
-    /*
-     * Reallocate or wrap the LogVar
-     */
-    if (var->rowIdx == var->data.nRows) {
-        if (var->okayToRealloc == 1) {
-            rt_ReallocLogVar(var, false);
-        } else {
-            /* Circular buffer */
-            var->rowIdx = 0;
-            ++(var->wrapped); /* increment the wrap around counter */
-        }
+    cl->time[cl->nPending++] = t;
+    if (cl->nPending == cl->chunkRows && !rt_ChunkedLogFlush(cl)) {
+        (void)fprintf(stderr, "*** Error writing to %s\n", rtChunkedLogFile);
+        rt_DestroyChunkedLog(cl);
+        logInfo->chunked = NULL;
+        return(rtChunkedLogWriteError);
     }
+    return(NULL);
 
-    /* This function is only used to log states, there's no var-dims issue. */
-    elSize = var->data.elSize;
-    offset = (size_t)(elSize * var->rowIdx * var->data.nCols);
+} /* end rt_UpdateChunkedLog */
 
-    if (var->data.complex) {
-        char_T *dstRe = (char_T*)(var->data.re) + offset;
-        char_T *dstIm = (char_T*)(var->data.im) + offset;
 
-        for (segIdx = 0; segIdx < nSegments; segIdx++) {
-            int_T         nEl  = segmentLengths[segIdx];
-            const  char_T *src = (const void *)data[segIdx];
-            int_T         el;
+/* Function: rt_StopChunkedLogging =============================================
+ * Abstract:
+ *      Write the last rows and the chunk index, and close the chunked log.
+ */
+static void rt_StopChunkedLogging(LogInfo *logInfo)
+{
+    ChunkedLog *cl = (ChunkedLog *)logInfo->chunked;
+    uint64_T   indexOffset;
+    int_T      i;
 
-            for (el = 0; el < nEl; el++) {
-                (void)memcpy(dstRe, src, elSize);
-                dstRe += elSize;   src += elSize;
-                (void)memcpy(dstIm, src, elSize);
-                dstIm += elSize;   src += elSize;
-            }
-        }
-    } else {
-        char_T *dst = (char_T*)(var->data.re) + offset;
+    if (cl == NULL) return;
 
-        for (segIdx = 0; segIdx < nSegments; segIdx++) {
-            size_t      segSize = elSize*segmentLengths[segIdx];
-            const  void *src    = data[segIdx];
+    if (!rt_ChunkedLogFlush(cl)) goto WRITE_ERROR;
 
-            (void)memcpy(dst, src, segSize);
-            dst += segSize;
+    indexOffset = cl->fileSize;
+    if (!rt_ChunkedLogWrite(cl, RT_CHUNKED_LOG_INDEX_MAGIC, 4) ||
+        !rt_ChunkedLogWriteU32(cl, (uint32_T)cl->numChunks)) {
+        goto WRITE_ERROR;
+    }
+    for (i = 0; i < cl->numChunks; i++) {
+        const ChunkedLogIndexEntry *entry = &cl->index[i];
+
+        if (!rt_ChunkedLogWrite(cl, &entry->offset, sizeof(entry->offset)) ||
+            !rt_ChunkedLogWrite(cl, &entry->firstRow, sizeof(entry->firstRow)) ||
+            !rt_ChunkedLogWriteU32(cl, entry->nRows) ||
+            !rt_ChunkedLogWriteU32(cl, 0U) ||
+            !rt_ChunkedLogWrite(cl, &entry->tFirst, sizeof(entry->tFirst)) ||
+            !rt_ChunkedLogWrite(cl, &entry->tLast, sizeof(entry->tLast))) {
+            goto WRITE_ERROR;
         }
     }
+    if (!rt_ChunkedLogWrite(cl, &indexOffset, sizeof(indexOffset)) ||
+        !rt_ChunkedLogWrite(cl, RT_CHUNKED_LOG_END_MAGIC, 8)) {
+        goto WRITE_ERROR;
+    }
+    goto EXIT_POINT;
 
-    ++var->rowIdx;
-    return;
+ WRITE_ERROR:
+    (void)fprintf(stderr, "*** Error writing to %s\n", rtChunkedLogFile);
 
-} /* end rt_UpdateLogVarWithDiscontiguousData */
+ EXIT_POINT:
+    rt_DestroyChunkedLog(cl);
+    logInfo->chunked = NULL;
+
+} /* end rt_StopChunkedLogging */
+
+#endif /* RT_LOGGING_CHUNKED */
 
 
 /*==================*
@@ -2910,6 +4629,11 @@ LogVar *rt_CreateLogVarWithConvert(
     var->okayToRealloc        = okayToRealloc;
     var->decimation           = decimation;
     var->numHits              = -1;  /* so first point gets logged */
+#ifdef RT_LOGGING_COLUMN_MAJOR
+    /* Store the data in the order rt_FixupLogVar would transpose it to */
+    var->colMajor = (boolean_T)(var->data.nDims < 2 && var->data.nCols > 1);
+#endif
+    var->convertKernel        = rt_SelectConvertKernel(var);
 
     /* Add this log var to list in log info, if necessary */
     if (appendToLogVarsList) {
@@ -3050,7 +4774,8 @@ StructLogVar *rt_CreateStructLogVar(RTWLogInfo              *li,
                                      decimation,
                                      sampleTime,
                                      sigInfo,
-                                     blockName));
+                                     blockName,
+                                     false));
 
 } /* end rt_CreateStructLogVar */
 
@@ -3067,6 +4792,25 @@ extern "C" {
 #endif
 
  
+#ifdef RT_LOGGING_CHUNKED
+
+/* Function: rt_SetChunkedLogFile ==============================================
+ * Abstract:
+ *      Also write the time, states and outputs to the chunked log file
+ *      'file', chunkRows logged time steps per chunk, in the next call of
+ *      rt_StartDataLogging. The file name is not copied. A NULL file turns
+ *      chunked logging off.
+ */
+void rt_SetChunkedLogFile(const char_T *file, int_T chunkRows)
+{
+    rtChunkedLogFile = file;
+    rtChunkedLogRows = chunkRows;
+
+} /* end rt_SetChunkedLogFile */
+
+#endif /* RT_LOGGING_CHUNKED */
+
+
 /* Function: rt_StartDataLoggingWithStartTime ==================================
  * Abstract:
  *      Initialize data logging info based upon the following settings cached
@@ -3174,7 +4918,8 @@ const char_T *rt_StartDataLoggingWithStartTime(RTWLogInfo   *li,
                                                       stepSize, errStatus,
                                                       rtliGetLogX(li), logTime,
                                                       maxRows, decimation,
-                                                      sampleTime, xInfo, NULL);
+                                                      sampleTime, xInfo, NULL,
+                                                      true);
                 if (logInfo->x == NULL) goto ERROR_EXIT;
             }
             if (rtliGetLogXFinal(li)[0] != '\0') {
@@ -3182,7 +4927,8 @@ const char_T *rt_StartDataLoggingWithStartTime(RTWLogInfo   *li,
                                                            stepSize, errStatus,
                                                            rtliGetLogXFinal(li),
                                                            logTime,1,decimation,
-                                                           sampleTime,xInfo,NULL);
+                                                           sampleTime,xInfo,NULL,
+                                                           false);
                 if (logInfo->xFinal == NULL) goto ERROR_EXIT;
             }
         }
@@ -3193,6 +4939,17 @@ const char_T *rt_StartDataLoggingWithStartTime(RTWLogInfo   *li,
                                               stepSize,errStatus);
     if (*errStatus != NULL)  goto ERROR_EXIT;
 
+#ifdef RT_LOGGING_CHUNKED
+    /* before the logging thread, which writes the chunks, is started */
+    *errStatus = rt_StartChunkedLogging(li, logInfo);
+    if (*errStatus != NULL)  goto ERROR_EXIT;
+#endif
+
+#ifdef RT_LOGGING_ASYNC
+    *errStatus = rt_StartAsyncLogging(li, logInfo);
+    if (*errStatus != NULL)  goto ERROR_EXIT;
+#endif
+
     return(NULL); /* NORMAL_EXIT */
 
  ERROR_EXIT:
@@ -3205,6 +4962,12 @@ const char_T *rt_StartDataLoggingWithStartTime(RTWLogInfo   *li,
         logInfo->logVarsList = NULL;
         rt_DestroyStructLogVar(logInfo->structLogVarsList);
         logInfo->structLogVarsList = NULL;
+        rt_DestroyLogVar(logInfo->sharedTime);
+        logInfo->sharedTime = NULL;
+#ifdef RT_LOGGING_CHUNKED
+        rt_DestroyChunkedLog((ChunkedLog *)logInfo->chunked);
+        logInfo->chunked = NULL;
+#endif
     }
     return(*errStatus);
 
@@ -3265,11 +5028,13 @@ void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
     BuiltInDTypeId dTypeID  = var->data.dTypeID;
 
     size_t offset        = 0;
+    size_t colStep       = elSize; /* from one column of the row to the next */
     char_T *currRealRow  = NULL;
     char_T *currImagRow  = NULL;
     int_T  pointSize     = (int_T)((var->data.complex) ? rt_GetSizeofComplexType(dTypeID) : elSize);
 
     int    i, j, k;
+    int    jStart;
 
     /* The following variables will be used for 
        logging variable-size signals */
@@ -3328,13 +5093,25 @@ void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
             }
         }
 
-        offset       = (size_t)(elSize * var->rowIdx * logWidth);
+        if (var->colMajor) {
+            offset   = (size_t)(elSize * var->rowIdx);
+            colStep  = (size_t)(elSize * var->data.nRows);
+        } else {
+            offset   = (size_t)(elSize * var->rowIdx * logWidth);
+            colStep  = elSize;
+        }
         currRealRow  = ((char_T*) (var->data.re)) + offset;
         currImagRow  = (var->data.complex) ?
                        ((char_T*) (var->data.im)) + offset :  NULL;
 
-        /* update logging data */
-        for (j = 0; j < logWidth; j++) {
+        /* update logging data, the whole row at once if a bulk conversion
+         * kernel applies (frameSize is then 1, so the row is contiguous) */
+        jStart = 0;
+        if (var->convertKernel != NULL && !isVarDims) {
+            var->convertKernel(var, (real_T *)currRealRow, cData, logWidth);
+            jStart = logWidth;
+        }
+        for (j = jStart; j < logWidth; j++) {
 
             boolean_T inRange = true;
             int idx = j;
@@ -3385,10 +5162,10 @@ void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
                     const char *cDataPoint = cData + (i+frameSize*idx) * pointSize;
 
                     (void) memcpy(currRealRow, cDataPoint, elSize);
-                    currRealRow += elSize;
+                    currRealRow += colStep;
                     if (var->data.complex) {
                         (void) memcpy(currImagRow, cDataPoint + pointSize/2, elSize);
-                        currImagRow += elSize;
+                        currImagRow += colStep;
                     }
                 } else {
                     /* If out of range, fill in NaN or 0:
@@ -3405,11 +5182,11 @@ void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
                         (void) memset(currRealRow, 0, elSize);
                     }
                     
-                    currRealRow += elSize;
+                    currRealRow += colStep;
                     if (var->data.complex) {
                         /* For imaginary part, fill in 0 */
                         (void) memset(currImagRow, 0, elSize);
-                        currImagRow += elSize;
+                        currImagRow += colStep;
                     }
                 }
             }
@@ -3687,9 +5464,9 @@ void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
                     break;
                 } /* -- end of switch -- */
 
-                currRealRow += elSize;
+                currRealRow += colStep;
                 if (var->data.complex) {
-                    currImagRow += elSize;
+                    currImagRow += colStep;
                 }
             }
         }
@@ -3791,11 +5568,14 @@ const char_T *rt_UpdateTXYLogVars(RTWLogInfo *li, time_T *tPtr)
     return rt_UpdateTXXFYLogVars(li, tPtr, true);
 }
  
-/* Function: rt_UpdateTXXFYLogVars =============================================
+/* Function: rt_UpdateTXXFYLogVarsImpl =========================================
  * Abstract:
- *	Update xFinal and/or the T,X,Y variables that are being logged
+ *	Update xFinal and/or the T,X,Y variables that are being logged from the
+ *	signals behind the logging signal pointers of li.
  */
-const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T updateTXY)
+static const char_T *rt_UpdateTXXFYLogVarsImpl(RTWLogInfo *li,
+                                               time_T     *tPtr,
+                                               boolean_T  updateTXY)
 {
     LogInfo *logInfo     = rtliGetLogInfo(li);
     int_T   matrixFormat = (rtliGetLogFormat(li) == 0);
@@ -3840,6 +5620,11 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
             }
         }
     } else {                                              /* STRUCTURE_FORMAT */
+        /* time shared by the states and outputs */
+        if (logInfo->sharedTime != NULL && updateTXY) {
+            rt_UpdateLogVar(logInfo->sharedTime, tPtr, false);
+        }
+
         /* states */
         if (logInfo->x != NULL && updateTXY) {
             int_T             i;
@@ -3849,7 +5634,7 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
             LogSignalPtrsType data = rtliGetLogXSignalPtrs(li);
 
             /* time */
-            if (var->logTime) {
+            if (var->logTime && !var->sharedTime) {
                 rt_UpdateLogVar(var->time, tPtr, false);
             }
 
@@ -3874,7 +5659,7 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
                 boolean_T   *isVarDims = var[0]->signals.isVarDims;
 
                 /* time */
-                if (var[0]->logTime) {
+                if (var[0]->logTime && !var[0]->sharedTime) {
                     rt_UpdateLogVar(var[0]->time, tPtr, false);
                 }
 
@@ -3896,7 +5681,7 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
                     boolean_T   *isVarDims = var[i]->signals.isVarDims;
 
                     /* time */
-                    if (var[i]->logTime) {
+                    if (var[i]->logTime && !var[i]->sharedTime) {
                         rt_UpdateLogVar(var[i]->time, tPtr, false);
                     }
 
@@ -3931,7 +5716,32 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
             }
         }
     }
+
+#ifdef RT_LOGGING_CHUNKED
+    if (logInfo->chunked != NULL && updateTXY) {
+        return(rt_UpdateChunkedLog(logInfo, *tPtr));
+    }
+#endif
     return(NULL);
+} /* end rt_UpdateTXXFYLogVarsImpl */
+
+
+/* Function: rt_UpdateTXXFYLogVars =============================================
+ * Abstract:
+ *	Update xFinal and/or the T,X,Y variables that are being logged. With
+ *	asynchronous logging, only queue a snapshot of the logged signals.
+ */
+const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T updateTXY)
+{
+#ifdef RT_LOGGING_ASYNC
+    LogInfo *logInfo = rtliGetLogInfo(li);
+
+    if (logInfo->async != NULL) {
+        return(rt_AsyncLogPut(logInfo->async, tPtr, updateTXY, false));
+    }
+#endif
+    return(rt_UpdateTXXFYLogVarsImpl(li, tPtr, updateTXY));
+
 } /* end rt_UpdateTXXFYLogVars */
 
 
@@ -3964,6 +5774,20 @@ void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T isRacc
     boolean_T     emptyFile    = 1; /* assume */
     boolean_T     errFlag      = 0;
     const char_T  *msg;
+#ifdef RT_LOGGING_COMPRESS
+    MatCompressor compressor;
+#endif
+
+#ifdef RT_LOGGING_ASYNC
+    /* The logging thread must be done with the log variables. As with
+     * synchronous logging, the data logged up to an error is still written. */
+    if ( (msg = rt_StopAsyncLogging(logInfo)) != NULL ) {
+        (void)fprintf(stderr,"*** Error logging data for %s: %s\n",file,msg);
+    }
+#endif
+#ifdef RT_LOGGING_CHUNKED
+    rt_StopChunkedLogging(logInfo);
+#endif
 
     /*******************************
      * Create MAT file with header *
@@ -3976,6 +5800,14 @@ void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T isRacc
         (void)fprintf(stderr,"*** Error writing to %s",file);
         goto EXIT_POINT;
     }
+#ifdef RT_LOGGING_COMPRESS
+    if (rt_InitMatCompressor(&compressor)) {
+        (void)fprintf(stderr,"*** Error initializing compression for %s",file);
+        (void)fclose(fptr);
+        (void)remove(file);
+        goto EXIT_POINT;
+    }
+#endif
 
     /**************************************************
      * First log all the variables in the LogVar list *
@@ -3992,7 +5824,11 @@ void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T isRacc
             item.type   = matMATRIX;
             item.nbytes = 0; /* not yet known */
             item.data   = &(var->data);
+#ifdef RT_LOGGING_COMPRESS
+            if (rt_AddCompressedItem(fptr, &compressor, &item, MATRIX_ITEM)) {
+#else
             if (rt_WriteItemToMatFile(fptr, &item, MATRIX_ITEM)) {
+#endif
                 (void)fprintf(stderr,"*** Error writing log variable %s to "
                               "file %s",var->data.name, file);
                 errFlag = 1;
@@ -4002,6 +5838,14 @@ void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T isRacc
         }
         var = var->next;
     }
+#ifdef RT_LOGGING_COMPRESS
+    /* the log vars must be compressed before they are destroyed */
+    if (rt_WriteCompressedItems(fptr, &compressor) && !errFlag) {
+        (void)fprintf(stderr,"*** Error writing compressed variables to "
+                      "file %s",file);
+        errFlag = 1;
+    }
+#endif
     /* free up some memory by destroying the log var list here */
     rt_DestroyLogVar(logInfo->logVarsList);
     logInfo->logVarsList = NULL;
@@ -4009,10 +5853,18 @@ void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T isRacc
     /*******************************************************
      * Next log all the variables in the StructLogVar list *
      *******************************************************/
+    if (logInfo->sharedTime != NULL) {
+        /* fix up the shared time once, not once per structure */
+        if ( (msg = rt_FixupLogVar(logInfo->sharedTime,verbose)) != NULL ) {
+            (void)fprintf(stderr, "*** Error writing %s due to: %s\n",
+                          file, msg);
+            errFlag = 1;
+        }
+    }
     while (svar != NULL) {
         MatItem item;
 
-        if (svar->logTime) {
+        if (svar->logTime && !svar->sharedTime) {
             var = svar->time;
             if ( (msg = rt_FixupLogVar(var,verbose)) != NULL ) {
                 (void)fprintf(stderr, "*** Error writing %s due to: %s\n",
@@ -4037,7 +5889,12 @@ void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T isRacc
         item.nbytes = 0; /* not yet known */
         item.data   = svar;
 
+#ifdef RT_LOGGING_COMPRESS
+        if (rt_AddCompressedItem(fptr, &compressor, &item,
+                                 STRUCT_LOG_VAR_ITEM)) {
+#else
         if (rt_WriteItemToMatFile(fptr, &item, STRUCT_LOG_VAR_ITEM)) {
+#endif
             (void)fprintf(stderr,"*** Error writing structure log variable "
                           "%s to file %s",svar->name, file);
             errFlag = 1;
@@ -4048,6 +5905,18 @@ void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T isRacc
         svar = svar->next;
     }
 
+#ifdef RT_LOGGING_COMPRESS
+    /*******************************************
+     * Compress and write the queued variables *
+     *******************************************/
+    if (!errFlag && rt_WriteCompressedItems(fptr, &compressor)) {
+        (void)fprintf(stderr,"*** Error writing compressed variables to "
+                      "file %s",file);
+        errFlag = 1;
+    }
+    rt_DestroyMatCompressor(&compressor);
+#endif
+
     /******************
      * Close the file *
      ******************/
@@ -4069,6 +5938,8 @@ void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T isRacc
     logInfo->logVarsList = NULL;
     rt_DestroyStructLogVar(logInfo->structLogVarsList);
     logInfo->structLogVarsList = NULL;
+    rt_DestroyLogVar(logInfo->sharedTime);
+    logInfo->sharedTime = NULL;
     FREE(logInfo);
     rtliSetLogInfo(li,NULL);
 
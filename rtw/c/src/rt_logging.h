@@ -35,6 +35,13 @@ typedef double MatReal;                /* "real" data type used in model.mat  */
 typedef struct LogVar_Tag LogVar;
 typedef struct StructLogVar_Tag StructLogVar;
 
+/* Converts one row of n logged elements from the original data type, see
+ * rt_SelectConvertKernel in rt_logging.c */
+typedef void (*LogConvertKernel)(const LogVar *var,
+                                 real_T       *dst,
+                                 const void   *src,
+                                 int_T        n);
+
 typedef struct MatrixData_Tag {
   char_T         name[mxMAXNAM];     /* Name of the variable                  */
   int_T          nRows;              /* number of rows                        */
@@ -106,6 +113,14 @@ struct LogVar_Tag {
                                          otherwise, we allocate memory for them.
                                          (the size will be nDims in this case)
                                       */
+    LogConvertKernel convertKernel;   /* converts a whole row of data that
+                                         needs data type conversion, or NULL
+                                         to convert element by element       */
+    real_T    convertScale;           /* fracSlope * 2^fixedExp              */
+    boolean_T colMajor;               /* data stored column by column, with a
+                                         column stride of data.nRows, instead
+                                         of one row per time step; see
+                                         RT_LOGGING_COLUMN_MAJOR              */
 
     LogVar    *next;
 };
@@ -133,6 +148,9 @@ struct StructLogVar_Tag {
     char_T        name[mxMAXNAM];    /* Name of the ML Struct variable         */
     int_T         numActiveFields;   /* number of active fields                */
     boolean_T     logTime;
+    boolean_T     sharedTime;        /* time LogVar shared with the other
+                                        variables logged at each major time
+                                        step, and owned by the LogInfo        */
     void          *time;
     SignalsStruct signals;
     MatrixData    *blockName;
@@ -265,6 +283,10 @@ extern void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T
 
 extern void rt_StopDataLogging(const char_T *file, RTWLogInfo *li);
 
+#ifdef RT_LOGGING_CHUNKED
+extern void rt_SetChunkedLogFile(const char_T *file, int_T chunkRows);
+#endif
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,665 @@
+/*
+ *
+ * Copyright 2017 The MathWorks, Inc.
+ *
+ * File: rt_logging_chunked.c
+ *
+ * Abstract:
+ *      Reader for the chunked columnar log files written by rt_logging.c
+ *      when compiled with RT_LOGGING_CHUNKED. See rt_logging_chunked.h for
+ *      the file layout.
+ *
+ *      A typical use, reading the signal "yout.signals(2)" between t = 3600
+ *      and t = 3660:
+ *
+ *          log  = rt_OpenChunkedLog("model_log.chk", &errStatus);
+ *          sig  = rt_FindChunkedLogSignal(log, "yout.signals(2)");
+ *          n    = rt_CountChunkedLogRows(log, 3600.0, 3660.0);
+ *          time = malloc(n * sizeof(real_T));
+ *          data = malloc(n * nCols * elSize * (complex ? 2 : 1));
+ *          n    = rt_ReadChunkedLogWindow(log, 3600.0, 3660.0, 1, &sig, n,
+ *                                         time, &data, &errStatus);
+ *          rt_CloseChunkedLog(log);
+ *
+ *      Only the chunk index, the time columns of the chunks that overlap
+ *      the window and the requested columns are read from the file.
+ */
+
+/* 64-bit file offsets: fseeko/ftello with a 64-bit off_t on POSIX hosts */
+#if !defined(_WIN32)
+# if !defined(_POSIX_C_SOURCE)
+#  define _POSIX_C_SOURCE 200112L
+# endif
+# if !defined(_FILE_OFFSET_BITS)
+#  define _FILE_OFFSET_BITS 64
+# endif
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "rtwtypes.h"
+#include "rt_logging_chunked.h"
+
+#if defined(_WIN32)
+# define rt_ChunkedLogSeek(f, off) _fseeki64((f), (__int64)(off), SEEK_SET)
+# define rt_ChunkedLogSeekEnd(f)   _fseeki64((f), (__int64)0, SEEK_END)
+# define rt_ChunkedLogTell(f)      _ftelli64(f)
+#else
+# define rt_ChunkedLogSeek(f, off) fseeko((f), (off_t)(off), SEEK_SET)
+# define rt_ChunkedLogSeekEnd(f)   fseeko((f), (off_t)0, SEEK_END)
+# define rt_ChunkedLogTell(f)      ftello(f)
+#endif
+
+#define FREE(m) if (m != NULL) free(m)
+
+static const char_T rtMemAllocError[] = "Memory allocation error";
+static const char_T rtOpenError[]     = "Error opening the chunked log file";
+static const char_T rtReadError[]     = "Error reading the chunked log file";
+static const char_T rtFormatError[]   = "Not a chunked log file, or one "
+                                        "written by an unsupported version";
+static const char_T rtByteOrderError[] = "Chunked log file written on a host "
+                                         "with a different byte order";
+static const char_T rtSignalIdxError[] = "Invalid chunked log signal index";
+
+typedef struct ChunkedLogChunk_Tag {
+    uint64_T offset;                   /* file offset of the chunk header    */
+    uint64_T firstRow;
+    uint32_T nRows;
+    real_T   tFirst;
+    real_T   tLast;
+} ChunkedLogChunk;
+
+struct ChunkedLogFile_Tag {
+    FILE             *fp;
+    uint32_T         chunkRows;
+    int_T            numSignals;
+    ChunkedLogSignal *signals;
+    size_t           rowBytes;         /* bytes per row of all signals       */
+    int_T            numChunks;
+    ChunkedLogChunk  *chunks;
+    real_T           *timeBuf;         /* time column of one chunk           */
+};
+
+
+/* Function: rt_ChunkedLogRead =================================================
+ * Abstract:
+ *      Read exactly nBytes from the current file position.
+ */
+static boolean_T rt_ChunkedLogRead(FILE *fp, void *dst, size_t nBytes)
+{
+    return((boolean_T)(fread(dst, 1, nBytes, fp) == nBytes));
+
+} /* end rt_ChunkedLogRead */
+
+
+/* Function: rt_ChunkedLogReadString ===========================================
+ * Abstract:
+ *      Read a length prefixed string into a newly allocated, null terminated
+ *      buffer.
+ */
+static char_T *rt_ChunkedLogReadString(FILE *fp)
+{
+    uint32_T len;
+    char_T   *str;
+
+    if (!rt_ChunkedLogRead(fp, &len, sizeof(len))) return(NULL);
+    if ((str = (char_T *)malloc((size_t)len + 1)) == NULL) return(NULL);
+    if (!rt_ChunkedLogRead(fp, str, len)) {
+        free(str);
+        return(NULL);
+    }
+    str[len] = '\0';
+    return(str);
+
+} /* end rt_ChunkedLogReadString */
+
+
+/* Function: rt_ChunkedLogAddChunk =============================================
+ * Abstract:
+ *      Append an entry to the in-memory chunk index.
+ */
+static boolean_T rt_ChunkedLogAddChunk(ChunkedLogFile        *log,
+                                       int_T                 *capacity,
+                                       const ChunkedLogChunk *chunk)
+{
+    if (log->numChunks == *capacity) {
+        int_T           newCapacity = (*capacity == 0) ? 64 : 2 * (*capacity);
+        ChunkedLogChunk *chunks     = (ChunkedLogChunk *)realloc(
+            log->chunks, newCapacity * sizeof(ChunkedLogChunk));
+        if (chunks == NULL) return(false);
+        log->chunks = chunks;
+        *capacity   = newCapacity;
+    }
+    log->chunks[log->numChunks++] = *chunk;
+    return(true);
+
+} /* end rt_ChunkedLogAddChunk */
+
+
+/* Function: rt_ChunkedLogChunkSize ===========================================
+ * Abstract:
+ *      Size in the file of a chunk with the given offset and row count.
+ *
+ * Returns:
+ *	The size, or 0 if the row count is not within 1..chunkRows or the
+ *	chunk does not lie within [dataStart, dataEnd).
+ */
+static uint64_T rt_ChunkedLogChunkSize(const ChunkedLogFile  *log,
+                                       const ChunkedLogChunk *chunk,
+                                       uint64_T              dataStart,
+                                       uint64_T              dataEnd)
+{
+    uint64_T chunkSize;
+
+    if (chunk->nRows == 0 || chunk->nRows > log->chunkRows) return(0);
+    chunkSize = RT_CHUNKED_LOG_CHUNK_HDR_SIZE +
+        (uint64_T)chunk->nRows * (sizeof(real_T) + log->rowBytes);
+    if (chunk->offset < dataStart || chunk->offset > dataEnd ||
+        chunkSize > dataEnd - chunk->offset) {
+        return(0);
+    }
+    return(chunkSize);
+
+} /* end rt_ChunkedLogChunkSize */
+
+
+/* Function: rt_ChunkedLogReadIndex ============================================
+ * Abstract:
+ *      Read the chunk index written at the end of the file. An index whose
+ *      entries do not describe chunks of this file is ignored, so that the
+ *      chunks are scanned instead.
+ *
+ * Returns:
+ *	== NULL  => success, or no usable index (log->numChunks is then -1)
+ *	!= NULL  => error message
+ */
+static const char_T *rt_ChunkedLogReadIndex(ChunkedLogFile *log,
+                                            uint64_T       fileSize,
+                                            uint64_T       dataStart)
+{
+    uint8_T  trailer[RT_CHUNKED_LOG_TRAILER_SIZE];
+    uint8_T  entry[RT_CHUNKED_LOG_INDEX_ENTRY_SIZE];
+    char_T   magic[4];
+    uint64_T indexOffset;
+    uint32_T numChunks;
+    uint32_T i;
+    int_T    capacity = 0;
+
+    log->numChunks = -1;
+    if (fileSize < dataStart + RT_CHUNKED_LOG_TRAILER_SIZE) return(NULL);
+    if (rt_ChunkedLogSeek(log->fp, fileSize - RT_CHUNKED_LOG_TRAILER_SIZE) != 0 ||
+        !rt_ChunkedLogRead(log->fp, trailer, sizeof(trailer))) {
+        return(rtReadError);
+    }
+    if (memcmp(trailer + 8, RT_CHUNKED_LOG_END_MAGIC, 8) != 0) return(NULL);
+
+    (void)memcpy(&indexOffset, trailer, sizeof(indexOffset));
+    if (indexOffset < dataStart ||
+        indexOffset + 8 > fileSize - RT_CHUNKED_LOG_TRAILER_SIZE ||
+        rt_ChunkedLogSeek(log->fp, indexOffset) != 0 ||
+        !rt_ChunkedLogRead(log->fp, magic, sizeof(magic)) ||
+        memcmp(magic, RT_CHUNKED_LOG_INDEX_MAGIC, 4) != 0 ||
+        !rt_ChunkedLogRead(log->fp, &numChunks, sizeof(numChunks))) {
+        return(rtFormatError);
+    }
+    if ((uint64_T)numChunks * RT_CHUNKED_LOG_INDEX_ENTRY_SIZE >
+        fileSize - RT_CHUNKED_LOG_TRAILER_SIZE - (indexOffset + 8)) {
+        return(NULL);
+    }
+
+    log->numChunks = 0;
+    for (i = 0; i < numChunks; i++) {
+        ChunkedLogChunk chunk;
+
+        if (!rt_ChunkedLogRead(log->fp, entry, sizeof(entry))) {
+            return(rtReadError);
+        }
+        (void)memcpy(&chunk.offset,   entry,      8);
+        (void)memcpy(&chunk.firstRow, entry + 8,  8);
+        (void)memcpy(&chunk.nRows,    entry + 16, 4);
+        (void)memcpy(&chunk.tFirst,   entry + 24, 8);
+        (void)memcpy(&chunk.tLast,    entry + 32, 8);
+        if (rt_ChunkedLogChunkSize(log, &chunk, dataStart, indexOffset) == 0) {
+            FREE(log->chunks);
+            log->chunks    = NULL;
+            log->numChunks = -1;
+            return(NULL);
+        }
+        if (!rt_ChunkedLogAddChunk(log, &capacity, &chunk)) {
+            return(rtMemAllocError);
+        }
+    }
+    return(NULL);
+
+} /* end rt_ChunkedLogReadIndex */
+
+
+/* Function: rt_ChunkedLogScanChunks ===========================================
+ * Abstract:
+ *      Rebuild the chunk index from the chunk headers, for files without an
+ *      index. Stops at the first incomplete or unrecognized chunk.
+ */
+static const char_T *rt_ChunkedLogScanChunks(ChunkedLogFile *log,
+                                             uint64_T       fileSize,
+                                             uint64_T       dataStart)
+{
+    uint8_T  hdr[RT_CHUNKED_LOG_CHUNK_HDR_SIZE];
+    uint64_T offset   = dataStart;
+    int_T    capacity = 0;
+
+    log->numChunks = 0;
+    while (offset + RT_CHUNKED_LOG_CHUNK_HDR_SIZE <= fileSize) {
+        ChunkedLogChunk chunk;
+        uint64_T        chunkSize;
+
+        if (rt_ChunkedLogSeek(log->fp, offset) != 0 ||
+            !rt_ChunkedLogRead(log->fp, hdr, sizeof(hdr)) ||
+            memcmp(hdr, RT_CHUNKED_LOG_CHUNK_MAGIC, 4) != 0) {
+            break;
+        }
+        chunk.offset = offset;
+        (void)memcpy(&chunk.nRows,    hdr + 4,  4);
+        (void)memcpy(&chunk.firstRow, hdr + 8,  8);
+        (void)memcpy(&chunk.tFirst,   hdr + 16, 8);
+        (void)memcpy(&chunk.tLast,    hdr + 24, 8);
+        chunkSize = rt_ChunkedLogChunkSize(log, &chunk, dataStart, fileSize);
+        if (chunkSize == 0) break;
+
+        if (!rt_ChunkedLogAddChunk(log, &capacity, &chunk)) {
+            return(rtMemAllocError);
+        }
+        offset += chunkSize;
+    }
+    return(NULL);
+
+} /* end rt_ChunkedLogScanChunks */
+
+
+/* Function: rt_OpenChunkedLog =================================================
+ * Abstract:
+ *      Open a chunked log file and read its signal descriptors and chunk
+ *      index.
+ *
+ * Returns:
+ *	!= NULL  => success
+ *	== NULL  => failure, *errStatus is set to the error message
+ */
+ChunkedLogFile *rt_OpenChunkedLog(const char_T *file, const char_T **errStatus)
+{
+    ChunkedLogFile *log = NULL;
+    char_T         magic[8];
+    uint32_T       hdr[4];
+    uint64_T       dataStart;
+    uint64_T       fileSize;
+    int_T          i;
+
+    *errStatus = NULL;
+
+    if ((log = (ChunkedLogFile *)calloc(1, sizeof(ChunkedLogFile))) == NULL) {
+        *errStatus = rtMemAllocError;
+        return(NULL);
+    }
+    if ((log->fp = fopen(file, "rb")) == NULL) {
+        *errStatus = rtOpenError;
+        goto ERROR_EXIT;
+    }
+
+    /* version, byte order, chunk rows and number of signals */
+    if (!rt_ChunkedLogRead(log->fp, magic, sizeof(magic)) ||
+        memcmp(magic, RT_CHUNKED_LOG_MAGIC, 8) != 0 ||
+        !rt_ChunkedLogRead(log->fp, hdr, sizeof(hdr))) {
+        *errStatus = rtFormatError;
+        goto ERROR_EXIT;
+    }
+    if (hdr[1] != RT_CHUNKED_LOG_BYTE_ORDER) {
+        *errStatus = rtByteOrderError;
+        goto ERROR_EXIT;
+    }
+    if (hdr[0] != RT_CHUNKED_LOG_VERSION || hdr[2] == 0) {
+        *errStatus = rtFormatError;
+        goto ERROR_EXIT;
+    }
+    log->chunkRows  = hdr[2];
+    log->numSignals = (int_T)hdr[3];
+
+    /* signal descriptors */
+    if (log->numSignals > 0 &&
+        (log->signals = (ChunkedLogSignal *)calloc(log->numSignals, sizeof(ChunkedLogSignal))) == NULL) {
+        *errStatus = rtMemAllocError;
+        goto ERROR_EXIT;
+    }
+    for (i = 0; i < log->numSignals; i++) {
+        ChunkedLogSignal *sig = &log->signals[i];
+        uint32_T         desc[5];
+        int32_T          dim;
+        int_T            d;
+
+        if ((sig->name = rt_ChunkedLogReadString(log->fp)) == NULL ||
+            (sig->blockName = rt_ChunkedLogReadString(log->fp)) == NULL ||
+            !rt_ChunkedLogRead(log->fp, desc, sizeof(desc))) {
+            *errStatus = rtReadError;
+            goto ERROR_EXIT;
+        }
+        sig->dTypeID = (int_T)desc[0];
+        sig->elSize  = (size_t)desc[1];
+        sig->complex = (boolean_T)(desc[2] != 0);
+        sig->nCols   = (int_T)desc[3];
+        sig->nDims   = (int_T)desc[4];
+        if (sig->nDims > 0 &&
+            (sig->dims = (int_T *)calloc(sig->nDims, sizeof(int_T))) == NULL) {
+            *errStatus = rtMemAllocError;
+            goto ERROR_EXIT;
+        }
+        for (d = 0; d < sig->nDims; d++) {
+            if (!rt_ChunkedLogRead(log->fp, &dim, sizeof(dim))) {
+                *errStatus = rtReadError;
+                goto ERROR_EXIT;
+            }
+            sig->dims[d] = (int_T)dim;
+        }
+        sig->chunkOffset = log->rowBytes;
+        log->rowBytes   += (size_t)sig->nCols * sig->elSize * (sig->complex ? 2 : 1);
+    }
+    {
+        int64_T pos = (int64_T)rt_ChunkedLogTell(log->fp);
+        if (pos < 0) {
+            *errStatus = rtReadError;
+            goto ERROR_EXIT;
+        }
+        dataStart = (uint64_T)pos;
+    }
+
+    if ((log->timeBuf = (real_T *)malloc(log->chunkRows * sizeof(real_T))) == NULL) {
+        *errStatus = rtMemAllocError;
+        goto ERROR_EXIT;
+    }
+
+    /* chunk index, rebuilt from the chunks if the file has none */
+    {
+        int64_T pos;
+        if (rt_ChunkedLogSeekEnd(log->fp) != 0 ||
+            (pos = (int64_T)rt_ChunkedLogTell(log->fp)) < 0) {
+            *errStatus = rtReadError;
+            goto ERROR_EXIT;
+        }
+        fileSize = (uint64_T)pos;
+    }
+    if ((*errStatus = rt_ChunkedLogReadIndex(log, fileSize, dataStart)) != NULL) {
+        goto ERROR_EXIT;
+    }
+    if (log->numChunks < 0 &&
+        (*errStatus = rt_ChunkedLogScanChunks(log, fileSize, dataStart)) != NULL) {
+        goto ERROR_EXIT;
+    }
+    return(log);
+
+ ERROR_EXIT:
+    rt_CloseChunkedLog(log);
+    return(NULL);
+
+} /* end rt_OpenChunkedLog */
+
+
+/* Function: rt_CloseChunkedLog ================================================
+ * Abstract:
+ *      Close the file and free the reader.
+ */
+void rt_CloseChunkedLog(ChunkedLogFile *log)
+{
+    int_T i;
+
+    if (log == NULL) return;
+
+    if (log->fp != NULL) {
+        (void)fclose(log->fp);
+    }
+    if (log->signals != NULL) {
+        for (i = 0; i < log->numSignals; i++) {
+            FREE(log->signals[i].name);
+            FREE(log->signals[i].blockName);
+            FREE(log->signals[i].dims);
+        }
+        free(log->signals);
+    }
+    FREE(log->chunks);
+    FREE(log->timeBuf);
+    free(log);
+
+} /* end rt_CloseChunkedLog */
+
+
+/* Function: rt_GetChunkedLogNumSignals ========================================
+ * Abstract:
+ *      Number of signals in the log.
+ */
+int_T rt_GetChunkedLogNumSignals(const ChunkedLogFile *log)
+{
+    return(log->numSignals);
+
+} /* end rt_GetChunkedLogNumSignals */
+
+
+/* Function: rt_GetChunkedLogSignal ============================================
+ * Abstract:
+ *      Descriptor of signal idx, or NULL if there is no such signal.
+ */
+const ChunkedLogSignal *rt_GetChunkedLogSignal(const ChunkedLogFile *log,
+                                               int_T                idx)
+{
+    if (idx < 0 || idx >= log->numSignals) return(NULL);
+    return(&log->signals[idx]);
+
+} /* end rt_GetChunkedLogSignal */
+
+
+/* Function: rt_FindChunkedLogSignal ===========================================
+ * Abstract:
+ *      Index of the signal with the given name, or -1.
+ */
+int_T rt_FindChunkedLogSignal(const ChunkedLogFile *log, const char_T *name)
+{
+    int_T i;
+
+    for (i = 0; i < log->numSignals; i++) {
+        if (strcmp(log->signals[i].name, name) == 0) return(i);
+    }
+    return(-1);
+
+} /* end rt_FindChunkedLogSignal */
+
+
+/* Function: rt_ChunkedLogFirstChunk ===========================================
+ * Abstract:
+ *      Index of the first chunk that may hold times at or after tStart.
+ *      Chunks are in time order, so this is a binary search on tLast.
+ */
+static int_T rt_ChunkedLogFirstChunk(const ChunkedLogFile *log, real_T tStart)
+{
+    int_T lo = 0;
+    int_T hi = log->numChunks;
+
+    while (lo < hi) {
+        int_T mid = lo + (hi - lo) / 2;
+        if (log->chunks[mid].tLast < tStart) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return(lo);
+
+} /* end rt_ChunkedLogFirstChunk */
+
+
+/* Function: rt_ChunkedLogWindowRows ===========================================
+ * Abstract:
+ *      Read the time column of a chunk and find the rows [*k0, *k1) with
+ *      tStart <= t <= tEnd.
+ */
+static boolean_T rt_ChunkedLogWindowRows(ChunkedLogFile        *log,
+                                         const ChunkedLogChunk *chunk,
+                                         real_T                tStart,
+                                         real_T                tEnd,
+                                         uint32_T              *k0,
+                                         uint32_T              *k1)
+{
+    if (chunk->tFirst >= tStart && chunk->tLast <= tEnd) {
+        *k0 = 0;
+        *k1 = chunk->nRows;
+    } else {
+        if (rt_ChunkedLogSeek(log->fp, chunk->offset +
+                              RT_CHUNKED_LOG_CHUNK_HDR_SIZE) != 0 ||
+            !rt_ChunkedLogRead(log->fp, log->timeBuf,
+                               chunk->nRows * sizeof(real_T))) {
+            return(false);
+        }
+        for (*k0 = 0; *k0 < chunk->nRows && log->timeBuf[*k0] < tStart; (*k0)++);
+        for (*k1 = *k0; *k1 < chunk->nRows && log->timeBuf[*k1] <= tEnd; (*k1)++);
+    }
+    return(true);
+
+} /* end rt_ChunkedLogWindowRows */
+
+
+/* Function: rt_CountChunkedLogRows ============================================
+ * Abstract:
+ *      Number of rows logged at times tStart <= t <= tEnd, for sizing the
+ *      buffers passed to rt_ReadChunkedLogWindow. Only reads the time columns
+ *      of the chunks at either end of the window.
+ */
+size_t rt_CountChunkedLogRows(const ChunkedLogFile *log,
+                              real_T               tStart,
+                              real_T               tEnd)
+{
+    ChunkedLogFile *rwLog = (ChunkedLogFile *)log; /* file position only */
+    size_t         nRows  = 0;
+    int_T          c;
+
+    for (c = rt_ChunkedLogFirstChunk(log, tStart);
+         c < log->numChunks && log->chunks[c].tFirst <= tEnd; c++) {
+        uint32_T k0, k1;
+
+        if (!rt_ChunkedLogWindowRows(rwLog, &log->chunks[c], tStart, tEnd,
+                                     &k0, &k1)) {
+            break;
+        }
+        nRows += k1 - k0;
+    }
+    return(nRows);
+
+} /* end rt_CountChunkedLogRows */
+
+
+/* Function: rt_ReadChunkedLogWindow ===========================================
+ * Abstract:
+ *      Read the rows logged at times tStart <= t <= tEnd of the signals
+ *      signalIdx[0..numSignals-1], at most maxRows of them. The times go to
+ *      time (which may be NULL) and the values of signal i to data[i], one
+ *      column after the other as MATLAB stores an nRows x nCols matrix: the
+ *      real parts of all columns, then, for complex signals, the imaginary
+ *      parts. data[i] must hold maxRows * nCols * elSize bytes, twice that
+ *      for complex signals.
+ *
+ * Returns:
+ *	The number of rows read. *errStatus is NULL on success. Upon a read
+ *	error, the rows read before it are returned, laid out as above.
+ */
+size_t rt_ReadChunkedLogWindow(ChunkedLogFile *log,
+                               real_T         tStart,
+                               real_T         tEnd,
+                               int_T          numSignals,
+                               const int_T    *signalIdx,
+                               size_t         maxRows,
+                               real_T         *time,
+                               void           **data,
+                               const char_T   **errStatus)
+{
+    size_t nOut = 0;
+    int_T  c;
+    int_T  i;
+
+    *errStatus = NULL;
+    for (i = 0; i < numSignals; i++) {
+        if (signalIdx[i] < 0 || signalIdx[i] >= log->numSignals) {
+            *errStatus = rtSignalIdxError;
+            return(0);
+        }
+    }
+
+    /* single pass over the chunks: columns are laid out maxRows apart and
+     * closed up once the number of rows read is known */
+    for (c = rt_ChunkedLogFirstChunk(log, tStart);
+         c < log->numChunks && log->chunks[c].tFirst <= tEnd && nOut < maxRows;
+         c++) {
+        const ChunkedLogChunk *chunk = &log->chunks[c];
+        uint64_T              base   = chunk->offset + RT_CHUNKED_LOG_CHUNK_HDR_SIZE;
+        uint32_T              k0, k1;
+        size_t                nRows;
+
+        if (!rt_ChunkedLogWindowRows(log, chunk, tStart, tEnd, &k0, &k1)) {
+            *errStatus = rtReadError;
+            goto EXIT_POINT;
+        }
+        if (k1 - k0 > maxRows - nOut) {
+            k1 = k0 + (uint32_T)(maxRows - nOut);
+        }
+        nRows = k1 - k0;
+        if (nRows == 0) continue;
+
+        if (time != NULL &&
+            (rt_ChunkedLogSeek(log->fp, base + k0 * sizeof(real_T)) != 0 ||
+             !rt_ChunkedLogRead(log->fp, time + nOut, nRows * sizeof(real_T)))) {
+            *errStatus = rtReadError;
+            goto EXIT_POINT;
+        }
+
+        /* each column of each signal is contiguous within the chunk */
+        for (i = 0; i < numSignals; i++) {
+            const ChunkedLogSignal *sig  = &log->signals[signalIdx[i]];
+            uint64_T               sigBase = base + chunk->nRows *
+                (sizeof(real_T) + (uint64_T)sig->chunkOffset);
+            int_T                  nParts = sig->complex ? 2 : 1;
+            int_T                  part;
+            int_T                  col;
+
+            for (part = 0; part < nParts; part++) {
+                for (col = 0; col < sig->nCols; col++) {
+                    size_t   srcCol = (size_t)part * sig->nCols + col;
+                    uint64_T src    = sigBase +
+                        ((uint64_T)srcCol * chunk->nRows + k0) * sig->elSize;
+                    char_T   *dst   = (char_T *)data[i] +
+                        (srcCol * maxRows + nOut) * sig->elSize;
+
+                    if (rt_ChunkedLogSeek(log->fp, src) != 0 ||
+                        !rt_ChunkedLogRead(log->fp, dst, nRows * sig->elSize)) {
+                        *errStatus = rtReadError;
+                        goto EXIT_POINT;
+                    }
+                }
+            }
+        }
+        nOut += nRows;
+    }
+
+ EXIT_POINT:
+    /* the columns were spaced maxRows apart, close up the gaps */
+    if (nOut < maxRows) {
+        for (i = 0; i < numSignals; i++) {
+            const ChunkedLogSignal *sig = &log->signals[signalIdx[i]];
+            size_t                 nCols = (size_t)sig->nCols * (sig->complex ? 2 : 1);
+            size_t                 col;
+
+            for (col = 1; col < nCols; col++) {
+                (void)memmove((char_T *)data[i] + col * nOut * sig->elSize,
+                              (char_T *)data[i] + col * maxRows * sig->elSize,
+                              nOut * sig->elSize);
+            }
+        }
+    }
+    return(nOut);
+
+} /* end rt_ReadChunkedLogWindow */
+
+
+/* [eof] rt_logging_chunked.c */
@@ -0,0 +1,123 @@
+/*
+ *
+ * Copyright 2017 The MathWorks, Inc.
+ *
+ * File: rt_logging_chunked.h
+ *
+ * Abstract:
+ *      Chunked columnar log files and the routines to read them back.
+ *
+ *      When rt_logging.c is compiled with RT_LOGGING_CHUNKED, the time,
+ *      states and outputs can also be written, as the simulation runs, to a
+ *      chunked log file (see rt_SetChunkedLogFile). Unlike the MAT-file,
+ *      which is only written at the end and must be loaded whole, a window
+ *      of time of a few signals can be read from a chunked log without
+ *      reading the rest of the file, even while the file is being written.
+ *
+ *      File layout, in the byte order of the host that wrote it:
+ *
+ *        Header
+ *          char     magic[8]            "RTLOGCHK"
+ *          uint32_T version             RT_CHUNKED_LOG_VERSION
+ *          uint32_T byteOrder           RT_CHUNKED_LOG_BYTE_ORDER
+ *          uint32_T chunkRows           maximum rows per chunk
+ *          uint32_T numSignals
+ *          numSignals signal descriptors:
+ *            uint32_T nameLen,      char name[nameLen]
+ *            uint32_T blockNameLen, char blockName[blockNameLen]
+ *            uint32_T dTypeID, elSize, complex, nCols, nDims
+ *            int32_T  dims[nDims]
+ *
+ *        Chunks, one per chunkRows logged time steps (the last may be short)
+ *          char     magic[4]            "CHNK"
+ *          uint32_T nRows
+ *          uint64_T firstRow            index of the first row in the run
+ *          real_T   tFirst, tLast
+ *          real_T   time[nRows]
+ *          for each signal, for each column, the nRows values of the
+ *          column (real parts of all columns, then imaginary parts)
+ *
+ *        Chunk index, written when logging stops
+ *          char     magic[4]            "INDX"
+ *          uint32_T numChunks
+ *          numChunks entries:
+ *            uint64_T offset, firstRow
+ *            uint32_T nRows, reserved
+ *            real_T   tFirst, tLast
+ *          uint64_T indexOffset
+ *          char     magic[8]            "RTLOGEND"
+ *
+ *      If the index is missing, because the simulation is still running or
+ *      did not stop cleanly, the reader rebuilds it by walking the chunk
+ *      headers and ignores a partly written last chunk.
+ */
+
+#ifndef rt_logging_chunked_h
+#define rt_logging_chunked_h
+
+#include <stddef.h>                     /* size_t */
+#include "rtwtypes.h"
+
+#define RT_CHUNKED_LOG_MAGIC          "RTLOGCHK"
+#define RT_CHUNKED_LOG_END_MAGIC      "RTLOGEND"
+#define RT_CHUNKED_LOG_CHUNK_MAGIC    "CHNK"
+#define RT_CHUNKED_LOG_INDEX_MAGIC    "INDX"
+#define RT_CHUNKED_LOG_VERSION        1U
+#define RT_CHUNKED_LOG_BYTE_ORDER     0x01020304U
+
+#define RT_CHUNKED_LOG_CHUNK_HDR_SIZE 32 /* magic to tLast                   */
+#define RT_CHUNKED_LOG_INDEX_ENTRY_SIZE 40
+#define RT_CHUNKED_LOG_TRAILER_SIZE   16 /* indexOffset and end magic        */
+
+typedef struct ChunkedLogSignal_Tag {
+    char_T    *name;                   /* log variable name, e.g. "yout" or
+                                          "yout.signals(2)"                   */
+    char_T    *blockName;              /* source block, "" if not known      */
+    int_T     dTypeID;                 /* BuiltInDTypeId of the logged data  */
+    size_t    elSize;                  /* element size in bytes              */
+    boolean_T complex;
+    int_T     nCols;                   /* elements per time step             */
+    int_T     nDims;
+    int_T     *dims;
+    size_t    chunkOffset;             /* bytes per chunk row before this
+                                          signal, past the time column       */
+} ChunkedLogSignal;
+
+typedef struct ChunkedLogFile_Tag ChunkedLogFile;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern ChunkedLogFile *rt_OpenChunkedLog(const char_T *file,
+                                         const char_T **errStatus);
+
+extern void rt_CloseChunkedLog(ChunkedLogFile *log);
+
+extern int_T rt_GetChunkedLogNumSignals(const ChunkedLogFile *log);
+
+extern const ChunkedLogSignal *rt_GetChunkedLogSignal(const ChunkedLogFile *log,
+                                                      int_T                idx);
+
+extern int_T rt_FindChunkedLogSignal(const ChunkedLogFile *log,
+                                     const char_T         *name);
+
+extern size_t rt_CountChunkedLogRows(const ChunkedLogFile *log,
+                                     real_T               tStart,
+                                     real_T               tEnd);
+
+extern size_t rt_ReadChunkedLogWindow(ChunkedLogFile *log,
+                                      real_T         tStart,
+                                      real_T         tEnd,
+                                      int_T          numSignals,
+                                      const int_T    *signalIdx,
+                                      size_t         maxRows,
+                                      real_T         *time,
+                                      void           **data,
+                                      const char_T   **errStatus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* rt_logging_chunked_h */
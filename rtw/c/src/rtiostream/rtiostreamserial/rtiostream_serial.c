@@ -70,6 +70,7 @@
 #define MAX_COM_LEN 64             /* length of com port name */
 #define MAX_COM_PREFIX_LEN 7       /* Full prefix is \\.\COM  */
 #define TMP_BUF_SIZ (40)
+#define RX_BUF_SIZ (4096)          /* size of the per-port receive buffer */
 
 #ifndef MIN
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
@@ -128,6 +129,10 @@ typedef struct SerialCommsData_tag {
                             * workaround Arduino specific Auto-reset
                             * issue on Linux and Mac
                             */
+    char   rxBuf[RX_BUF_SIZ]; /* bytes read from the port but not yet
+                               * returned by rtIOStreamRecv */
+    size_t rxBufStart;        /* index of the first unread byte in rxBuf */
+    size_t rxBufCount;        /* number of unread bytes in rxBuf */
 } SerialCommsData;
 
 /**************** LOCAL DATA *************************************************/
@@ -183,6 +188,12 @@ static int serialDataSet(
     const size_t size,
     size_t *sizeSent);
 
+static int serialDataRead(
+    SerialCommsData *sd,
+    char          *dst,
+    const size_t   size,
+    size_t        *sizeRecvd);
+
 static int serialDataGet(
     SerialCommsData *sd,
     char          *dst,
@@ -424,10 +435,11 @@ static int serialDataPending(
 } /* end serialDataPending */
 
 
-/* Function: serialDataGet =====================================================
+/* Function: serialDataRead ====================================================
  * Abstract:
- *  Attempts to gets the specified number of bytes from the specified serial.
- *  The number of bytes read is returned via the 'sizeRecvd' parameter.
+ *  Attempts to read the specified number of bytes directly from the specified
+ *  serial port, bypassing the receive buffer. The number of bytes read is
+ *  returned via the 'sizeRecvd' parameter.
  *  RTIOSTREAM_NO_ERROR is returned on success, RTIOSTREAM_ERROR is returned on
  *  failure.
  *
@@ -435,15 +447,16 @@ static int serialDataPending(
  *  o it is not an error for 'sizeRecvd' to be returned as 0
  *  o this function waits for at most READ_FILE_TIMEOUT
  */
-static int serialDataGet(
+static int serialDataRead(
     SerialCommsData *sd,
     char          *dst,
     const size_t   size,
     size_t        *sizeRecvd)
 {
-    static const char *fnName = "serialDataGet:";
+    static const char *fnName = "serialDataRead:";
     int retVal = RTIOSTREAM_NO_ERROR;
     int avail = 0;
+    size_t readSize;
 
 #ifdef _WIN32
     DWORD sizeRecvdTemp = 0;
@@ -467,10 +480,13 @@ static int serialDataGet(
         return retVal;
     }
 
+    /* never ask for more than is pending so the read does not wait */
+    readSize = MIN(size, (size_t) avail);
+
 #ifdef _WIN32
-    if (!ReadFile( sd->serialHandle, dst, (DWORD) size, &sizeRecvdTemp, NULL))/*Error Condition check*/
+    if (!ReadFile( sd->serialHandle, dst, (DWORD) readSize, &sizeRecvdTemp, NULL))/*Error Condition check*/
 #else /*UNIX*/
-    sizeRecvdTemp = read(sd->serialHandle,dst,size);
+    sizeRecvdTemp = read(sd->serialHandle,dst,readSize);
     if(sizeRecvdTemp < 0) /*Error Condition check*/
 #endif
 
@@ -482,6 +498,60 @@ static int serialDataGet(
 
     *sizeRecvd = (size_t) sizeRecvdTemp;
 
+    return retVal;
+} /* end serialDataRead */
+
+
+/* Function: serialDataGet =====================================================
+ * Abstract:
+ *  Attempts to gets the specified number of bytes from the specified serial.
+ *  The number of bytes read is returned via the 'sizeRecvd' parameter.
+ *  RTIOSTREAM_NO_ERROR is returned on success, RTIOSTREAM_ERROR is returned on
+ *  failure.
+ *
+ *  Small requests are served from the per-port receive buffer, which is
+ *  refilled with everything pending on the port (up to RX_BUF_SIZ bytes) in
+ *  a single read. This avoids one system call per byte when callers consume
+ *  the stream a few bytes at a time. Requests at least as large as the
+ *  buffer are read straight into 'dst' once the buffer is drained.
+ *
+ * NOTES:
+ *  o it is not an error for 'sizeRecvd' to be returned as 0
+ *  o this function waits for at most READ_FILE_TIMEOUT
+ */
+static int serialDataGet(
+    SerialCommsData *sd,
+    char          *dst,
+    const size_t   size,
+    size_t        *sizeRecvd)
+{
+    int retVal = RTIOSTREAM_NO_ERROR;
+    size_t numCopied;
+
+    *sizeRecvd = 0;
+    if (size == 0) {
+        /* return immediately if caller requested to read 0 bytes */
+        return retVal;
+    }
+
+    if (sd->rxBufCount == 0) {
+        if (size >= RX_BUF_SIZ) {
+            return serialDataRead( sd, dst, size, sizeRecvd);
+        }
+        sd->rxBufStart = 0;
+        retVal = serialDataRead( sd, sd->rxBuf, RX_BUF_SIZ, &(sd->rxBufCount));
+        if (retVal == RTIOSTREAM_ERROR) {
+            sd->rxBufCount = 0;
+            return retVal;
+        }
+    }
+
+    numCopied = MIN(size, sd->rxBufCount);
+    memcpy(dst, &(sd->rxBuf[sd->rxBufStart]), numCopied);
+    sd->rxBufStart += numCopied;
+    sd->rxBufCount -= numCopied;
+    *sizeRecvd = numCopied;
+
     return retVal;
 } /* end serialDataGet */
 
@@ -560,13 +630,17 @@ static int serialDataFlush(
     int error;
     static const char *fnName = "serialDataFlush:";
 
+    /* discard anything already buffered */
+    sd->rxBufStart = 0;
+    sd->rxBufCount = 0;
+
     do {
         error = serialDataPending( sd, &pending);
         if ( (pending > 0) && (error==RTIOSTREAM_NO_ERROR) ) {
            if (sd->verbosity) {
               printf("serialDataFlush: pending = %d\n", pending);
            }
-           error = serialDataGet( sd, tmpBuf, sizeof( tmpBuf), &numRecvd);
+           error = serialDataRead( sd, tmpBuf, sizeof( tmpBuf), &numRecvd);
            if (sd->verbosity) {
               size_t currElement;
               printf("serialDataFlush: sizeRecvd = %lu: ", (unsigned long) numRecvd);
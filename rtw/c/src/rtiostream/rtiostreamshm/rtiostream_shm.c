@@ -0,0 +1,920 @@
+/*
+ * Copyright 2017 The MathWorks, Inc.
+ *
+ * File: rtiostream_shm.c
+ *
+ * Abstract: This source file implements shared memory communication between
+ *  two processes running on the same Linux machine. It is intended for
+ *  host-target communication (e.g. external mode or SIL) where the
+ *  generated executable runs on the host. Compared with rtiostream_tcpip.c
+ *  over the loopback interface, data never passes through the network stack.
+ *
+ *  The server side (normally the target) creates a POSIX shared memory
+ *  object containing two single-producer / single-consumer byte rings, one
+ *  for each direction. The client side (normally the host) maps the same
+ *  object. Readers and writers poll the ring indices for a short time and
+ *  then sleep on a futex, which the peer wakes only when a sleeper is
+ *  registered. Closing either end sets that side's closed flag and wakes all
+ *  sleepers, so the peer's rtIOStreamRecv and rtIOStreamSend return an error
+ *  instead of waiting for data that will never arrive.
+ *
+ *  The server refuses to open an object that belongs to a running server;
+ *  an object left behind by a server that exited without closing is
+ *  replaced.
+ *
+ *  Options:
+ *    -name NAME              shared memory object name (default
+ *                            /rtiostream_shm)
+ *    -client 0|1             open as client (1) or server (0, default)
+ *    -blocking 0|1           block in rtIOStreamRecv until data is
+ *                            available or the timeout expires
+ *    -recv_timeout_secs N    receive timeout used when blocking (-1 waits
+ *                            indefinitely)
+ *    -ringsize N             size in bytes of each ring (server only; rounded
+ *                            up to a power of two)
+ *    -verbose N              verbosity level
+ */
+
+#ifndef __linux__
+#error "rtiostream_shm.c is only supported on Linux"
+#endif
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "rtiostream.h"
+#include "tmwtypes.h"
+
+#ifdef USE_MEXPRINTF
+#include "mex.h"
+#define printf mexPrintf
+#endif
+
+/***************** DEFINES ****************************************************/
+
+#define SHM_NAME_MAXLEN (64U)
+#define DEFAULT_SHM_NAME "/rtiostream_shm"
+
+/* default and limits for the size of each ring in bytes */
+#define DEFAULT_RING_SIZE (256U * 1024U)
+#define MIN_RING_SIZE (4U * 1024U)
+#define MAX_RING_SIZE (64U * 1024U * 1024U)
+
+/* identifies a shared memory object created by this driver */
+#define SHM_MAGIC (0x524d5348U) /* "RMSH" */
+#define SHM_VERSION (2U)
+
+#define SHM_CACHE_LINE_SIZE (64)
+
+/* number of times to poll a ring index before sleeping on the futex */
+#define SPIN_COUNT (2000)
+
+/* timeout of 0 means to return immediately */
+#define BLOCKING_RECV_TIMEOUT_NOWAIT (0)
+/* timeout of -1 means to wait indefinitely */
+#define BLOCKING_RECV_TIMEOUT_NEVER (-1)
+/* rogue value for blocking receive timeout */
+#define DEFAULT_BLOCKING_RECV_TIMEOUT (-2)
+/* wake up from blocking every second */
+#define DEFAULT_BLOCKING_RECV_TIMEOUT_SECS_CLIENT (1)
+/* only wake up from blocking when data arrives */
+#define DEFAULT_BLOCKING_RECV_TIMEOUT_SECS_SERVER (BLOCKING_RECV_TIMEOUT_NEVER)
+
+/* ring direction indices */
+#define SERVER_TO_CLIENT (0)
+#define CLIENT_TO_SERVER (1)
+
+/* define a set of verbosity levels:
+ *
+ * 0: no verbose output
+ * 1: verbose output with data
+ * 2: extra verbose output including when data size is zero*/
+typedef enum {VERBOSITY_LEVEL_0=0, VERBOSITY_LEVEL_1, VERBOSITY_LEVEL_2} VerbosityLevel;
+/* default verbosity value */
+#define DEFAULT_VERBOSITY VERBOSITY_LEVEL_0
+
+/* MIN utility */
+#ifndef MIN
+#define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
+/***************** TYPEDEFS **************************************************/
+
+/* Control block of one single-producer / single-consumer ring. The write and
+ * read indices count bytes modulo 2^32 and live on separate cache lines so
+ * the producer and consumer do not contend. Sleepers wait on a sequence word
+ * rather than on the index itself, so that a close can wake them without
+ * changing the index. */
+typedef struct ShmRing_tag {
+    volatile uint32_T writeIdx;      /* total bytes written */
+    volatile uint32_T readerWaiting; /* reader is (about to be) asleep on
+                                        readerSeq */
+    volatile uint32_T readerSeq;     /* bumped to wake the reader */
+    char pad0[SHM_CACHE_LINE_SIZE - 3 * sizeof(uint32_T)];
+    volatile uint32_T readIdx;       /* total bytes read */
+    volatile uint32_T writerWaiting; /* writer is (about to be) asleep on
+                                        writerSeq */
+    volatile uint32_T writerSeq;     /* bumped to wake the writer */
+    char pad1[SHM_CACHE_LINE_SIZE - 3 * sizeof(uint32_T)];
+} ShmRing;
+
+/* Layout of the start of the shared memory object; the ring data for each
+ * direction follows, ringSize bytes each. */
+typedef struct ShmHeader_tag {
+    uint32_T          magic;
+    uint32_T          version;
+    uint32_T          ringSize;
+    int32_T           serverPid;    /* process that created the object */
+    volatile uint32_T serverClosed; /* the server has closed its end */
+    volatile uint32_T clientClosed; /* the client has closed its end; reset
+                                       when a client attaches */
+    char pad[SHM_CACHE_LINE_SIZE - 6 * sizeof(uint32_T)];
+    ShmRing           rings[2];
+} ShmHeader;
+
+/* Data encapsulating a single client / server connection */
+typedef struct ConnectionData_tag {
+    int         isInUse;      /* is this ConnectionData instance in use? */
+    int         isServer;     /* server (creator) or client */
+    int         blockingRecvTimeout; /* seconds; see BLOCKING_RECV_TIMEOUT_* */
+    int         verbosity;
+    char        name[SHM_NAME_MAXLEN];
+    ShmHeader * header;       /* start of the mapping */
+    size_t      mapSize;      /* size of the mapping */
+    ShmRing   * sendRing;
+    char      * sendData;
+    ShmRing   * recvRing;
+    char      * recvData;
+    uint32_T    ringMask;     /* ringSize - 1 */
+} ConnectionData;
+
+/**************** LOCAL DATA *************************************************/
+
+/* Using an array rather than a linked list allows us to have fast direct
+ * lookup of ConnectionData from streamID during calls to
+ * rtIOStreamSend/Recv */
+#define MAX_NUM_CONNECTIONS (10)
+static ConnectionData connectionDataArray[MAX_NUM_CONNECTIONS];
+
+/************** LOCAL FUNCTION PROTOTYPES ************************************/
+
+static int processArgs(
+    const int       argc,
+    void         *  argv[],
+    char        **  shmName,
+    unsigned int *  isClient,
+    int          *  isBlocking,
+    int          *  recvTimeout,
+    uint32_T     *  ringSize,
+    int          *  verbosity);
+
+static ConnectionData * getConnectionData(int streamID);
+
+static int shmWait(ConnectionData * connection,
+                   volatile uint32_T * addr,
+                   uint32_T expected,
+                   volatile uint32_T * seq,
+                   volatile uint32_T * waitingFlag,
+                   int timeoutSecs);
+
+static void shmWake(volatile uint32_T * seq,
+                    volatile uint32_T * waitingFlag);
+
+static int shmDataSet(ConnectionData * connection,
+                      const void * src,
+                      const size_t size,
+                      size_t * sizeSent);
+
+static int shmDataGet(ConnectionData * connection,
+                      char * dst,
+                      const size_t size,
+                      size_t * sizeRecvd);
+
+static int peerHasClosed(ConnectionData * connection);
+
+/*************** LOCAL FUNCTIONS **********************************************/
+
+/* Function: getConnectionData =================================================
+ * Abstract:
+ *  Retrieves a ConnectionData instance given its streamID.
+ *
+ * NOTE: An invalid streamID will lead to a NULL pointer being returned
+ */
+static ConnectionData * getConnectionData(int streamID) {
+    ConnectionData * connection = NULL;
+    if ((streamID >= 0) && (streamID < MAX_NUM_CONNECTIONS)) {
+        if (connectionDataArray[streamID].isInUse) {
+            connection = &connectionDataArray[streamID];
+        }
+    }
+    return connection;
+}
+
+/* Function: peerHasClosed ===================================================
+ * Abstract:
+ *  Returns 1 if the peer has set its closed flag in the shared header.
+ */
+static int peerHasClosed(ConnectionData * connection) {
+    return connection->isServer ?
+        (int) __atomic_load_n(&connection->header->clientClosed, __ATOMIC_SEQ_CST) :
+        (int) __atomic_load_n(&connection->header->serverClosed, __ATOMIC_SEQ_CST);
+}
+
+/* Function: futexCall =========================================================
+ * Abstract:
+ *  Thin wrapper around the futex system call on a process-shared word.
+ */
+static long futexCall(volatile uint32_T * addr,
+                      int op,
+                      uint32_T val,
+                      const struct timespec * timeout) {
+    return syscall(SYS_futex, (uint32_T *) addr, op, val, timeout, NULL, 0);
+}
+
+/* Function: shmWait ===========================================================
+ * Abstract:
+ *  Waits until *addr no longer equals 'expected', the peer closes, or the
+ *  timeout (in seconds) expires. Polls first to keep wake-up latency low,
+ *  then registers in *waitingFlag and sleeps on the futex word *seq, which
+ *  the peer bumps when it updates *addr or closes.
+ *
+ *  Returns 1 if *addr changed, 0 on timeout, -1 if the peer has closed and
+ *  *addr is unchanged.
+ */
+static int shmWait(ConnectionData * connection,
+                   volatile uint32_T * addr,
+                   uint32_T expected,
+                   volatile uint32_T * seq,
+                   volatile uint32_T * waitingFlag,
+                   int timeoutSecs) {
+    struct timespec deadline;
+    int spin;
+
+    for (spin = 0; spin < SPIN_COUNT; spin++) {
+        if (__atomic_load_n(addr, __ATOMIC_ACQUIRE) != expected) {
+            return 1;
+        }
+    }
+    if (peerHasClosed(connection)) {
+        /* data written before the close is still delivered */
+        return (__atomic_load_n(addr, __ATOMIC_ACQUIRE) != expected) ? 1 : -1;
+    }
+    if (timeoutSecs == BLOCKING_RECV_TIMEOUT_NOWAIT) {
+        return 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutSecs;
+
+    for (;;) {
+        struct timespec now;
+        struct timespec remaining;
+        const struct timespec * pTimeout = NULL;
+        /* read before the checks below: any update or close after them
+         * bumps *seq, so the futex wait then returns at once */
+        const uint32_T seqVal = __atomic_load_n(seq, __ATOMIC_SEQ_CST);
+
+        /* The flag must be visible to the peer before we re-check the index;
+         * the peer publishes its index before checking the flag. */
+        __atomic_store_n(waitingFlag, 1U, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(addr, __ATOMIC_SEQ_CST) != expected) {
+            __atomic_store_n(waitingFlag, 0U, __ATOMIC_RELAXED);
+            return 1;
+        }
+        if (peerHasClosed(connection)) {
+            __atomic_store_n(waitingFlag, 0U, __ATOMIC_RELAXED);
+            return (__atomic_load_n(addr, __ATOMIC_SEQ_CST) != expected) ? 1 : -1;
+        }
+
+        if (timeoutSecs != BLOCKING_RECV_TIMEOUT_NEVER) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            remaining.tv_sec = deadline.tv_sec - now.tv_sec;
+            remaining.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+            if (remaining.tv_nsec < 0) {
+                remaining.tv_sec--;
+                remaining.tv_nsec += 1000000000L;
+            }
+            if (remaining.tv_sec < 0) {
+                __atomic_store_n(waitingFlag, 0U, __ATOMIC_RELAXED);
+                return 0;
+            }
+            pTimeout = &remaining;
+        }
+
+        /* returns immediately with EAGAIN if *seq != seqVal */
+        (void) futexCall(seq, FUTEX_WAIT, seqVal, pTimeout);
+        __atomic_store_n(waitingFlag, 0U, __ATOMIC_RELAXED);
+
+        if (__atomic_load_n(addr, __ATOMIC_ACQUIRE) != expected) {
+            return 1;
+        }
+    }
+}
+
+/* Function: shmWake ===========================================================
+ * Abstract:
+ *  Wakes a peer sleeping on *seq, if one has registered in *waitingFlag.
+ *  Must be called after the index the peer waits on has been updated.
+ */
+static void shmWake(volatile uint32_T * seq,
+                    volatile uint32_T * waitingFlag) {
+    if (__atomic_load_n(waitingFlag, __ATOMIC_SEQ_CST)) {
+        (void) __atomic_add_fetch(seq, 1U, __ATOMIC_SEQ_CST);
+        (void) futexCall(seq, FUTEX_WAKE, 1U, NULL);
+    }
+}
+
+/* Function: shmWakeAll ========================================================
+ * Abstract:
+ *  Wakes every sleeper on both rings, after this end has set its closed
+ *  flag.
+ */
+static void shmWakeAll(ShmHeader * header) {
+    int dir;
+    for (dir = 0; dir < 2; dir++) {
+        ShmRing * ring = &header->rings[dir];
+        (void) __atomic_add_fetch(&ring->readerSeq, 1U, __ATOMIC_SEQ_CST);
+        (void) futexCall(&ring->readerSeq, FUTEX_WAKE, (uint32_T) INT_MAX, NULL);
+        (void) __atomic_add_fetch(&ring->writerSeq, 1U, __ATOMIC_SEQ_CST);
+        (void) futexCall(&ring->writerSeq, FUTEX_WAKE, (uint32_T) INT_MAX, NULL);
+    }
+}
+
+/* Function: shmDataSet ========================================================
+ * Abstract:
+ *  Copies the data into the send ring, waiting for the peer to free space
+ *  when the ring is full. Returns once all data has been written, or with an
+ *  error if the peer closes the connection while the ring is full.
+ */
+static int shmDataSet(ConnectionData * connection,
+                      const void * src,
+                      const size_t size,
+                      size_t * sizeSent) {
+    ShmRing * ring = connection->sendRing;
+    const uint32_T ringSize = connection->ringMask + 1U;
+    const char * pSrc = (const char *) src;
+    size_t remaining = size;
+
+    *sizeSent = 0;
+
+    while (remaining > 0) {
+        const uint32_T writeIdx = ring->writeIdx; /* only we write this */
+        const uint32_T readIdx = __atomic_load_n(&ring->readIdx, __ATOMIC_ACQUIRE);
+        const uint32_T space = ringSize - (writeIdx - readIdx);
+
+        if (space == 0) {
+            /* ring full: wait for the reader to consume some data,
+             * periodically checking that it is still there */
+            if (peerHasClosed(connection)) {
+                return RTIOSTREAM_ERROR;
+            }
+            (void) shmWait(connection, &ring->readIdx, readIdx,
+                           &ring->writerSeq, &ring->writerWaiting, 1);
+            continue;
+        }
+
+        {
+            const uint32_T offset = writeIdx & connection->ringMask;
+            const uint32_T nBytes = (uint32_T) MIN(remaining, (size_t) space);
+            const uint32_T firstPart = MIN(nBytes, ringSize - offset);
+
+            memcpy(&connection->sendData[offset], pSrc, firstPart);
+            if (nBytes > firstPart) {
+                memcpy(connection->sendData, pSrc + firstPart, nBytes - firstPart);
+            }
+            __atomic_store_n(&ring->writeIdx, writeIdx + nBytes, __ATOMIC_SEQ_CST);
+            shmWake(&ring->readerSeq, &ring->readerWaiting);
+
+            pSrc += nBytes;
+            remaining -= nBytes;
+            *sizeSent += nBytes;
+        }
+    }
+    return RTIOSTREAM_NO_ERROR;
+}
+
+/* Function: shmDataGet ========================================================
+ * Abstract:
+ *  Copies up to 'size' bytes out of the receive ring, waiting according to
+ *  the connection's blockingRecvTimeout if the ring is empty.
+ *
+ *  It is not an error for 'sizeRecvd' to be returned as 0. An error is
+ *  returned if the ring is empty and the peer has closed the connection,
+ *  including while this call is waiting.
+ */
+static int shmDataGet(ConnectionData * connection,
+                      char * dst,
+                      const size_t size,
+                      size_t * sizeRecvd) {
+    ShmRing * ring = connection->recvRing;
+    const uint32_T ringSize = connection->ringMask + 1U;
+    const uint32_T readIdx = ring->readIdx; /* only we write this */
+    uint32_T writeIdx = __atomic_load_n(&ring->writeIdx, __ATOMIC_ACQUIRE);
+    uint32_T avail = writeIdx - readIdx;
+
+    *sizeRecvd = 0;
+
+    if (size == 0) {
+        return RTIOSTREAM_NO_ERROR;
+    }
+
+    if (avail == 0) {
+        const int waitResult = shmWait(connection, &ring->writeIdx, writeIdx,
+                                       &ring->readerSeq, &ring->readerWaiting,
+                                       connection->blockingRecvTimeout);
+        if (waitResult < 0) {
+            if (connection->verbosity) {
+                printf("rtiostream_shm: the peer has closed %s\n", connection->name);
+            }
+            return RTIOSTREAM_ERROR;
+        }
+        if (waitResult == 0) {
+            return RTIOSTREAM_NO_ERROR;
+        }
+        writeIdx = __atomic_load_n(&ring->writeIdx, __ATOMIC_ACQUIRE);
+        avail = writeIdx - readIdx;
+    }
+
+    {
+        const uint32_T offset = readIdx & connection->ringMask;
+        const uint32_T nBytes = (uint32_T) MIN(size, (size_t) avail);
+        const uint32_T firstPart = MIN(nBytes, ringSize - offset);
+
+        memcpy(dst, &connection->recvData[offset], firstPart);
+        if (nBytes > firstPart) {
+            memcpy(dst + firstPart, connection->recvData, nBytes - firstPart);
+        }
+        __atomic_store_n(&ring->readIdx, readIdx + nBytes, __ATOMIC_SEQ_CST);
+        shmWake(&ring->writerSeq, &ring->writerWaiting);
+
+        *sizeRecvd = nBytes;
+    }
+    return RTIOSTREAM_NO_ERROR;
+}
+
+/* Function: processArgs ====================================================
+ * Abstract:
+ *  Process the arguments specified by the user when opening the rtIOStream.
+ *
+ *  If any unrecognized options are encountered, ignore them.
+ *
+ * Returns zero if successful or RTIOSTREAM_ERROR if
+ * an error occurred.
+ *
+ *  o IMPORTANT!!!
+ *    As the arguments are processed, their strings should be set to NULL in
+ *    the argv array.
+ */
+static int processArgs(
+    const int       argc,
+    void         *  argv[],
+    char        **  shmName,
+    unsigned int *  isClient,
+    int          *  isBlocking,
+    int          *  recvTimeout,
+    uint32_T     *  ringSize,
+    int          *  verbosity)
+{
+    int        retVal    = RTIOSTREAM_NO_ERROR;
+    int        count           = 0;
+
+    while(count < argc) {
+        const char *option = (char *)argv[count];
+        count++;
+
+        if (option != NULL) {
+
+            if ((strcmp(option, "-name") == 0) && (count != argc)) {
+
+                *shmName = (char *)argv[count];
+                count++;
+                if ((*shmName == NULL) ||
+                    (strlen(*shmName) >= (SHM_NAME_MAXLEN - 1))) {
+                    retVal = RTIOSTREAM_ERROR;
+                } else {
+                    argv[count-2] = NULL;
+                    argv[count-1] = NULL;
+                }
+
+            } else if ((strcmp(option, "-client") == 0) && (count != argc)) {
+
+                *isClient = ( strcmp( (char *)argv[count], "1") == 0 );
+
+                count++;
+                argv[count-2] = NULL;
+                argv[count-1] = NULL;
+
+            } else if ((strcmp(option, "-blocking") == 0) && (count != argc)) {
+
+                *isBlocking = ( strcmp( (char *)argv[count], "1") == 0 );
+
+                count++;
+                argv[count-2] = NULL;
+                argv[count-1] = NULL;
+
+            } else if ((strcmp(option, "-verbose") == 0) && (count != argc)) {
+                int verbosityVal;
+                int itemsConverted;
+                const char *verbosityStr = (char *)argv[count];
+                count++;
+                itemsConverted = sscanf(verbosityStr,"%d", &verbosityVal);
+
+                if ((itemsConverted != 1) || (verbosityVal < 0)) {
+                    retVal = RTIOSTREAM_ERROR;
+                } else {
+                    *verbosity = (VerbosityLevel) verbosityVal;
+                    argv[count-2] = NULL;
+                    argv[count-1] = NULL;
+                }
+
+            } else if ((strcmp(option, "-recv_timeout_secs") == 0) && (count != argc)) {
+                char       tmpstr[2];
+                int itemsConverted;
+                const char *timeoutSecsStr = (char *)argv[count];
+
+                count++;
+
+                itemsConverted = sscanf(timeoutSecsStr,"%d%1s", recvTimeout, tmpstr);
+                if ( itemsConverted != 1 ) {
+                    retVal = RTIOSTREAM_ERROR;
+                } else {
+                    argv[count-2] = NULL;
+                    argv[count-1] = NULL;
+                }
+
+            } else if ((strcmp(option, "-ringsize") == 0) && (count != argc)) {
+                char       tmpstr[2];
+                unsigned int sizeVal;
+                int itemsConverted;
+                const char *sizeStr = (char *)argv[count];
+
+                count++;
+
+                itemsConverted = sscanf(sizeStr,"%u%1s", &sizeVal, tmpstr);
+                if ( (itemsConverted != 1) ||
+                     (sizeVal < MIN_RING_SIZE) || (sizeVal > MAX_RING_SIZE) ) {
+                    retVal = RTIOSTREAM_ERROR;
+                } else {
+                    /* round up to a power of two */
+                    uint32_T pow2 = MIN_RING_SIZE;
+                    while (pow2 < sizeVal) {
+                        pow2 <<= 1;
+                    }
+                    *ringSize = pow2;
+                    argv[count-2] = NULL;
+                    argv[count-1] = NULL;
+                }
+
+            } else {
+                /* issue a warning for the unexpected argument: exception
+                 * is first argument which might be the executable name (
+                 * SIL/PIL and extmode use-cases). */
+                if ((count!=1) || (strncmp(option, "-", 1)==0)) {
+                    printf("The argument '%s' passed to rtiostream_shm is "
+                            "not valid and will be ignored.\n", option);
+                }
+            }
+        }
+    }
+    return retVal;
+}
+
+/* Function: shmIsStale ========================================================
+ * Abstract:
+ *  Returns 1 if the existing shared memory object 'name' was created by this
+ *  driver and its server process no longer exists, i.e. the server exited
+ *  without closing. Returns 0 if the object is in use or is not recognized.
+ */
+static int shmIsStale(const char * name) {
+    int isStale = 0;
+    struct stat st;
+    const int fd = shm_open(name, O_RDONLY, 0);
+
+    if (fd == -1) {
+        return 0;
+    }
+    if ((fstat(fd, &st) == 0) && ((size_t) st.st_size >= sizeof(ShmHeader))) {
+        const ShmHeader * header = (const ShmHeader *)
+            mmap(NULL, sizeof(ShmHeader), PROT_READ, MAP_SHARED, fd, 0);
+        if (header != MAP_FAILED) {
+            if ((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == SHM_MAGIC) &&
+                (header->serverPid > 0)) {
+                isStale = (kill((pid_t) header->serverPid, 0) == -1) &&
+                    (errno == ESRCH);
+            }
+            munmap((void *) header, sizeof(ShmHeader));
+        }
+    }
+    close(fd);
+    return isStale;
+}
+
+/* Function: shmOpen ===========================================================
+ * Abstract:
+ *  Creates (server) or attaches to (client) the shared memory object and
+ *  initializes the ring pointers of the connection.
+ */
+static int shmOpen(ConnectionData * connection, uint32_T ringSize) {
+    int fd;
+    ShmHeader * header;
+    size_t mapSize;
+
+    if (connection->isServer) {
+        fd = shm_open(connection->name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+        if ((fd == -1) && (errno == EEXIST)) {
+            /* only replace an object left behind by a server that did not
+             * close; never take over a live session */
+            if (!shmIsStale(connection->name)) {
+                printf("Shared memory object %s is in use by another server.\n",
+                       connection->name);
+                return RTIOSTREAM_ERROR;
+            }
+            (void) shm_unlink(connection->name);
+            fd = shm_open(connection->name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+        }
+        if (fd == -1) {
+            printf("shm_open(%s) failed: %s\n", connection->name, strerror(errno));
+            return RTIOSTREAM_ERROR;
+        }
+        mapSize = sizeof(ShmHeader) + 2U * (size_t) ringSize;
+        if (ftruncate(fd, (off_t) mapSize) != 0) {
+            printf("ftruncate(%s) failed: %s\n", connection->name, strerror(errno));
+            close(fd);
+            (void) shm_unlink(connection->name);
+            return RTIOSTREAM_ERROR;
+        }
+    } else {
+        struct stat st;
+        fd = shm_open(connection->name, O_RDWR, 0);
+        if (fd == -1) {
+            printf("shm_open(%s) failed: %s\n", connection->name, strerror(errno));
+            return RTIOSTREAM_ERROR;
+        }
+        if ((fstat(fd, &st) != 0) || ((size_t) st.st_size < sizeof(ShmHeader))) {
+            printf("Shared memory object %s is not valid.\n", connection->name);
+            close(fd);
+            return RTIOSTREAM_ERROR;
+        }
+        mapSize = (size_t) st.st_size;
+    }
+
+    header = (ShmHeader *) mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    /* the mapping remains valid after the descriptor is closed */
+    close(fd);
+    if (header == MAP_FAILED) {
+        printf("mmap(%s) failed: %s\n", connection->name, strerror(errno));
+        if (connection->isServer) {
+            (void) shm_unlink(connection->name);
+        }
+        return RTIOSTREAM_ERROR;
+    }
+
+    if (connection->isServer) {
+        /* ftruncate zero-fills, so the rings start empty */
+        header->ringSize = ringSize;
+        header->version = SHM_VERSION;
+        header->serverPid = (int32_T) getpid();
+        /* publish the magic last: clients check it before using the rings */
+        __atomic_store_n(&header->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+    } else {
+        if ((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHM_MAGIC) ||
+            (header->version != SHM_VERSION) ||
+            (mapSize < sizeof(ShmHeader) + 2U * (size_t) header->ringSize)) {
+            printf("Shared memory object %s is not valid.\n", connection->name);
+            munmap(header, mapSize);
+            return RTIOSTREAM_ERROR;
+        }
+        ringSize = header->ringSize;
+        if (__atomic_load_n(&header->serverClosed, __ATOMIC_SEQ_CST)) {
+            printf("Shared memory object %s has been closed by the server.\n",
+                   connection->name);
+            munmap(header, mapSize);
+            return RTIOSTREAM_ERROR;
+        }
+        __atomic_store_n(&header->clientClosed, 0U, __ATOMIC_SEQ_CST);
+    }
+
+    connection->header = header;
+    connection->mapSize = mapSize;
+    connection->ringMask = ringSize - 1U;
+    {
+        char * data = (char *) header + sizeof(ShmHeader);
+        const int sendDir = connection->isServer ? SERVER_TO_CLIENT : CLIENT_TO_SERVER;
+        const int recvDir = connection->isServer ? CLIENT_TO_SERVER : SERVER_TO_CLIENT;
+        connection->sendRing = &header->rings[sendDir];
+        connection->sendData = data + (size_t) sendDir * ringSize;
+        connection->recvRing = &header->rings[recvDir];
+        connection->recvData = data + (size_t) recvDir * ringSize;
+    }
+    return RTIOSTREAM_NO_ERROR;
+}
+
+/***************** VISIBLE FUNCTIONS ******************************************/
+
+/* Function: rtIOStreamOpen =================================================
+ * Abstract:
+ *  Open the connection with the target.
+ */
+int rtIOStreamOpen(int argc, void * argv[])
+{
+    char               *shmName = DEFAULT_SHM_NAME; /* default */
+    unsigned int        isClient = 0; /* default */
+    int                 isBlockingRecv = 0; /* default */
+    int                 blockingRecvTimeout = DEFAULT_BLOCKING_RECV_TIMEOUT; /* rogue value */
+    uint32_T            ringSize = DEFAULT_RING_SIZE;
+    int                 verbosity = DEFAULT_VERBOSITY;
+    int result;
+    int streamID;
+    ConnectionData * connection;
+
+    /* determine the streamID for this new connection */
+    for (streamID = 0; streamID < MAX_NUM_CONNECTIONS; streamID++) {
+        if (!connectionDataArray[streamID].isInUse) {
+            break;
+        }
+    }
+    if (streamID == MAX_NUM_CONNECTIONS) {
+        printf("All %d shared memory connections are already in use.\n",
+               MAX_NUM_CONNECTIONS);
+        return RTIOSTREAM_ERROR;
+    }
+
+    result = processArgs(argc, argv,
+                         &shmName,
+                         &isClient,
+                         &isBlockingRecv,
+                         &blockingRecvTimeout,
+                         &ringSize,
+                         &verbosity);
+
+    if (result == RTIOSTREAM_ERROR) {
+        return result;
+    }
+
+    if (isBlockingRecv) {
+        /* blocking: if blockingRecvTimeout has not been set, initialize to
+         * the client or server specific default */
+        if ((blockingRecvTimeout == DEFAULT_BLOCKING_RECV_TIMEOUT) ||
+            (blockingRecvTimeout < BLOCKING_RECV_TIMEOUT_NEVER)) {
+            blockingRecvTimeout = isClient ?
+                DEFAULT_BLOCKING_RECV_TIMEOUT_SECS_CLIENT :
+                DEFAULT_BLOCKING_RECV_TIMEOUT_SECS_SERVER;
+        }
+    } else {
+        /* not blocking: set the timeout to return immediately */
+        blockingRecvTimeout = BLOCKING_RECV_TIMEOUT_NOWAIT;
+    }
+
+    connection = &connectionDataArray[streamID];
+    memset(connection, 0, sizeof(ConnectionData));
+    connection->isServer = !isClient;
+    connection->blockingRecvTimeout = blockingRecvTimeout;
+    connection->verbosity = verbosity;
+    strcpy(connection->name, shmName);
+
+    if (verbosity) {
+        printf("rtIOStreamOpen (connection id %d): %s %s, ring size %lu\n",
+               streamID, isClient ? "client" : "server", shmName,
+               (unsigned long) ringSize);
+    }
+
+    result = shmOpen(connection, ringSize);
+    if (result == RTIOSTREAM_ERROR) {
+        return result;
+    }
+
+    connection->isInUse = 1;
+    return streamID;
+}
+
+/* Function: rtIOStreamSend =====================================================
+ * Abstract:
+ *  Sends the specified number of bytes on the comm line. Returns the number of
+ *  bytes sent (if successful) or a negative value if an error occurred. As long
+ *  as an error does not occur, this function is guaranteed to set the requested
+ *  number of bytes; the function blocks if the shared memory ring doesn't have
+ *  room for all of the data to be sent
+ */
+int rtIOStreamSend(
+    int streamID,
+    const void *src,
+    size_t size,
+    size_t *sizeSent)
+{
+    int retVal;
+    ConnectionData * connection = getConnectionData(streamID);
+    *sizeSent = 0;
+
+    if (connection == NULL) {
+        retVal = RTIOSTREAM_ERROR;
+        return retVal;
+    }
+
+    retVal = shmDataSet(connection, src, size, sizeSent);
+
+    if (connection->verbosity) {
+        if ((*sizeSent > 0) || (connection->verbosity >= VERBOSITY_LEVEL_2)) {
+            size_t currElement;
+            printf("rtIOStreamSend (connection id %d): size = %lu, sizeSent = %lu: ",
+                   streamID,
+                   (unsigned long) size,
+                   (unsigned long) *sizeSent);
+
+            for (currElement = 0; currElement < *sizeSent; currElement++) {
+                printf("%u ", ((const unsigned char *) src)[currElement]);
+            }
+            printf("\n");
+        }
+    }
+
+    return retVal;
+}
+
+/* Function: rtIOStreamRecv ================================================
+ * Abstract: receive data
+ *
+ */
+int rtIOStreamRecv(
+    int      streamID,
+    void   * dst,
+    size_t   size,
+    size_t * sizeRecvd)
+{
+    int retVal;
+    ConnectionData * connection = getConnectionData(streamID);
+
+    *sizeRecvd = 0;
+
+    if (connection == NULL) {
+        retVal = RTIOSTREAM_ERROR;
+        return retVal;
+    }
+
+    retVal = shmDataGet(connection, (char *) dst, size, sizeRecvd);
+
+    if (connection->verbosity) {
+        if ((*sizeRecvd > 0 ) || (connection->verbosity >= VERBOSITY_LEVEL_2)) {
+            size_t currElement;
+            printf("rtIOStreamRecv (connection id %d): size = %lu, sizeRecvd = %lu: ",
+                   streamID,
+                   (unsigned long) size,
+                   (unsigned long) *sizeRecvd);
+
+            for (currElement = 0; currElement < *sizeRecvd; currElement++) {
+                printf("%u ", ((const unsigned char *) dst)[currElement]);
+            }
+            printf("\n");
+        }
+    }
+
+    return retVal;
+}
+
+/* Function: rtIOStreamClose ================================================
+ * Abstract: close the connection.
+ *
+ */
+int rtIOStreamClose(int streamID)
+{
+    int retVal = RTIOSTREAM_NO_ERROR;
+    ConnectionData * connection = getConnectionData(streamID);
+    if (connection == NULL) {
+        retVal = RTIOSTREAM_ERROR;
+        return retVal;
+    }
+
+    if (connection->verbosity) {
+        printf("rtIOStreamClose (connection id %d)\n", streamID);
+    }
+
+    /* set the closed flag before waking the peer so that a peer blocked in
+     * rtIOStreamRecv or rtIOStreamSend returns an error */
+    if (connection->isServer) {
+        __atomic_store_n(&connection->header->serverClosed, 1U, __ATOMIC_SEQ_CST);
+        shmWakeAll(connection->header);
+        /* the object is destroyed once the client unmaps it as well */
+        (void) shm_unlink(connection->name);
+    } else {
+        __atomic_store_n(&connection->header->clientClosed, 1U, __ATOMIC_SEQ_CST);
+        shmWakeAll(connection->header);
+    }
+
+    munmap(connection->header, connection->mapSize);
+    connection->header = NULL;
+    connection->isInUse = 0;
+    return retVal;
+}
@@ -21,6 +21,11 @@
 #define _BSD_SOURCE
 #endif
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* Required for sendmmsg / recvmmsg */
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -73,6 +78,7 @@
 # include <sys/types.h>     /* Linux */
 # include <sys/socket.h>
 # include <sys/poll.h>
+# include <sys/uio.h>
 # include <netinet/in.h>    /* Linux */
 # include <netinet/tcp.h>   /* Linux */
 # include <arpa/inet.h>     /* Linux */
@@ -86,6 +92,15 @@
 
 #if defined(_WIN32) || defined(VXWORKS)
 #define USE_SELECT  
+#else
+/* UDP sequence numbers are attached with sendmsg and an iovec rather than
+ * by copying each payload into the send buffer */
+#define USE_UDP_SENDMSG
+#endif
+
+#if defined(__linux__)
+/* Multiple UDP datagrams can be moved per system call */
+#define USE_UDP_MMSG
 #endif
 
 #ifdef USE_MEXPRINTF
@@ -178,6 +193,23 @@ typedef enum {VERBOSITY_LEVEL_0=0, VERBOSITY_LEVEL_1, VERBOSITY_LEVEL_2} Verbosi
 
 #define DEFAULT_IS_USING_SEQ_NUM 1
 
+/* default number of UDP datagrams sent / received per system call
+ *
+ * Use the "-udpbatchsize N" argument to move up to N datagrams per
+ * sendmmsg / recvmmsg call (Linux only). A value of 1 disables batching. */
+#define DEFAULT_UDP_BATCH_SIZE 1
+#define MAX_UDP_BATCH_SIZE 64
+
+/* default size of the UDP receive reorder window
+ *
+ * Use the "-udpreorderwindow N" argument (with the
+ * UDP_PACKET_LOSS_DETECTION protocol) to hold up to N datagrams that arrive
+ * ahead of the expected sequence number and deliver them in order once the
+ * missing datagrams arrive. Packet loss is reported when the window is full.
+ * A value of 0 reports any out of order datagram as an error. */
+#define DEFAULT_UDP_REORDER_WINDOW 0
+#define MAX_UDP_REORDER_WINDOW 256
+
 #ifdef WIN32
   /* WINDOWS */
 # define close closesocket
@@ -248,6 +280,24 @@ typedef struct UDPData_tag {
    int resetExpectedRecvSeqNum; /* flags whether to reset expectedRecvSeqNum
                                    to the sequence number of the next incoming
                                    datagram */
+   int batchSize; /* max datagrams per sendmmsg / recvmmsg call */
+   UDPPacketBuffer ** recvBatch; /* batchSize buffers filled by recvmmsg */
+   int recvBatchCount; /* number of datagrams received into recvBatch */
+   int recvBatchNext; /* index of the next datagram in recvBatch */
+#ifdef USE_UDP_MMSG
+   struct mmsghdr * recvMsgs; /* batchSize recvmmsg headers */
+   struct iovec * recvIovs; /* batchSize recvmmsg buffers */
+   struct mmsghdr * sendMsgs; /* batchSize sendmmsg headers */
+   struct iovec * sendIovs; /* 2 * batchSize sendmmsg buffers */
+   udpSeqNum_T * sendSeqNums; /* batchSize outgoing sequence numbers */
+#endif
+   int reorderWindow; /* max datagrams held back awaiting earlier ones */
+   UDPPacketBuffer ** reorderBuffers; /* reorderWindow held datagrams, indexed
+                                         by sequence number modulo
+                                         reorderWindow */
+   udpSeqNum_T * reorderSeqNums; /* sequence number of each held datagram */
+   int * reorderIsHeld; /* whether each reorderBuffers entry is in use */
+   int numReorderHeld; /* number of datagrams currently held */
 } UDPData;
 
 /* enum of supported communications protocols */
@@ -318,7 +368,9 @@ static int initConnectionData(int connectionID,
                           int verbosity, 
                           int isUsingSeqNum,
                           int udpSendBufSize,
-                          int udpRecvBufSize); 
+                          int udpRecvBufSize,
+                          int udpBatchSize,
+                          int udpReorderWindow); 
 
 static int getConnectionID(void);
 
@@ -332,7 +384,24 @@ static void freeUDPPacketBuffer(UDPPacketBuffer ** udpPacketBuffer);
 
 static void resetUDPPacketBuffer(UDPPacketBuffer * udpPacketBuffer);
 
-static int processUDPRecvSeqNum(ConnectionData * connection);
+static int processUDPRecvSeqNum(ConnectionData * connection, int * isDeferred);
+
+static void resetUDPRecvState(UDPData * udpData);
+
+static int releaseUDPReorderedPacket(ConnectionData * connection);
+
+static int udpRecvDatagram(ConnectionData * connection, 
+                           int dontWait, 
+                           int * isDeferred, 
+                           int * wouldBlock);
+
+#ifdef USE_UDP_SENDMSG
+static int udpSocketDataSet(
+    ConnectionData * connection, 
+    const void *src,
+    const size_t size,
+    size_t *sizeSent);
+#endif
 
 static int initialUDPServerRecvfrom(ConnectionData * connection,
                                     struct sockaddr * clientSA,
@@ -350,7 +419,8 @@ static int socketDataGet(
     ConnectionData * connection, 
     char          *dst,
     const size_t   size,
-    size_t        *sizeRecvd);
+    size_t        *sizeRecvd,
+    int           *noDataPending);
 
 static int socketDataPending(
     const SOCKET sock,
@@ -386,7 +456,9 @@ static int processArgs(
     int           * verbosity, 
     int           * isUsingSeqNum,
     int           * udpSendBufSize,
-    int           * udpRecvBufSize);
+    int           * udpRecvBufSize,
+    int           * udpBatchSize,
+    int           * udpReorderWindow);
 
 #if (!defined(VXWORKS))
 static unsigned long nameLookup(char * hostName);
@@ -411,7 +483,9 @@ static int initConnectionData(int connectionID,
                           int verbosity, 
                           int isUsingSeqNum,
                           int udpSendBufSize,
-                          int udpRecvBufSize) {
+                          int udpRecvBufSize,
+                          int udpBatchSize,
+                          int udpReorderWindow) {
    int retVal = RTIOSTREAM_NO_ERROR;
    ConnectionData * connection = &connectionDataArray[connectionID];
   
@@ -440,6 +514,28 @@ static int initConnectionData(int connectionID,
       /* initialize to NULL */
       connection->udpData->recvBuffer = NULL;
       connection->udpData->sendBuffer = NULL;
+      connection->udpData->recvBatch = NULL;
+      connection->udpData->recvBatchCount = 0;
+      connection->udpData->recvBatchNext = 0;
+#ifdef USE_UDP_MMSG
+      connection->udpData->recvMsgs = NULL;
+      connection->udpData->recvIovs = NULL;
+      connection->udpData->sendMsgs = NULL;
+      connection->udpData->sendIovs = NULL;
+      connection->udpData->sendSeqNums = NULL;
+#endif
+      connection->udpData->reorderBuffers = NULL;
+      connection->udpData->reorderSeqNums = NULL;
+      connection->udpData->reorderIsHeld = NULL;
+      connection->udpData->numReorderHeld = 0;
+#ifdef USE_UDP_MMSG
+      connection->udpData->batchSize = udpBatchSize;
+#else
+      /* batching requires sendmmsg / recvmmsg */
+      connection->udpData->batchSize = 1;
+#endif
+      /* reordering requires sequence numbers */
+      connection->udpData->reorderWindow = isUsingSeqNum ? udpReorderWindow : 0;
       connection->udpData->isUsingSeqNum = isUsingSeqNum;
       connection->udpData->maxPacketSize = maxPacketSize;
       /* send sequence numbers always start from 0 */
@@ -471,6 +567,7 @@ static int initConnectionData(int connectionID,
             retVal = RTIOSTREAM_ERROR;
             return retVal; 
          }
+#ifndef USE_UDP_SENDMSG
          /* send buffer will be required in order to add the sequence
           * number to the outgoing data */
          connection->udpData->sendBuffer = createUDPPacketBuffer(maxPacketSize);
@@ -480,6 +577,56 @@ static int initConnectionData(int connectionID,
             retVal = RTIOSTREAM_ERROR;
             return retVal; 
          }
+#endif
+      }
+      if (connection->udpData->batchSize > 1) {
+         UDPData * udpData = connection->udpData;
+         int allocFailed = 0;
+         int i;
+         udpData->recvBatch = (UDPPacketBuffer **) calloc(udpData->batchSize, sizeof(UDPPacketBuffer *));
+         allocFailed = (udpData->recvBatch == NULL);
+         for (i = 0; !allocFailed && (i < udpData->batchSize); i++) {
+            udpData->recvBatch[i] = createUDPPacketBuffer(maxPacketSize);
+            allocFailed = (udpData->recvBatch[i] == NULL);
+         }
+#ifdef USE_UDP_MMSG
+         udpData->recvMsgs = (struct mmsghdr *) calloc(udpData->batchSize, sizeof(struct mmsghdr));
+         udpData->recvIovs = (struct iovec *) calloc(udpData->batchSize, sizeof(struct iovec));
+         udpData->sendMsgs = (struct mmsghdr *) calloc(udpData->batchSize, sizeof(struct mmsghdr));
+         udpData->sendIovs = (struct iovec *) calloc(2 * udpData->batchSize, sizeof(struct iovec));
+         udpData->sendSeqNums = (udpSeqNum_T *) calloc(udpData->batchSize, sizeof(udpSeqNum_T));
+         allocFailed = allocFailed || 
+            (udpData->recvMsgs == NULL) || (udpData->recvIovs == NULL) ||
+            (udpData->sendMsgs == NULL) || (udpData->sendIovs == NULL) ||
+            (udpData->sendSeqNums == NULL);
+#endif
+         if (allocFailed) {
+            printf("initConnectionData:UDP batch allocation failed.\n");
+            freeConnectionData(connection);
+            retVal = RTIOSTREAM_ERROR;
+            return retVal; 
+         }
+      }
+      if (connection->udpData->reorderWindow > 0) {
+         UDPData * udpData = connection->udpData;
+         int allocFailed = 0;
+         int i;
+         udpData->reorderSeqNums = (udpSeqNum_T *) calloc(udpData->reorderWindow, sizeof(udpSeqNum_T));
+         udpData->reorderIsHeld = (int *) calloc(udpData->reorderWindow, sizeof(int));
+         udpData->reorderBuffers = (UDPPacketBuffer **) calloc(udpData->reorderWindow, sizeof(UDPPacketBuffer *));
+         allocFailed = (udpData->reorderSeqNums == NULL) || 
+            (udpData->reorderIsHeld == NULL) ||
+            (udpData->reorderBuffers == NULL);
+         for (i = 0; !allocFailed && (i < udpData->reorderWindow); i++) {
+            udpData->reorderBuffers[i] = createUDPPacketBuffer(maxPacketSize);
+            allocFailed = (udpData->reorderBuffers[i] == NULL);
+         }
+         if (allocFailed) {
+            printf("initConnectionData:UDP reorder window allocation failed.\n");
+            freeConnectionData(connection);
+            retVal = RTIOSTREAM_ERROR;
+            return retVal; 
+         }
       }
    }
 
@@ -514,6 +661,10 @@ static int initConnectionData(int connectionID,
                                                          connection->udpData->maxPacketSize);
          printf("Connection id %d, isUsingSeqNum: %d\n", connectionID, 
                                                          connection->udpData->isUsingSeqNum);
+         printf("Connection id %d, udpBatchSize: %d\n", connectionID, 
+                                                         connection->udpData->batchSize);
+         printf("Connection id %d, udpReorderWindow: %d\n", connectionID, 
+                                                         connection->udpData->reorderWindow);
       }
       {
          /* display the size of the socket receive buffer */
@@ -596,12 +747,33 @@ static void freeConnectionData(ConnectionData * connection) {
    /* mark the ConnectionData as not in use */
    connection->isInUse = 0;
    /* free dynamic memory */
-   if (connection->protocol == UDP_PROTOCOL) {
-      freeUDPPacketBuffer(&connection->udpData->recvBuffer);
-      if (connection->udpData->isUsingSeqNum) {
-         freeUDPPacketBuffer(&connection->udpData->sendBuffer);
+   if ((connection->protocol == UDP_PROTOCOL) && (connection->udpData != NULL)) {
+      UDPData * udpData = connection->udpData;
+      int i;
+      freeUDPPacketBuffer(&udpData->recvBuffer);
+      freeUDPPacketBuffer(&udpData->sendBuffer);
+      if (udpData->recvBatch != NULL) {
+         for (i = 0; i < udpData->batchSize; i++) {
+            freeUDPPacketBuffer(&udpData->recvBatch[i]);
+         }
+         free(udpData->recvBatch);
+      }
+#ifdef USE_UDP_MMSG
+      free(udpData->recvMsgs);
+      free(udpData->recvIovs);
+      free(udpData->sendMsgs);
+      free(udpData->sendIovs);
+      free(udpData->sendSeqNums);
+#endif
+      if (udpData->reorderBuffers != NULL) {
+         for (i = 0; i < udpData->reorderWindow; i++) {
+            freeUDPPacketBuffer(&udpData->reorderBuffers[i]);
+         }
+         free(udpData->reorderBuffers);
       }
-      free(connection->udpData);
+      free(udpData->reorderSeqNums);
+      free(udpData->reorderIsHeld);
+      free(udpData);
       connection->udpData = NULL;
    }
    if (connection->isServer) {
@@ -687,9 +859,15 @@ static int socketDataPending(
     
     
     if (connection->protocol == UDP_PROTOCOL) {
-       /* first check the UDP buffer */
-       UDPPacketBuffer * udpPacketBuffer = connection->udpData->recvBuffer;
-       if (udpPacketBuffer->dataAvail) {
+       /* first check the UDP buffer, then datagrams already received by 
+        * recvmmsg or held back by the reorder window */
+       UDPData * udpData = connection->udpData;
+       if ((udpData->recvBuffer->dataAvail) ||
+           (udpData->recvBatchNext < udpData->recvBatchCount) ||
+           ((udpData->numReorderHeld > 0) &&
+            udpData->reorderIsHeld[udpData->expectedRecvSeqNum % udpData->reorderWindow] &&
+            (udpData->reorderSeqNums[udpData->expectedRecvSeqNum % udpData->reorderWindow] ==
+             udpData->expectedRecvSeqNum))) {
           *outPending = 1;
           return retVal;
        }
@@ -788,6 +966,7 @@ static int initialUDPServerRecvfrom(ConnectionData * connection,
                                     rtiostream_socklen_t * clientSALen) {
    int nRead;
    int retVal;
+   int isDeferred;
    UDPPacketBuffer * udpPacketBuffer = connection->udpData->recvBuffer;
    /* reset */ 
    resetUDPPacketBuffer(udpPacketBuffer);
@@ -807,21 +986,189 @@ static int initialUDPServerRecvfrom(ConnectionData * connection,
    } else {
       /* set dataAvail */
       udpPacketBuffer->dataAvail = nRead;
-      /* handle optional sequence number */
-      retVal = processUDPRecvSeqNum(connection);
+      /* handle optional sequence number; the first datagram always seeds 
+       * the expected sequence number so it is never deferred */
+      retVal = processUDPRecvSeqNum(connection, &isDeferred);
    }
    return retVal;
 }
 
+/* Function: resetUDPRecvState =====================================================
+ * Abstract:
+ *  Discards any datagrams received by recvmmsg but not yet consumed and any 
+ *  datagrams held by the reorder window. Used when a new client connects.
+ */
+static void resetUDPRecvState(UDPData * udpData) {
+   int i;
+   udpData->recvBatchCount = 0;
+   udpData->recvBatchNext = 0;
+   for (i = 0; i < udpData->reorderWindow; i++) {
+      udpData->reorderIsHeld[i] = 0;
+   }
+   udpData->numReorderHeld = 0;
+}
+
+/* Function: releaseUDPReorderedPacket =============================================
+ * Abstract:
+ *  If the reorder window holds the datagram with the expected sequence 
+ *  number, moves it into the receive buffer and returns 1. Returns 0 
+ *  otherwise.
+ */
+static int releaseUDPReorderedPacket(ConnectionData * connection) {
+   UDPData * udpData = connection->udpData;
+   int slot;
+   UDPPacketBuffer * tmp;
+   if (udpData->numReorderHeld == 0) {
+      return 0;
+   }
+   slot = (int) (udpData->expectedRecvSeqNum % (udpSeqNum_T) udpData->reorderWindow);
+   if (!udpData->reorderIsHeld[slot] || 
+       (udpData->reorderSeqNums[slot] != udpData->expectedRecvSeqNum)) {
+      return 0;
+   }
+   /* swap the held datagram into the receive buffer */
+   tmp = udpData->recvBuffer;
+   udpData->recvBuffer = udpData->reorderBuffers[slot];
+   udpData->reorderBuffers[slot] = tmp;
+   udpData->reorderIsHeld[slot] = 0;
+   udpData->numReorderHeld--;
+   udpData->expectedRecvSeqNum++;
+   if (connection->verbosity) {
+      printf("Released reordered UDP packet with sequence number: %u\n", 
+             udpData->expectedRecvSeqNum - 1);
+   }
+   return 1;
+}
+
+/* Function: udpRecvDatagram =======================================================
+ * Abstract:
+ *  Places the next incoming datagram in the UDP receive buffer, receiving a 
+ *  new batch with recvmmsg if batching is enabled and the current batch is 
+ *  exhausted, and processes its optional sequence number. isDeferred is set 
+ *  if the datagram was held back by the reorder window or dropped as a 
+ *  duplicate, in which case the receive buffer is left empty.
+ *
+ *  If dontWait is set and no datagram is queued, wouldBlock is set and the
+ *  receive buffer is left empty.
+ *
+ *  RTIOSTREAM_NO_ERROR is returned on success, RTIOSTREAM_ERROR is returned on
+ *  failure.
+ */
+static int udpRecvDatagram(ConnectionData * connection, 
+                           int dontWait, 
+                           int * isDeferred, 
+                           int * wouldBlock) {
+   UDPData * udpData = connection->udpData;
+   int nRead;
+
+   *isDeferred = 0;
+   *wouldBlock = 0;
+
+#ifdef USE_UDP_MMSG
+   if (udpData->batchSize > 1) {
+      UDPPacketBuffer * tmp;
+      if (udpData->recvBatchNext == udpData->recvBatchCount) {
+         int i;
+         for (i = 0; i < udpData->batchSize; i++) {
+            resetUDPPacketBuffer(udpData->recvBatch[i]);
+            udpData->recvIovs[i].iov_base = udpData->recvBatch[i]->buffer;
+            udpData->recvIovs[i].iov_len = (size_t) udpData->maxPacketSize;
+            memset(&udpData->recvMsgs[i].msg_hdr, 0, sizeof(struct msghdr));
+            udpData->recvMsgs[i].msg_hdr.msg_iov = &udpData->recvIovs[i];
+            udpData->recvMsgs[i].msg_hdr.msg_iovlen = 1;
+         }
+         /* block for the first datagram unless asked not to, then take 
+          * whatever else is already queued */
+         nRead = recvmmsg(connection->sock, 
+                          udpData->recvMsgs, 
+                          (unsigned int) udpData->batchSize, 
+                          dontWait ? MSG_DONTWAIT : MSG_WAITFORONE, 
+                          NULL);
+         if (nRead == SOCK_ERR) {
+            if (dontWait && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+               udpData->recvBatchCount = 0;
+               udpData->recvBatchNext = 0;
+               *wouldBlock = 1;
+               return RTIOSTREAM_NO_ERROR;
+            }
+            return RTIOSTREAM_ERROR;
+         }
+         for (i = 0; i < nRead; i++) {
+            udpData->recvBatch[i]->dataAvail = (int) udpData->recvMsgs[i].msg_len;
+         }
+         udpData->recvBatchCount = nRead;
+         udpData->recvBatchNext = 0;
+      }
+      /* swap the next datagram of the batch into the receive buffer */
+      tmp = udpData->recvBuffer;
+      udpData->recvBuffer = udpData->recvBatch[udpData->recvBatchNext];
+      udpData->recvBatch[udpData->recvBatchNext] = tmp;
+      udpData->recvBatchNext++;
+   }
+   else
+#endif
+   {
+      UDPPacketBuffer * udpPacketBuffer = udpData->recvBuffer;
+      /* reset */ 
+      resetUDPPacketBuffer(udpPacketBuffer);
+#ifdef MSG_DONTWAIT
+      /* read into buffer */
+      nRead = recv(connection->sock, 
+                   udpPacketBuffer->dataPtr, 
+                   udpData->maxPacketSize, 
+                   dontWait ? MSG_DONTWAIT : 0);
+      if (nRead == SOCK_ERR) {
+         if (dontWait && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            *wouldBlock = 1;
+            return RTIOSTREAM_NO_ERROR;
+         }
+         return RTIOSTREAM_ERROR;
+      }
+#else
+      if (dontWait) {
+         int pending;
+         if (socketDataPending(connection->sock, 
+                               connection, 
+                               &pending, 
+                               BLOCKING_RECV_TIMEOUT_NOWAIT) == RTIOSTREAM_ERROR) {
+            return RTIOSTREAM_ERROR;
+         }
+         if (!pending) {
+            *wouldBlock = 1;
+            return RTIOSTREAM_NO_ERROR;
+         }
+      }
+      /* read into buffer */
+      nRead = recv(connection->sock, 
+                   udpPacketBuffer->dataPtr, 
+                   udpData->maxPacketSize, 
+                   0U);
+      if (nRead == SOCK_ERR) {
+         return RTIOSTREAM_ERROR;
+      }
+#endif
+      udpPacketBuffer->dataAvail = nRead;
+   }
+
+   /* handle optional sequence number */
+   return processUDPRecvSeqNum(connection, isDeferred);
+}
+
 /* Function: processUDPRecvSeqNum =====================================================
  * Abstract:
  *  Processes sequence numbers in received UDP datagrams.
  *
+ *  If a reorder window is in use, a datagram that is ahead of the expected
+ *  sequence number is moved into the window and a datagram that is behind it
+ *  (a duplicate) is discarded; in both cases isDeferred is set and the
+ *  receive buffer is left empty.
+ *
  *  RTIOSTREAM_NO_ERROR is returned on success, RTIOSTREAM_ERROR is returned on
  *  failure.
  */
-static int processUDPRecvSeqNum(ConnectionData * connection) {
+static int processUDPRecvSeqNum(ConnectionData * connection, int * isDeferred) {
    int retVal = RTIOSTREAM_NO_ERROR;
+   *isDeferred = 0;
    if (connection->udpData->isUsingSeqNum) {
       UDPPacketBuffer * udpPacketBuffer = connection->udpData->recvBuffer;
       /* process sequence number */
@@ -849,8 +1196,44 @@ static int processUDPRecvSeqNum(ConnectionData * connection) {
          connection->udpData->resetExpectedRecvSeqNum = 0;
       }
       else {
-         /* compare with expected receive seq num */
-         if (recvSeqNum != connection->udpData->expectedRecvSeqNum) {
+         UDPData * udpData = connection->udpData;
+         /* signed distance from the expected receive seq num, allowing 
+          * for wrap-around */
+         const int32_T seqDiff = (int32_T) (recvSeqNum - udpData->expectedRecvSeqNum);
+         if ((seqDiff < 0) && (udpData->reorderWindow > 0)) {
+            /* already delivered: discard the duplicate */
+            if (connection->verbosity) {
+               printf("Discarded duplicate UDP packet with sequence number: %u\n", recvSeqNum);
+            }
+            resetUDPPacketBuffer(udpPacketBuffer);
+            *isDeferred = 1;
+         }
+         else if ((seqDiff > 0) && (seqDiff < udpData->reorderWindow) &&
+                  udpData->reorderIsHeld[recvSeqNum % (udpSeqNum_T) udpData->reorderWindow]) {
+            /* already held: discard the duplicate */
+            if (connection->verbosity) {
+               printf("Discarded duplicate UDP packet with sequence number: %u\n", recvSeqNum);
+            }
+            resetUDPPacketBuffer(udpPacketBuffer);
+            *isDeferred = 1;
+         }
+         else if ((seqDiff > 0) && (seqDiff < udpData->reorderWindow)) {
+            /* arrived early: hold it until the missing datagrams arrive */
+            const int slot = (int) (recvSeqNum % (udpSeqNum_T) udpData->reorderWindow);
+            UDPPacketBuffer * tmp = udpData->reorderBuffers[slot];
+            udpData->reorderBuffers[slot] = udpPacketBuffer;
+            udpData->recvBuffer = tmp;
+            resetUDPPacketBuffer(tmp);
+            udpData->reorderSeqNums[slot] = recvSeqNum;
+            udpData->reorderIsHeld[slot] = 1;
+            udpData->numReorderHeld++;
+            if (connection->verbosity) {
+               printf("Holding out of order UDP packet with sequence number: %u\n", recvSeqNum);
+            }
+            *isDeferred = 1;
+         }
+         else if (recvSeqNum != udpData->expectedRecvSeqNum) {
+            /* out of order beyond the reorder window: packet loss */
             printf("UDP packet sequence number mismatch. Expected #: %d, Actual #: %d\n", 
                   connection->udpData->expectedRecvSeqNum, recvSeqNum);
             retVal = RTIOSTREAM_ERROR;
@@ -874,17 +1257,24 @@ static int processUDPRecvSeqNum(ConnectionData * connection) {
  * NOTES:
  *  o it is not an error for 'sizeRecvd' to be returned as 0
  *  o this function blocks if no data is available
+ *  o for UDP, 'noDataPending' is set when 0 bytes are returned because the
+ *    only datagrams received were held back by the reorder window or were
+ *    duplicates; this is not a closed connection. Unless the stream blocks
+ *    indefinitely, no further datagrams are waited for in this case.
  */
 static int socketDataGet(ConnectionData * connection,
     char          *dst,
     const size_t   size,
-    size_t        *sizeRecvd)
+    size_t        *sizeRecvd,
+    int           *noDataPending)
 {
     int nRead = 0;
     int retVal = RTIOSTREAM_NO_ERROR; 
     /* Ensure size is not out of range for socket API recv function */
     int sizeLim = (int) MIN(size, INT_MAX);
 
+    *noDataPending = 0;
+
     if (connection->protocol == TCP_PROTOCOL) {
        nRead = recv(connection->sock, dst, sizeLim, 0U);
        if (nRead == SOCK_ERR) {
@@ -894,28 +1284,36 @@ static int socketDataGet(ConnectionData * connection,
        }
     }
     else { 
-       UDPPacketBuffer * udpPacketBuffer = connection->udpData->recvBuffer;
-       /* receive more data in to the buffer if required */
-       if (udpPacketBuffer->dataAvail == 0) {         
-          /* reset */ 
-          resetUDPPacketBuffer(udpPacketBuffer);
-          /* read into buffer */
-          nRead = recv(connection->sock, 
-                       udpPacketBuffer->dataPtr, 
-                       connection->udpData->maxPacketSize, 
-                       0U);
-          
-          if (nRead == SOCK_ERR) {
-             retVal = RTIOSTREAM_ERROR;
-          } else {
-             udpPacketBuffer->dataAvail = nRead;
-             /* handle optional sequence number */
-             retVal = processUDPRecvSeqNum(connection);             
+       UDPPacketBuffer * udpPacketBuffer;
+       /* receive more data in to the buffer if required; a datagram held 
+        * back by the reorder window leaves the buffer empty so keep 
+        * receiving until the expected datagram arrives */
+       if (connection->udpData->recvBuffer->dataAvail == 0) {
+          int isDeferred = 0;
+          int wouldBlock = 0;
+          /* a non-blocking stream must never block in recv; the caller's 
+           * wait is used up by the first datagram of a stream with a 
+           * timeout */
+          int dontWait = 
+             (connection->blockingRecvTimeout == BLOCKING_RECV_TIMEOUT_NOWAIT);
+          do {
+             if (releaseUDPReorderedPacket(connection)) {
+                break;
+             }
+             retVal = udpRecvDatagram(connection, dontWait, &isDeferred, &wouldBlock);
              if (retVal == RTIOSTREAM_ERROR) {
                 return retVal;
              }
-          }
+             if (wouldBlock) {
+                /* only deferred datagrams so far: return 0 bytes */
+                *noDataPending = 1;
+                break;
+             }
+             dontWait = 
+                (connection->blockingRecvTimeout != BLOCKING_RECV_TIMEOUT_NEVER);
+          } while (isDeferred);
        }
+       udpPacketBuffer = connection->udpData->recvBuffer;
        /* get data from the buffer */
        /* for the special case where we request a  */
        /* size of 0 bytes, return the whole buffer */
@@ -939,6 +1337,108 @@ static int socketDataGet(ConnectionData * connection,
 } /* end socketDataGet */ 
 
 
+#ifdef USE_UDP_SENDMSG
+/* Function: udpSocketDataSet ==================================================
+ * Abstract:
+ *  Sends data via the specified UDP socket. The optional sequence number is
+ *  attached with a separate iovec so the payload is never copied. If 
+ *  batching is enabled and the data spans several datagrams, up to batchSize 
+ *  datagrams are sent with a single sendmmsg call.
+ */
+static int udpSocketDataSet(
+    ConnectionData * connection,
+    const void *src,
+    const size_t size,
+    size_t *sizeSent)
+{
+    UDPData * udpData = connection->udpData;
+    const int isUsingSeqNum = udpData->isUsingSeqNum;
+    const size_t maxPayload = (size_t) (udpData->maxPacketSize - 
+                                        (isUsingSeqNum ? UDP_SEQ_NUM_SIZE : 0));
+    /* iovec does not take a const pointer */
+    char * payload = (char *) src;
+    int retVal = RTIOSTREAM_NO_ERROR;
+
+    *sizeSent = 0;
+
+#ifdef USE_UDP_MMSG
+    if ((udpData->batchSize > 1) && (size > maxPayload)) {
+       const int numPackets = (int) MIN((size + maxPayload - 1) / maxPayload, 
+                                        (size_t) udpData->batchSize);
+       int nSent;
+       int i;
+       for (i = 0; i < numPackets; i++) {
+          const size_t offset = (size_t) i * maxPayload;
+          struct iovec * iov = &udpData->sendIovs[2 * i];
+          struct msghdr * hdr = &udpData->sendMsgs[i].msg_hdr;
+          memset(hdr, 0, sizeof(struct msghdr));
+          /* sequence number is always transmitted / received in 
+           * host Endian */
+          udpData->sendSeqNums[i] = udpData->sendSeqNum + (udpSeqNum_T) i;
+          iov[0].iov_base = &udpData->sendSeqNums[i];
+          iov[0].iov_len = UDP_SEQ_NUM_SIZE;
+          iov[1].iov_base = payload + offset;
+          iov[1].iov_len = MIN(maxPayload, size - offset);
+          hdr->msg_iov = isUsingSeqNum ? &iov[0] : &iov[1];
+          hdr->msg_iovlen = isUsingSeqNum ? 2 : 1;
+       }
+       nSent = sendmmsg(connection->sock, udpData->sendMsgs, (unsigned int) numPackets, 0);
+       if (nSent == SOCK_ERR) {
+          retVal = RTIOSTREAM_ERROR;
+          return retVal;
+       }
+       for (i = 0; i < nSent; i++) {
+          *sizeSent += udpData->sendIovs[2 * i + 1].iov_len;
+       }
+       if (isUsingSeqNum) {
+          if (connection->verbosity && (nSent > 0)) {
+             printf("Sent UDP packets with sequence numbers: %u to %u\n", 
+                    udpData->sendSeqNum, 
+                    udpData->sendSeqNum + (udpSeqNum_T) nSent - 1);
+          }
+          udpData->sendSeqNum += (udpSeqNum_T) nSent;
+       }
+       return retVal;
+    }
+#endif
+
+    {
+       struct iovec iov[2];
+       struct msghdr hdr;
+       ssize_t nSent;
+       memset(&hdr, 0, sizeof(hdr));
+       /* sequence number is always transmitted / received in 
+        * host Endian */
+       iov[0].iov_base = &udpData->sendSeqNum;
+       iov[0].iov_len = UDP_SEQ_NUM_SIZE;
+       iov[1].iov_base = payload;
+       iov[1].iov_len = MIN(maxPayload, size);
+       hdr.msg_iov = isUsingSeqNum ? &iov[0] : &iov[1];
+       hdr.msg_iovlen = isUsingSeqNum ? 2 : 1;
+
+       nSent = sendmsg(connection->sock, &hdr, 0);
+       if (nSent == SOCK_ERR) {
+          retVal = RTIOSTREAM_ERROR;
+       } else if (isUsingSeqNum && (nSent > 0)) {
+          if (nSent < (ssize_t) UDP_SEQ_NUM_SIZE) {
+             /* expected the sequence number to have transmitted */
+             retVal = RTIOSTREAM_ERROR;
+             return retVal;
+          }
+          if (connection->verbosity) {
+             printf("Sent UDP packet with sequence number: %u\n", udpData->sendSeqNum);
+          }
+          /* increment sequence number */
+          udpData->sendSeqNum++;
+          *sizeSent = (size_t) (nSent - UDP_SEQ_NUM_SIZE);
+       } else {
+          *sizeSent = (size_t) nSent;
+       }
+    }
+    return retVal;
+}
+#endif
+
 /* Function: socketDataSet =====================================================
  * Abstract:
  *  Utility function to send data via the specified socket
@@ -956,6 +1456,13 @@ static int socketDataSet(
     /* Ensure size is not out of range for socket API send function */
     int sizeLim = (int) MIN(size, INT_MAX);
 
+#ifdef USE_UDP_SENDMSG
+    if (connection->protocol == UDP_PROTOCOL) {
+       retVal = udpSocketDataSet(connection, src, size, sizeSent);
+       return retVal;
+    }
+#endif
+
     if (connection->protocol == UDP_PROTOCOL) {
        /* limit sends according to max packet size */
        int maxPacketSize = connection->udpData->maxPacketSize;
@@ -1035,6 +1542,7 @@ static int serverStreamRecv(
 
     if (connection->sock != INVALID_SOCKET) {
         int pending;
+        int noDataPending = 0;
         if (connection->blockingRecvTimeout != BLOCKING_RECV_TIMEOUT_NEVER) {
            /* only call costly "select" if necessary */
            retVal = socketDataPending(connection->sock, 
@@ -1049,9 +1557,10 @@ static int serverStreamRecv(
 
         if ( (pending !=0) && (retVal==RTIOSTREAM_NO_ERROR) && (size>0) ) {
            
-            retVal = socketDataGet(connection, (char *)dst, size, sizeRecvd);
+            retVal = socketDataGet(connection, (char *)dst, size, sizeRecvd, 
+                                   &noDataPending);
             
-            if (*sizeRecvd == 0) {
+            if ((*sizeRecvd == 0) && !noDataPending) {
                 
                 if (errno == RTIOSTREAM_ECONNRESET) {
                     /* If we are closing the connection and we received this
@@ -1285,6 +1794,7 @@ static void serverAcceptSocket(ConnectionData * connection)
          /* new connection, make sure we reset expectedRecvSeqNum, 
           * if sequence numbers are in use */
          connection->udpData->resetExpectedRecvSeqNum = 1;
+         resetUDPRecvState(connection->udpData);
          /* Do the initial UDP server "recvfrom" to get the 
           * client sockaddr.   Data read will be placed 
           * ready in the UDP packet buffer. */
@@ -1381,7 +1891,9 @@ static int processArgs(
     int           * verbosity, 
     int           * isUsingSeqNum,
     int           * udpSendBufSize,
-    int           * udpRecvBufSize)
+    int           * udpRecvBufSize,
+    int           * udpBatchSize,
+    int           * udpReorderWindow)
 {
     int        retVal    = RTIOSTREAM_NO_ERROR;
     int        count           = 0;
@@ -1536,6 +2048,36 @@ static int processArgs(
                   argv[count-2] = NULL;
                   argv[count-1] = NULL;
                } 
+           }else if ((strcmp(option, "-udpbatchsize") == 0) && (count != argc)) {
+               char       tmpstr[2];
+               int itemsConverted;
+               const char *udpBatchSizeStr = (char *)argv[count];
+
+               count++;     
+
+               itemsConverted = sscanf(udpBatchSizeStr,"%d%1s", udpBatchSize, tmpstr);
+               if ( (itemsConverted != 1) || 
+                    (*udpBatchSize < 1) || (*udpBatchSize > MAX_UDP_BATCH_SIZE) ) {
+                  retVal = RTIOSTREAM_ERROR;
+               } else {
+                  argv[count-2] = NULL;
+                  argv[count-1] = NULL;
+               } 
+           }else if ((strcmp(option, "-udpreorderwindow") == 0) && (count != argc)) {
+               char       tmpstr[2];
+               int itemsConverted;
+               const char *udpReorderWindowStr = (char *)argv[count];
+
+               count++;     
+
+               itemsConverted = sscanf(udpReorderWindowStr,"%d%1s", udpReorderWindow, tmpstr);
+               if ( (itemsConverted != 1) || 
+                    (*udpReorderWindow < 0) || (*udpReorderWindow > MAX_UDP_REORDER_WINDOW) ) {
+                  retVal = RTIOSTREAM_ERROR;
+               } else {
+                  argv[count-2] = NULL;
+                  argv[count-1] = NULL;
+               } 
             } else {
                 /* issue a warning for the unexpected argument: exception 
                  * is first argument which might be the executable name (
@@ -1685,6 +2227,8 @@ int rtIOStreamOpen(int argc, void * argv[])
     int                 isUsingSeqNum = DEFAULT_IS_USING_SEQ_NUM;
     int                 udpSendBufSize = DEFAULT_UDP_SOCKET_SEND_SIZE_REQUEST;
     int                 udpRecvBufSize = DEFAULT_UDP_SOCKET_RECEIVE_SIZE_REQUEST;
+    int                 udpBatchSize = DEFAULT_UDP_BATCH_SIZE;
+    int                 udpReorderWindow = DEFAULT_UDP_REORDER_WINDOW;
     int result = RTIOSTREAM_NO_ERROR;
     int streamID;
     SOCKET sock = INVALID_SOCKET;
@@ -1708,7 +2252,9 @@ int rtIOStreamOpen(int argc, void * argv[])
                          &verbosity, 
                          &isUsingSeqNum,
                          &udpSendBufSize,
-                         &udpRecvBufSize);
+                         &udpRecvBufSize,
+                         &udpBatchSize,
+                         &udpReorderWindow);
 
     if (result == RTIOSTREAM_ERROR) {
        return result;
@@ -1788,7 +2334,9 @@ int rtIOStreamOpen(int argc, void * argv[])
              verbosity, 
              isUsingSeqNum,
              udpSendBufSize,
-             udpRecvBufSize);
+             udpRecvBufSize,
+             udpBatchSize,
+             udpReorderWindow);
     }
     
     if (result != RTIOSTREAM_ERROR) {
@@ -1902,7 +2450,9 @@ int rtIOStreamRecv(
            pending = 1;
         }
         if (pending) {
-            retVal = socketDataGet(connection, (char *)dst, size, sizeRecvd);
+            int noDataPending;
+            retVal = socketDataGet(connection, (char *)dst, size, sizeRecvd, 
+                                   &noDataPending);
         }
     }
 
@@ -0,0 +1,505 @@
+/*
+ * Copyright 2017 The MathWorks, Inc.
+ *
+ * File: codeinstr_decode.c
+ *
+ * Abstract:
+ *  Offline decoder for code instrumentation records captured with the ring
+ *  buffer in CodeInstrTgtAppSvc/CodeInstrRingBuffer.h. The input is a file
+ *  of batches as written by codeInstrRingDumpToFile. When built with
+ *  CODEINSTR_DECODE_RTIOSTREAM, the decoder can also record the batches
+ *  that the target sends with codeInstrRingDrain over a dedicated
+ *  rtIOStream connection into the capture file, then decode it.
+ *
+ *  The decoder pairs section start and end records, then reports for each
+ *  section the number of calls and the minimum, mean, maximum and total
+ *  execution time, both including (inclusive) and excluding (self) nested
+ *  sections. It can also write the call stacks in the folded format read
+ *  by flame graph tools, one line per distinct stack with its self time.
+ *
+ *  Build with, e.g.:
+ *
+ *    gcc -O2 -o codeinstr_decode codeinstr_decode.c
+ *
+ *  or, to record from the target over TCP/IP:
+ *
+ *    gcc -O2 -DCODEINSTR_DECODE_RTIOSTREAM -o codeinstr_decode
+ *        codeinstr_decode.c ../rtiostreamtcpip/rtiostream_tcpip.c
+ *        -I.. -I../.. -I<matlabroot>/extern/include
+ *
+ *  Usage:
+ *
+ *    codeinstr_decode <capture file> [-names <file>] [-folded <file>]
+ *                     [-tick <seconds>] [-swap]
+ *                     [-record <rtIOStreamOpen options>]
+ *
+ *  -names   text file with one "<section id> <name>" pair per line
+ *  -folded  write folded stacks for flame graph tools to this file
+ *  -tick    duration of one timer tick; times are reported in ticks
+ *           by default
+ *  -swap    the capture is in the opposite byte order to the host
+ *  -record  connect to the target as an rtIOStream client, passing all
+ *           remaining options to rtIOStreamOpen, and write the received
+ *           stream to the capture file until nothing has arrived for
+ *           RECORD_IDLE_SECS seconds, e.g. because the target closed it
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(CODEINSTR_DECODE_RTIOSTREAM)
+#include <time.h>
+#include "rtiostream.h"
+#endif
+
+/***************** DEFINES ****************************************************/
+
+#define EXIT_FLAG       0x80000000U
+#define MAX_DEPTH       256
+#define MAX_NAME        128
+#define BATCH_RECORDS   4096
+#define MAX_OPEN_ARGS   64
+#define RECORD_IDLE_SECS 5
+
+/***************** TYPEDEFS ***************************************************/
+
+typedef unsigned int uint32;
+
+typedef struct {
+    uint32 id;
+    char   name[MAX_NAME];
+    unsigned long calls;
+    double inclTotal;
+    double inclMin;
+    double inclMax;
+    double selfTotal;
+    int    used;
+} SectionStats;
+
+/* Node of the call tree. Children of a node are kept in a singly linked
+ * list; the tree only grows, so nodes are never freed before exit. */
+typedef struct CallNode_tag {
+    uint32 id;
+    double selfTotal;
+    struct CallNode_tag *parent;
+    struct CallNode_tag *firstChild;
+    struct CallNode_tag *nextSibling;
+} CallNode;
+
+typedef struct {
+    CallNode *node;
+    uint32    start;
+    double    childTicks;
+} Frame;
+
+/***************** LOCAL DATA *************************************************/
+
+static SectionStats *stats;
+static size_t  statsCapacity;   /* power of two */
+static size_t  statsCount;
+
+static CallNode root;
+static Frame   stack[MAX_DEPTH];
+static int     depth;
+
+static int     swapBytes;
+static unsigned long numRecords;
+static unsigned long numDropped;
+static unsigned long numUnmatched;
+static unsigned long numResyncs;
+
+/***************** LOCAL FUNCTIONS ********************************************/
+
+static uint32 toHost(uint32 v)
+{
+    if (!swapBytes) return v;
+    return (v >> 24) | ((v >> 8) & 0xFF00U) | ((v << 8) & 0xFF0000U) | (v << 24);
+}
+
+/* Function: lookupSection ====================================================
+ * Abstract:
+ *  Find or create the statistics of a section in an open addressing hash
+ *  table keyed by section id. Returns NULL if out of memory.
+ */
+static SectionStats *lookupSection(uint32 id)
+{
+    size_t i;
+
+    if (2 * (statsCount + 1) > statsCapacity) {
+        size_t        oldCapacity = statsCapacity;
+        SectionStats *old = stats;
+        size_t        j;
+
+        statsCapacity = oldCapacity ? 2 * oldCapacity : 256;
+        stats = (SectionStats *)calloc(statsCapacity, sizeof(SectionStats));
+        if (stats == NULL) return NULL;
+        for (j = 0; j < oldCapacity; j++) {
+            if (old[j].used) {
+                i = (old[j].id * 2654435761U) & (statsCapacity - 1);
+                while (stats[i].used) i = (i + 1) & (statsCapacity - 1);
+                stats[i] = old[j];
+            }
+        }
+        free(old);
+    }
+
+    i = (id * 2654435761U) & (statsCapacity - 1);
+    while (stats[i].used && stats[i].id != id) {
+        i = (i + 1) & (statsCapacity - 1);
+    }
+    if (!stats[i].used) {
+        stats[i].used = 1;
+        stats[i].id = id;
+        sprintf(stats[i].name, "section_%u", id);
+        statsCount++;
+    }
+    return &stats[i];
+}
+
+static CallNode *childOf(CallNode *parent, uint32 id)
+{
+    CallNode *child;
+    for (child = parent->firstChild; child != NULL; child = child->nextSibling) {
+        if (child->id == id) return child;
+    }
+    child = (CallNode *)calloc(1, sizeof(CallNode));
+    if (child == NULL) return NULL;
+    child->id = id;
+    child->parent = parent;
+    child->nextSibling = parent->firstChild;
+    parent->firstChild = child;
+    return child;
+}
+
+/* Function: closeFrame =======================================================
+ * Abstract:
+ *  Pop the innermost open section, which ended at the given timer value, and
+ *  account its inclusive and self time.
+ */
+static int closeFrame(uint32 timer)
+{
+    Frame        *f = &stack[--depth];
+    double        incl = (double)(uint32)(timer - f->start);
+    double        self = incl - f->childTicks;
+    SectionStats *s = lookupSection(f->node->id);
+
+    if (s == NULL) return 0;
+    if (self < 0) self = 0;
+    if (s->calls == 0 || incl < s->inclMin) s->inclMin = incl;
+    if (s->calls == 0 || incl > s->inclMax) s->inclMax = incl;
+    s->calls++;
+    s->inclTotal += incl;
+    s->selfTotal += self;
+    f->node->selfTotal += self;
+    if (depth > 0) stack[depth - 1].childTicks += incl;
+    return 1;
+}
+
+/* Function: processRecord ====================================================
+ * Abstract:
+ *  Match one start or end record against the stack of open sections. An end
+ *  record that does not match the innermost section, e.g. because records
+ *  were dropped, closes the sections above its start; if its section is not
+ *  open at all the record is ignored.
+ */
+static int processRecord(uint32 sectionId, uint32 timer)
+{
+    numRecords++;
+    if ((sectionId & EXIT_FLAG) == 0) {
+        CallNode *parent = depth > 0 ? stack[depth - 1].node : &root;
+        CallNode *node;
+
+        if (depth == MAX_DEPTH) {
+            numUnmatched++;
+            return 1;
+        }
+        node = childOf(parent, sectionId);
+        if (node == NULL || lookupSection(sectionId) == NULL) return 0;
+        stack[depth].node = node;
+        stack[depth].start = timer;
+        stack[depth].childTicks = 0;
+        depth++;
+    } else {
+        uint32 id = sectionId & ~EXIT_FLAG;
+        int    d;
+
+        for (d = depth - 1; d >= 0 && stack[d].node->id != id; d--);
+        if (d < 0) {
+            numUnmatched++;
+            return 1;
+        }
+        while (depth > d + 1) {
+            numUnmatched++;
+            if (!closeFrame(timer)) return 0;
+        }
+        if (!closeFrame(timer)) return 0;
+    }
+    return 1;
+}
+
+/* Function: decodeFile =======================================================
+ * Abstract:
+ *  Read all batches of the capture file. After a batch that reports dropped
+ *  records the open sections can no longer be matched and are discarded.
+ */
+static const char *decodeFile(FILE *fp)
+{
+    static uint32 records[2 * BATCH_RECORDS];
+    uint32        header[2];
+
+    while (fread(header, sizeof(uint32), 2, fp) == 2) {
+        uint32 remaining = toHost(header[0]);
+        uint32 dropped   = toHost(header[1]);
+
+        if (dropped > 0) {
+            numDropped += dropped;
+            if (depth > 0) {
+                numResyncs++;
+                depth = 0;
+            }
+        }
+        while (remaining > 0) {
+            uint32 n = remaining > BATCH_RECORDS ? BATCH_RECORDS : remaining;
+            uint32 i;
+            if (fread(records, 2 * sizeof(uint32), n, fp) != n) {
+                return "Capture file ends in the middle of a batch";
+            }
+            for (i = 0; i < n; i++) {
+                if (!processRecord(toHost(records[2 * i]),
+                                   toHost(records[2 * i + 1]))) {
+                    return "Out of memory";
+                }
+            }
+            remaining -= n;
+        }
+    }
+    return NULL;
+}
+
+#if defined(CODEINSTR_DECODE_RTIOSTREAM)
+/* Function: recordStream =====================================================
+ * Abstract:
+ *  Connect to the target and copy the received stream to the capture file
+ *  until it has been idle for RECORD_IDLE_SECS seconds. A client stream
+ *  does not report that the target closed the connection, so idleness is
+ *  the end of the capture. The batches are self-delimiting, so no framing
+ *  is added.
+ */
+static const char *recordStream(FILE *fp, int openArgc, void *openArgv[])
+{
+    static unsigned char buf[65536];
+    unsigned long total = 0;
+    time_t lastData = time(NULL);
+    int streamID = rtIOStreamOpen(openArgc, openArgv);
+
+    if (streamID == RTIOSTREAM_ERROR) {
+        return "rtIOStreamOpen failed";
+    }
+    while (difftime(time(NULL), lastData) < RECORD_IDLE_SECS) {
+        size_t sizeRecvd;
+        if (rtIOStreamRecv(streamID, buf, sizeof(buf), &sizeRecvd) ==
+            RTIOSTREAM_ERROR) {
+            break;
+        }
+        if (sizeRecvd == 0) continue;
+        if (fwrite(buf, 1, sizeRecvd, fp) != sizeRecvd) {
+            rtIOStreamClose(streamID);
+            return "Unable to write capture file";
+        }
+        total += (unsigned long)sizeRecvd;
+        lastData = time(NULL);
+    }
+    rtIOStreamClose(streamID);
+    fprintf(stderr, "Recorded %lu bytes\n", total);
+    return NULL;
+}
+#endif
+
+static const char *readNames(const char *fileName)
+{
+    FILE *fp = fopen(fileName, "r");
+    char  line[MAX_NAME + 32];
+
+    if (fp == NULL) return "Unable to open names file";
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        unsigned int id;
+        char         name[MAX_NAME];
+        if (sscanf(line, "%u %127s", &id, name) == 2) {
+            SectionStats *s = lookupSection((uint32)id);
+            if (s == NULL) {
+                fclose(fp);
+                return "Out of memory";
+            }
+            strcpy(s->name, name);
+        }
+    }
+    fclose(fp);
+    return NULL;
+}
+
+static const char *nameOf(uint32 id)
+{
+    SectionStats *s = lookupSection(id);
+    return s != NULL ? s->name : "?";
+}
+
+/* Function: writeFolded ======================================================
+ * Abstract:
+ *  Depth first walk of the call tree writing "outer;...;inner self" lines.
+ *  Self times are written in timer ticks since flame graph tools expect
+ *  integer sample counts.
+ */
+static void writeFolded(FILE *fp, CallNode *node)
+{
+    CallNode *child;
+
+    if (node != &root && node->selfTotal > 0) {
+        CallNode *path[MAX_DEPTH];
+        int       n = 0;
+        CallNode *p;
+        for (p = node; p != &root; p = p->parent) path[n++] = p;
+        while (n-- > 0) {
+            fprintf(fp, "%s%c", nameOf(path[n]->id), n > 0 ? ';' : ' ');
+        }
+        fprintf(fp, "%.0f\n", node->selfTotal);
+    }
+    for (child = node->firstChild; child != NULL; child = child->nextSibling) {
+        writeFolded(fp, child);
+    }
+}
+
+static int compareSelfTime(const void *a, const void *b)
+{
+    double sa = ((const SectionStats *)a)->selfTotal;
+    double sb = ((const SectionStats *)b)->selfTotal;
+    return (sa < sb) - (sa > sb);
+}
+
+static void printReport(double tick)
+{
+    size_t i;
+
+    /* Compact the table; it is not used as a hash table after this */
+    size_t n = 0;
+    for (i = 0; i < statsCapacity; i++) {
+        if (stats[i].used && stats[i].calls > 0) stats[n++] = stats[i];
+    }
+    qsort(stats, n, sizeof(SectionStats), compareSelfTime);
+
+    printf("%lu records, %lu dropped on the target, %lu unmatched, "
+           "%lu resynchronizations\n\n",
+           numRecords, numDropped, numUnmatched, numResyncs);
+    printf("%-32s %10s %12s %12s %12s %14s %14s\n", "section", "calls",
+           "incl min", "incl mean", "incl max", "incl total", "self total");
+    for (i = 0; i < n; i++) {
+        SectionStats *s = &stats[i];
+        printf("%-32s %10lu %12.6g %12.6g %12.6g %14.8g %14.8g\n",
+               s->name, s->calls,
+               s->inclMin * tick, s->inclTotal / s->calls * tick,
+               s->inclMax * tick, s->inclTotal * tick, s->selfTotal * tick);
+    }
+}
+
+/***************** VISIBLE FUNCTIONS ******************************************/
+
+int main(int argc, char *argv[])
+{
+    const char *captureFile = NULL;
+    const char *namesFile   = NULL;
+    const char *foldedFile  = NULL;
+    const char *errorStr    = NULL;
+    double      tick        = 1.0;
+    FILE       *fp;
+    int         argIdx;
+#if defined(CODEINSTR_DECODE_RTIOSTREAM)
+    void       *openArgv[MAX_OPEN_ARGS];
+    int         openArgc = 0;
+    int         record   = 0;
+#endif
+
+    for (argIdx = 1; argIdx < argc; argIdx++) {
+#if defined(CODEINSTR_DECODE_RTIOSTREAM)
+        if (record) {
+            if (openArgc < MAX_OPEN_ARGS) openArgv[openArgc++] = argv[argIdx];
+            continue;
+        }
+        if (strcmp(argv[argIdx], "-record") == 0) {
+            openArgv[openArgc++] = (void *)"-client";
+            openArgv[openArgc++] = (void *)"1";
+            record = 1;
+            continue;
+        }
+#endif
+        if (strcmp(argv[argIdx], "-swap") == 0) {
+            swapBytes = 1;
+        } else if (argIdx + 1 < argc && strcmp(argv[argIdx], "-names") == 0) {
+            namesFile = argv[++argIdx];
+        } else if (argIdx + 1 < argc && strcmp(argv[argIdx], "-folded") == 0) {
+            foldedFile = argv[++argIdx];
+        } else if (argIdx + 1 < argc && strcmp(argv[argIdx], "-tick") == 0) {
+            tick = atof(argv[++argIdx]);
+        } else if (argv[argIdx][0] != '-' && captureFile == NULL) {
+            captureFile = argv[argIdx];
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[argIdx]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (captureFile == NULL || tick <= 0) {
+        fprintf(stderr, "Usage: %s <capture file> [-names <file>] "
+                "[-folded <file>] [-tick <seconds>] [-swap]"
+#if defined(CODEINSTR_DECODE_RTIOSTREAM)
+                " [-record <rtIOStreamOpen options>]"
+#endif
+                "\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (namesFile != NULL && (errorStr = readNames(namesFile)) != NULL) {
+        goto EXIT_POINT;
+    }
+
+#if defined(CODEINSTR_DECODE_RTIOSTREAM)
+    if (record) {
+        fp = fopen(captureFile, "wb");
+        if (fp == NULL) {
+            errorStr = "Unable to create capture file";
+            goto EXIT_POINT;
+        }
+        errorStr = recordStream(fp, openArgc, openArgv);
+        if (fclose(fp) != 0 && errorStr == NULL) {
+            errorStr = "Unable to write capture file";
+        }
+        if (errorStr != NULL) goto EXIT_POINT;
+    }
+#endif
+
+    fp = fopen(captureFile, "rb");
+    if (fp == NULL) {
+        errorStr = "Unable to open capture file";
+        goto EXIT_POINT;
+    }
+    errorStr = decodeFile(fp);
+    fclose(fp);
+    if (errorStr != NULL) goto EXIT_POINT;
+
+    if (foldedFile != NULL) {
+        fp = fopen(foldedFile, "w");
+        if (fp == NULL) {
+            errorStr = "Unable to open folded stacks file";
+            goto EXIT_POINT;
+        }
+        writeFolded(fp, &root);
+        fclose(fp);
+    }
+    if (statsCapacity > 0) printReport(tick);
+
+  EXIT_POINT:
+    if (errorStr != NULL) {
+        fprintf(stderr, "%s\n", errorStr);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/* EOF - codeinstr_decode.c */
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2017 The MathWorks, Inc.
+ *
+ * File: memunit_xform_bench.c
+ *
+ * Abstract:
+ *  Standalone microbenchmark for the memory unit transformer kernels in
+ *  MemUnitTransformerKernels.h. For every memory unit type and each of the
+ *  copy, byte swap, widen and narrow transforms, the benchmark converts a
+ *  buffer element by element (as memUnitXformer_DoXform does for each
+ *  element) and with the bulk kernel, checks that both produce the same
+ *  bytes and reports the throughput of each.
+ *
+ *  Build on Linux with, e.g.:
+ *
+ *    gcc -O2 -mssse3 -o memunit_xform_bench memunit_xform_bench.c
+ *        -I<matlabroot>/extern/include
+ *        -I<matlabroot>/extern/include/coder/connectivity/memunit
+ *
+ *  Usage:
+ *
+ *    memunit_xform_bench [-elements <n>] [-reps <n>] [-memunit <bytes>]
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tmwtypes.h"
+#include "MemUnitTransformerKernels.h"
+
+/***************** DEFINES ****************************************************/
+
+#define DEFAULT_ELEMENTS  65536
+#define DEFAULT_REPS      200
+#define DEFAULT_MEMUNIT   2
+
+/***************** LOCAL DATA *************************************************/
+
+static const char *typeNames[MEM_UNIT_NUM_TYPES] = {
+    "boolean", "uint8", "uint16", "uint32", "uint64",
+    "int8", "int16", "int32", "int64", "single", "double"
+};
+
+static const char *kindNames[] = { "copy", "swap", "widen", "narrow" };
+
+/***************** LOCAL FUNCTIONS ********************************************/
+
+static double NowSecs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Function: ConvertElementwise ===============================================
+ * Abstract:
+ *  Reference conversion, one element at a time through the generic kernels.
+ */
+static void ConvertElementwise(const memUnitXformKernel_T *pKernel,
+                               void *in, void *out, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i++) {
+        memUnitXformKernel_T k = *pKernel;
+        if (k.kind == MEM_UNIT_XFORM_KERNEL_SWAP) {
+            /* per element swap, as done without the bulk kernels */
+            uint8_T *pIn  = (uint8_T*)in;
+            uint8_T *pOut = (uint8_T*)out;
+            uint8_T j;
+            for (j = 0; j < k.typeSize; j++) {
+                pOut[j] = pIn[k.typeSize - 1 - j];
+            }
+            in  = pIn + k.typeSize;
+            out = pOut + k.typeSize;
+        } else {
+            memUnitXformKernel_Run(&k, &in, &out, 1);
+        }
+    }
+}
+
+/* Function: Bench ============================================================
+ * Abstract:
+ *  Times the element by element and bulk conversion of one kernel and
+ *  returns 0 if the outputs differ.
+ */
+static int Bench(const memUnitXformKernel_T *pKernel, mem_unit_type_T typeId,
+                 uint8_T *src, uint8_T *dst1, uint8_T *dst2,
+                 size_t n, int reps)
+{
+    size_t inSize  = (pKernel->kind == MEM_UNIT_XFORM_KERNEL_NARROW) ?
+        pKernel->tgtSize : pKernel->typeSize;
+    size_t outSize = (pKernel->kind == MEM_UNIT_XFORM_KERNEL_WIDEN) ?
+        pKernel->tgtSize : pKernel->typeSize;
+    double t0, tElem, tBulk;
+    int r;
+
+    t0 = NowSecs();
+    for (r = 0; r < reps; r++) {
+        ConvertElementwise(pKernel, src, dst1, n);
+    }
+    tElem = NowSecs() - t0;
+
+    t0 = NowSecs();
+    for (r = 0; r < reps; r++) {
+        void *in = src;
+        void *out = dst2;
+        memUnitXformKernel_Run(pKernel, &in, &out, n);
+    }
+    tBulk = NowSecs() - t0;
+
+    printf("%-8s %-7s %6.0f MB/s %6.0f MB/s %6.1fx\n",
+           typeNames[typeId], kindNames[pKernel->kind],
+           (double)(n * inSize) * reps / tElem / 1e6,
+           (double)(n * inSize) * reps / tBulk / 1e6,
+           tElem / tBulk);
+
+    if (memcmp(dst1, dst2, n * outSize) != 0) {
+        printf("  ERROR: bulk and element by element results differ\n");
+        return 0;
+    }
+    return 1;
+}
+
+/***************** VISIBLE FUNCTIONS ******************************************/
+
+int main(int argc, char *argv[])
+{
+    size_t   n       = DEFAULT_ELEMENTS;
+    int      reps    = DEFAULT_REPS;
+    uint_T   memUnit = DEFAULT_MEMUNIT;
+    uint8_T *src;
+    uint8_T *dst1;
+    uint8_T *dst2;
+    size_t   i;
+    int      argIdx;
+    int      ok = 1;
+    int      t;
+
+    for (argIdx = 1; argIdx + 1 < argc; argIdx += 2) {
+        if (strcmp(argv[argIdx], "-elements") == 0) {
+            n = (size_t)strtoul(argv[argIdx + 1], NULL, 10);
+        } else if (strcmp(argv[argIdx], "-reps") == 0) {
+            reps = atoi(argv[argIdx + 1]);
+        } else if (strcmp(argv[argIdx], "-memunit") == 0) {
+            memUnit = (uint_T)atoi(argv[argIdx + 1]);
+        } else {
+            printf("Unknown option %s\n", argv[argIdx]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((n == 0) || (reps <= 0) || (memUnit == 0) || (memUnit > 8)) {
+        printf("Invalid options\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Large enough for n elements of the widest type or memory unit */
+    src  = (uint8_T*)malloc(n * 8);
+    dst1 = (uint8_T*)malloc(n * 8);
+    dst2 = (uint8_T*)malloc(n * 8);
+    if ((src == NULL) || (dst1 == NULL) || (dst2 == NULL)) {
+        printf("Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (i = 0; i < n * 8; i++) {
+        src[i] = (uint8_T)(i * 131 + 7);
+    }
+
+    printf("%lu elements, %d repetitions, %u byte memory unit\n",
+           (unsigned long)n, reps, memUnit);
+    printf("%-8s %-7s %11s %11s %7s\n",
+           "type", "xform", "per-elem", "bulk", "speedup");
+
+    for (t = 0; t < MEM_UNIT_NUM_TYPES; t++) {
+        memUnitXformKernel_T kernel;
+        const mem_unit_type_T typeId = (mem_unit_type_T)t;
+
+        /* same layout, different byte order, then word size change */
+        memUnitXformKernel_Select(&kernel, typeId, 0, 1, 0);
+        ok &= Bench(&kernel, typeId, src, dst1, dst2, n, reps);
+        memUnitXformKernel_Select(&kernel, typeId, 0, 1, 1);
+        if (kernel.kind == MEM_UNIT_XFORM_KERNEL_SWAP) {
+            ok &= Bench(&kernel, typeId, src, dst1, dst2, n, reps);
+        }
+        if (memUnitXformKernel_TypeSize(typeId) < memUnit) {
+            memUnitXformKernel_Select(&kernel, typeId, 0, memUnit, 1);
+            ok &= Bench(&kernel, typeId, src, dst1, dst2, n, reps);
+            memUnitXformKernel_Select(&kernel, typeId, 1, memUnit, 1);
+            ok &= Bench(&kernel, typeId, src, dst1, dst2, n, reps);
+        }
+    }
+
+    free(src);
+    free(dst1);
+    free(dst2);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* EOF - memunit_xform_bench.c */
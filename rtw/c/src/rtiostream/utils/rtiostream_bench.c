@@ -0,0 +1,453 @@
+/*
+ * Copyright 2017 The MathWorks, Inc.
+ *
+ * File: rtiostream_bench.c
+ *
+ * Abstract:
+ *  Standalone host driver that characterizes a target services link before
+ *  it is used for signal streaming. The driver connects to the target comm
+ *  service through the TCP/IP rtIOStream and runs:
+ *
+ *   o a round-trip series of timestamped echo messages for each payload
+ *     size, reporting minimum, median, 90th, 99th percentile and maximum
+ *     latency;
+ *   o a sustained throughput test in each direction for each payload size,
+ *     using the comm service IN_TEST (target to host) and OUT_TEST (host to
+ *     target) message floods.
+ *
+ *  Messages are sent as the 4 byte target services header (payload size,
+ *  application id, application function) followed by the payload. The
+ *  payload size is little-endian, as on the supported targets.
+ *
+ *  Build on Linux with, e.g.:
+ *
+ *    gcc -O2 -o rtiostream_bench rtiostream_bench.c
+ *        ../rtiostreamtcpip/rtiostream_tcpip.c
+ *        -I.. -I../.. -I<matlabroot>/extern/include -lm
+ *
+ *  Usage:
+ *
+ *    rtiostream_bench -hostname <target> -port <port>
+ *                     [-pings <n>] [-count <n>] [-sizes <s1,s2,...>]
+ *                     [-timeout <secs>]
+ *
+ *  All options other than -pings, -count, -sizes and -timeout are passed to
+ *  rtIOStreamOpen, which is called with -client 1.
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rtiostream.h"
+#include "tmwtypes.h"
+
+/***************** DEFINES ****************************************************/
+
+#define HEADER_SIZE          4
+#define MAX_PAYLOAD          2032
+#define MAX_SIZES            16
+#define MAX_ARGS             64
+
+#define DEFAULT_PINGS        1000
+#define DEFAULT_COUNT        1000
+#define DEFAULT_TIMEOUT_SECS 10
+#define DEFAULT_SIZES        "16,64,256,1024,2032"
+
+/* Comm service application id and message ids (see MessageDictionary.hpp) */
+#define COMM_SERVICE_ID           0xFF
+#define CONNECT_MSG_ID            3
+#define CONNECT_RESPONSE_MSG_ID   4
+#define IN_TEST_START_MSG_ID      7
+#define TEST_DATA_MSG_ID          8
+#define OUT_TEST_START_MSG_ID     9
+#define OUT_TEST_RESULT_MSG_ID    10
+#define TEST_CONCLUDED_MSG_ID     11
+#define ECHO_MSG_ID               12
+#define ECHO_RESPONSE_MSG_ID      13
+
+/* EchoMsg carries a sequence number, padding and a timestamp */
+#define ECHO_MIN_PAYLOAD     16
+
+#define MIN(a,b) ((a) < (b) ? (a) : (b))
+
+/***************** LOCAL DATA *************************************************/
+
+static int    streamID;
+static double recvTimeout = DEFAULT_TIMEOUT_SECS;
+static uint8_T txBuffer[HEADER_SIZE + MAX_PAYLOAD];
+static uint8_T rxBuffer[HEADER_SIZE + MAX_PAYLOAD];
+
+/***************** LOCAL FUNCTIONS ********************************************/
+
+/* Function: nowSeconds =======================================================
+ * Abstract:
+ *  Monotonic time in seconds.
+ */
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1.0e-9 * (double)ts.tv_nsec;
+}
+
+/* Function: sendAll ==========================================================
+ * Abstract:
+ *  Send size bytes, retrying until the stream has accepted all of them.
+ */
+static int sendAll(const uint8_T *src, size_t size)
+{
+    double deadline = nowSeconds() + recvTimeout;
+    while (size > 0) {
+        size_t sizeSent;
+        int errorStatus = rtIOStreamSend(streamID, src, size, &sizeSent);
+        if (errorStatus == RTIOSTREAM_ERROR) return RTIOSTREAM_ERROR;
+        if (sizeSent == 0 && nowSeconds() > deadline) {
+            fprintf(stderr, "Timed out sending to the target\n");
+            return RTIOSTREAM_ERROR;
+        }
+        src  += sizeSent;
+        size -= sizeSent;
+    }
+    return RTIOSTREAM_NO_ERROR;
+}
+
+/* Function: recvAll ==========================================================
+ * Abstract:
+ *  Receive exactly size bytes or time out.
+ */
+static int recvAll(uint8_T *dst, size_t size)
+{
+    double deadline = nowSeconds() + recvTimeout;
+    while (size > 0) {
+        size_t sizeRecvd;
+        int errorStatus = rtIOStreamRecv(streamID, dst, size, &sizeRecvd);
+        if (errorStatus == RTIOSTREAM_ERROR) return RTIOSTREAM_ERROR;
+        if (sizeRecvd == 0 && nowSeconds() > deadline) {
+            fprintf(stderr, "Timed out waiting for the target\n");
+            return RTIOSTREAM_ERROR;
+        }
+        dst  += sizeRecvd;
+        size -= sizeRecvd;
+    }
+    return RTIOSTREAM_NO_ERROR;
+}
+
+/* Function: sendMsg ==========================================================
+ * Abstract:
+ *  Send a comm service message. The payload is taken from txBuffer past the
+ *  header, where the caller has placed it.
+ */
+static int sendMsg(uint8_T appFun, uint16_T payloadSize)
+{
+    txBuffer[0] = (uint8_T)(payloadSize & 0xFF);
+    txBuffer[1] = (uint8_T)(payloadSize >> 8);
+    txBuffer[2] = COMM_SERVICE_ID;
+    txBuffer[3] = appFun;
+    return sendAll(txBuffer, HEADER_SIZE + payloadSize);
+}
+
+/* Function: recvMsg ==========================================================
+ * Abstract:
+ *  Receive the next comm service message into rxBuffer. Messages for other
+ *  applications are discarded.
+ */
+static int recvMsg(uint8_T *appFun, uint16_T *payloadSize)
+{
+    for (;;) {
+        uint16_T size;
+        if (recvAll(rxBuffer, HEADER_SIZE) != RTIOSTREAM_NO_ERROR) {
+            return RTIOSTREAM_ERROR;
+        }
+        size = (uint16_T)(rxBuffer[0] | (rxBuffer[1] << 8));
+        if (size > MAX_PAYLOAD) {
+            fprintf(stderr, "Invalid message size %u from the target\n",
+                    (unsigned)size);
+            return RTIOSTREAM_ERROR;
+        }
+        if (recvAll(rxBuffer + HEADER_SIZE, size) != RTIOSTREAM_NO_ERROR) {
+            return RTIOSTREAM_ERROR;
+        }
+        if (rxBuffer[2] == COMM_SERVICE_ID) {
+            *appFun      = rxBuffer[3];
+            *payloadSize = size;
+            return RTIOSTREAM_NO_ERROR;
+        }
+    }
+}
+
+/* Function: putTestStart =====================================================
+ * Abstract:
+ *  Payload of InTestStartMsg / OutTestStartMsg: message count followed by
+ *  message size, in host byte order like the target's struct layout.
+ */
+static uint16_T putTestStart(uint32_T count, uint16_T size)
+{
+    memcpy(txBuffer + HEADER_SIZE, &count, sizeof(count));
+    memcpy(txBuffer + HEADER_SIZE + sizeof(count), &size, sizeof(size));
+    return (uint16_T)(sizeof(count) + sizeof(size));
+}
+
+static int compareDoubles(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+/* Function: percentile =======================================================
+ * Abstract:
+ *  Nearest-rank percentile of a sorted series.
+ */
+static double percentile(const double *sorted, size_t n, double p)
+{
+    size_t idx = (size_t)(p * (double)(n - 1) + 0.5);
+    return sorted[MIN(idx, n - 1)];
+}
+
+/* Function: connectTarget ====================================================
+ * Abstract:
+ *  Connect handshake. Returns the largest payload the target accepts, or 0
+ *  on error.
+ */
+static uint16_T connectTarget(void)
+{
+    uint8_T  appFun;
+    uint16_T size;
+
+    if (sendMsg(CONNECT_MSG_ID, 0) != RTIOSTREAM_NO_ERROR) return 0;
+    do {
+        if (recvMsg(&appFun, &size) != RTIOSTREAM_NO_ERROR) return 0;
+    } while (appFun != CONNECT_RESPONSE_MSG_ID);
+
+    if (size < sizeof(uint16_T)) return 0;
+    return (uint16_T)(rxBuffer[HEADER_SIZE] | (rxBuffer[HEADER_SIZE+1] << 8));
+}
+
+/* Function: runEchoSeries ====================================================
+ * Abstract:
+ *  Round trip latency of nPings echo messages with the given payload size.
+ */
+static int runEchoSeries(uint16_T size, size_t nPings, double *rtt)
+{
+    size_t i;
+    double sum = 0.0;
+
+    memset(txBuffer + HEADER_SIZE, 0, size);
+    for (i = 0; i < nPings; i++) {
+        uint32_T sequence = (uint32_T)i;
+        double   t0 = nowSeconds();
+        uint8_T  appFun;
+        uint16_T rxSize;
+
+        memcpy(txBuffer + HEADER_SIZE, &sequence, sizeof(sequence));
+        memcpy(txBuffer + HEADER_SIZE + 8, &t0, sizeof(t0));
+        if (sendMsg(ECHO_MSG_ID, size) != RTIOSTREAM_NO_ERROR) return 1;
+        do {
+            if (recvMsg(&appFun, &rxSize) != RTIOSTREAM_NO_ERROR) return 1;
+        } while (appFun != ECHO_RESPONSE_MSG_ID ||
+                 memcmp(rxBuffer + HEADER_SIZE, &sequence, sizeof(sequence)));
+
+        memcpy(&t0, rxBuffer + HEADER_SIZE + 8, sizeof(t0));
+        rtt[i] = nowSeconds() - t0;
+        sum   += rtt[i];
+    }
+
+    qsort(rtt, nPings, sizeof(double), compareDoubles);
+    printf("%8u  %9.1f  %9.1f  %9.1f  %9.1f  %9.1f  %9.1f\n",
+           (unsigned)size,
+           1.0e6 * rtt[0],
+           1.0e6 * percentile(rtt, nPings, 0.50),
+           1.0e6 * percentile(rtt, nPings, 0.90),
+           1.0e6 * percentile(rtt, nPings, 0.99),
+           1.0e6 * rtt[nPings-1],
+           1.0e6 * sum / (double)nPings);
+    return 0;
+}
+
+/* Function: runInTest ========================================================
+ * Abstract:
+ *  Target to host flood of count messages. Returns elapsed seconds, or a
+ *  negative value on error.
+ */
+static double runInTest(uint16_T size, uint32_T count)
+{
+    uint32_T received = 0;
+    double   t0 = nowSeconds();
+    uint8_T  appFun;
+    uint16_T rxSize;
+
+    if (sendMsg(IN_TEST_START_MSG_ID, putTestStart(count, size)) !=
+        RTIOSTREAM_NO_ERROR) {
+        return -1.0;
+    }
+    for (;;) {
+        if (recvMsg(&appFun, &rxSize) != RTIOSTREAM_NO_ERROR) return -1.0;
+        if (appFun == TEST_DATA_MSG_ID && rxSize == size) {
+            received++;
+        } else if (appFun == TEST_CONCLUDED_MSG_ID) {
+            break;
+        }
+    }
+    if (received != count) {
+        fprintf(stderr, "IN_TEST: received %u of %u messages\n",
+                (unsigned)received, (unsigned)count);
+        return -1.0;
+    }
+    return nowSeconds() - t0;
+}
+
+/* Function: runOutTest =======================================================
+ * Abstract:
+ *  Host to target flood of count messages, acknowledged by the target's
+ *  test result. Returns elapsed seconds, or a negative value on error.
+ */
+static double runOutTest(uint16_T size, uint32_T count)
+{
+    uint32_T i;
+    double   t0 = nowSeconds();
+    uint8_T  appFun;
+    uint16_T rxSize;
+
+    if (sendMsg(OUT_TEST_START_MSG_ID, putTestStart(count, size)) !=
+        RTIOSTREAM_NO_ERROR) {
+        return -1.0;
+    }
+    memset(txBuffer + HEADER_SIZE, 0xA5, size);
+    for (i = 0; i < count; i++) {
+        if (sendMsg(TEST_DATA_MSG_ID, size) != RTIOSTREAM_NO_ERROR) {
+            return -1.0;
+        }
+    }
+    txBuffer[HEADER_SIZE] = 0;
+    if (sendMsg(TEST_CONCLUDED_MSG_ID, 1) != RTIOSTREAM_NO_ERROR) return -1.0;
+
+    do {
+        if (recvMsg(&appFun, &rxSize) != RTIOSTREAM_NO_ERROR) return -1.0;
+    } while (appFun != OUT_TEST_RESULT_MSG_ID);
+
+    if (rxBuffer[HEADER_SIZE] != 0) {
+        fprintf(stderr, "OUT_TEST: target did not receive all messages\n");
+        return -1.0;
+    }
+    return nowSeconds() - t0;
+}
+
+/* Function: parseSizes =======================================================
+ * Abstract:
+ *  Parse a comma separated list of payload sizes.
+ */
+static size_t parseSizes(const char *list, uint16_T *sizes)
+{
+    size_t n = 0;
+    const char *p = list;
+    while (*p != '\0' && n < MAX_SIZES) {
+        char *next;
+        long v = strtol(p, &next, 10);
+        if (next == p || v <= 0 || v > MAX_PAYLOAD) return 0;
+        sizes[n++] = (uint16_T)v;
+        p = (*next == ',') ? next + 1 : next;
+    }
+    return n;
+}
+
+int main(int argc, char *argv[])
+{
+    void     *openArgv[MAX_ARGS];
+    int       openArgc = 0;
+    size_t    nPings = DEFAULT_PINGS;
+    uint32_T  count = DEFAULT_COUNT;
+    uint16_T  sizes[MAX_SIZES];
+    size_t    nSizes = parseSizes(DEFAULT_SIZES, sizes);
+    uint16_T  maxPayload;
+    double   *rtt = NULL;
+    int       retVal = EXIT_FAILURE;
+    size_t    i;
+    int       argIdx;
+
+    openArgv[openArgc++] = (void *)"-client";
+    openArgv[openArgc++] = (void *)"1";
+
+    for (argIdx = 1; argIdx < argc; argIdx++) {
+        const char *option = argv[argIdx];
+        const char *value  = (argIdx + 1 < argc) ? argv[argIdx + 1] : NULL;
+
+        if (strcmp(option, "-pings") == 0 && value != NULL) {
+            nPings = (size_t)strtoul(value, NULL, 10);
+            argIdx++;
+        } else if (strcmp(option, "-count") == 0 && value != NULL) {
+            count = (uint32_T)strtoul(value, NULL, 10);
+            argIdx++;
+        } else if (strcmp(option, "-sizes") == 0 && value != NULL) {
+            nSizes = parseSizes(value, sizes);
+            argIdx++;
+        } else if (strcmp(option, "-timeout") == 0 && value != NULL) {
+            recvTimeout = strtod(value, NULL);
+            argIdx++;
+        } else if (openArgc < MAX_ARGS) {
+            openArgv[openArgc++] = (void *)option;
+        }
+    }
+    if (nSizes == 0 || nPings == 0) {
+        fprintf(stderr, "Usage: %s -hostname <target> -port <port> "
+                "[-pings <n>] [-count <n>] [-sizes <s1,s2,...>] "
+                "[-timeout <secs>]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    streamID = rtIOStreamOpen(openArgc, openArgv);
+    if (streamID == RTIOSTREAM_ERROR) {
+        fprintf(stderr, "rtIOStreamOpen failed\n");
+        return EXIT_FAILURE;
+    }
+
+    maxPayload = connectTarget();
+    if (maxPayload == 0) {
+        fprintf(stderr, "Connect handshake with the target failed\n");
+        goto EXIT_POINT;
+    }
+    printf("Connected, maximum payload %u bytes\n\n", (unsigned)maxPayload);
+
+    rtt = (double *)malloc(nPings * sizeof(double));
+    if (rtt == NULL) goto EXIT_POINT;
+
+    printf("Round trip latency over %lu echoes (microseconds)\n",
+           (unsigned long)nPings);
+    printf("%8s  %9s  %9s  %9s  %9s  %9s  %9s\n",
+           "payload", "min", "p50", "p90", "p99", "max", "mean");
+    for (i = 0; i < nSizes; i++) {
+        uint16_T size = MIN(sizes[i], maxPayload);
+        if (size < ECHO_MIN_PAYLOAD) size = ECHO_MIN_PAYLOAD;
+        if (runEchoSeries(size, nPings, rtt)) goto EXIT_POINT;
+    }
+
+    printf("\nSustained throughput over %u messages\n", (unsigned)count);
+    printf("%8s  %12s  %12s  %12s  %12s\n",
+           "payload", "in msg/s", "in MB/s", "out msg/s", "out MB/s");
+    for (i = 0; i < nSizes; i++) {
+        uint16_T size = MIN(sizes[i], maxPayload);
+        double   tIn  = runInTest(size, count);
+        double   tOut;
+
+        if (tIn <= 0.0) goto EXIT_POINT;
+        tOut = runOutTest(size, count);
+        if (tOut <= 0.0) goto EXIT_POINT;
+
+        printf("%8u  %12.0f  %12.3f  %12.0f  %12.3f\n",
+               (unsigned)size,
+               count / tIn,  1.0e-6 * count * (HEADER_SIZE + size) / tIn,
+               count / tOut, 1.0e-6 * count * (HEADER_SIZE + size) / tOut);
+    }
+    retVal = EXIT_SUCCESS;
+
+  EXIT_POINT:
+    free(rtt);
+    rtIOStreamClose(streamID);
+    return retVal;
+}
+
+/* [EOF] rtiostream_bench.c */
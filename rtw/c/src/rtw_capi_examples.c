@@ -14,10 +14,48 @@
  * 
  *   The functions provided in this file are
  *       capi_PrintModelParameter - Prints a model parameter value to STDOUT
+ *       capi_PrepareParamTransaction, capi_CommitParamTransaction,
+ *       capi_RequestParamTransaction, capi_ApplyPendingParamTransaction,
+ *       capi_IsParamTransactionPending, capi_FreeParamTransaction
+ *                                - Update many parameters in one pass
  */
 
 #include "rtw_capi_examples.h"
 #include <stddef.h>
+#include <string.h>
+
+/* The isPending flag of a parameter transaction hands the prepared updates
+ * and their value buffers from the requesting thread to the model thread
+ * and back. Setting the flag must publish everything written before it and
+ * reading it must make those writes visible, which volatile alone does not
+ * guarantee. */
+#if defined(__GNUC__) || defined(__clang__)
+# define CAPI_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+# define CAPI_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#elif defined(_MSC_VER)
+# include <intrin.h>
+# define CAPI_STORE_RELEASE(p, v) \
+    ((void) _InterlockedExchange((volatile long *) (p), (long) (v)))
+# define CAPI_LOAD_ACQUIRE(p) \
+    ((int_T) _InterlockedCompareExchange((volatile long *) (p), 0L, 0L))
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && \
+      !defined(__STDC_NO_ATOMICS__)
+# include <stdatomic.h>
+# define CAPI_STORE_RELEASE(p, v) \
+    (atomic_thread_fence(memory_order_release), (void) (*(p) = (v)))
+# define CAPI_LOAD_ACQUIRE(p) \
+    capi_LoadAcquire(p)
+static int_T capi_LoadAcquire(volatile int_T* p) {
+    int_T value = *p;
+    atomic_thread_fence(memory_order_acquire);
+    return value;
+}
+#else
+/* No ordering primitives: only safe if the requesting thread and the model
+ * thread run on the same processor core. */
+# define CAPI_STORE_RELEASE(p, v) ((void) (*(p) = (v)))
+# define CAPI_LOAD_ACQUIRE(p)     (*(p))
+#endif
 
 /* Function capi_PrintModelParameter ======================================= */
 /* Abstract:
@@ -627,4 +665,220 @@ int_T capi_ModifyParameter(void                 *_param,
     return(1);
 }
 
+/* Function capi_PrepareParamTransaction =================================== */
+/* Abstract:
+ *   Resolves a list of parameter updates against the ModelMappingInfo
+ *   structure so that they can later be applied in one pass. The data type,
+ *   dimension and address maps are looked up once per update here rather
+ *   than on every apply.
+ *
+ *   capi_ModifyParameter copies element i of the new value to element i of
+ *   the parameter for every data type and orientation, i.e. the new value
+ *   has the same memory layout as the parameter. A prepared update is
+ *   therefore reduced to a destination address and a byte count, which
+ *   also covers data types capi_ModifyParameter does not handle.
+ *
+ *     txn        - Transaction to prepare. Any previous contents are freed.
+ *     capiMap    - Pointer to the ModelMappingInfo structure in Real-Time
+ *                  model. Map of all C-API arrays and structures.
+ *     updates    - Array of numUpdates parameter updates. The buffers the
+ *                  updates point to must stay valid until the transaction
+ *                  is committed or freed.
+ *     numUpdates - Number of elements in updates
+ *
+ *   All updates are validated before anything is recorded. Returns 1 on
+ *   success and 0 if any update is invalid, in which case the transaction
+ *   is left empty and no parameter is modified.
+ */
+int_T capi_PrepareParamTransaction(capi_ParamTransaction*    txn,
+                                   rtwCAPI_ModelMappingInfo* capiMap,
+                                   const capi_ParamUpdate*   updates,
+                                   uint_T                    numUpdates) {
+
+    const rtwCAPI_ModelParameters* modelParams;
+    const rtwCAPI_BlockParameters* blockParams;
+    const rtwCAPI_DataTypeMap*     dataTypeMap;
+    const rtwCAPI_DimensionMap*    dimMap;
+    const uint_T*                  dimArray;
+    void**                         dataAddrMap;
+    capi_PreparedUpdate*           prepared = NULL;
+
+    uint_T numModelParams;
+    uint_T numBlockParams;
+    uint_T i;
+
+    capi_FreeParamTransaction(txn);
+    if (numUpdates == 0) return 1;
+
+    /* Fetch the maps once for the whole transaction */
+    modelParams    = rtwCAPI_GetModelParameters(capiMap);
+    blockParams    = rtwCAPI_GetBlockParameters(capiMap);
+    numModelParams = (modelParams == NULL) ? 0 :
+        rtwCAPI_GetNumModelParameters(capiMap);
+    numBlockParams = (blockParams == NULL) ? 0 :
+        rtwCAPI_GetNumBlockParameters(capiMap);
+    dataTypeMap    = rtwCAPI_GetDataTypeMap(capiMap);
+    dimMap         = rtwCAPI_GetDimensionMap(capiMap);
+    dimArray       = rtwCAPI_GetDimensionArray(capiMap);
+    dataAddrMap    = rtwCAPI_GetDataAddressMap(capiMap);
+
+    if ((dataTypeMap == NULL) || (dimMap == NULL) || (dimArray == NULL) ||
+        (dataAddrMap == NULL)) {
+        printf("Parameter transaction: C-API maps are not available\n");
+        return 0;
+    }
+
+    prepared = (capi_PreparedUpdate *)
+        malloc(numUpdates*sizeof(capi_PreparedUpdate));
+    if (prepared == NULL) {
+        printf("Parameter transaction: memory allocation error\n");
+        return 0;
+    }
+
+    for (i = 0; i < numUpdates; i++) {
+        const capi_ParamUpdate* update = &updates[i];
+        uint_T    paramIdx = update->paramIdx;
+        uint_T    addrIdx;
+        uint16_T  dataTypeIdx;
+        uint16_T  dimIndex;
+        uint8_T   numDims;
+        uint_T    dimArrayIdx;
+        size_t    numElements = 1;
+        void*     paramAddress;
+        int       idx;
+
+        if (update->newParam == NULL) {
+            printf("Parameter transaction: update %u has no value\n", i);
+            goto FAIL;
+        }
+
+        if (paramIdx >= (update->isBlockParam ? numBlockParams :
+                                                numModelParams)) {
+            printf("Parameter transaction: update %u has invalid index %u\n",
+                   i, paramIdx);
+            goto FAIL;
+        }
+
+        if (update->isBlockParam) {
+            addrIdx     = rtwCAPI_GetBlockParameterAddrIdx(blockParams,
+                                                           paramIdx);
+            dataTypeIdx = rtwCAPI_GetBlockParameterDataTypeIdx(blockParams,
+                                                               paramIdx);
+            dimIndex    = rtwCAPI_GetBlockParameterDimensionIdx(blockParams,
+                                                                paramIdx);
+        } else {
+            addrIdx     = rtwCAPI_GetModelParameterAddrIdx(modelParams,
+                                                           paramIdx);
+            dataTypeIdx = rtwCAPI_GetModelParameterDataTypeIdx(modelParams,
+                                                               paramIdx);
+            dimIndex    = rtwCAPI_GetModelParameterDimensionIdx(modelParams,
+                                                                paramIdx);
+        }
+
+        numDims     = rtwCAPI_GetNumDims(dimMap, dimIndex);
+        dimArrayIdx = rtwCAPI_GetDimArrayIndex(dimMap, dimIndex);
+        for (idx = 0; idx < numDims; idx++) {
+            numElements *= dimArray[dimArrayIdx + idx];
+        }
+
+        paramAddress = (void *) rtwCAPI_GetDataAddress(dataAddrMap, addrIdx);
+        if ((paramAddress != NULL) &&
+            rtwCAPI_GetDataIsPointer(dataTypeMap, dataTypeIdx)) {
+            /* The address map holds a pointer to the data */
+            paramAddress = *((void **) paramAddress);
+        }
+        if (paramAddress == NULL) {
+            printf("Parameter transaction: update %u has no address\n", i);
+            goto FAIL;
+        }
+
+        prepared[i].dstAddr = paramAddress;
+        prepared[i].srcAddr = update->newParam;
+        prepared[i].nBytes  = numElements *
+            rtwCAPI_GetDataTypeSize(dataTypeMap, dataTypeIdx);
+    }
+
+    txn->updates    = prepared;
+    txn->numUpdates = numUpdates;
+    return 1;
+
+  FAIL:
+    free(prepared);
+    return 0;
+}
+
+/* Function capi_CommitParamTransaction ==================================== */
+/* Abstract:
+ *   Applies all updates of a prepared transaction, in the order they were
+ *   given to capi_PrepareParamTransaction. If several updates target the
+ *   same parameter the last one wins. The transaction stays prepared and
+ *   can be committed again, e.g. after the value buffers were refilled.
+ *
+ *   The caller is responsible for not running the model step while the
+ *   transaction is committed; use capi_RequestParamTransaction to have the
+ *   model thread apply it between steps instead.
+ */
+void capi_CommitParamTransaction(capi_ParamTransaction* txn) {
+    const capi_PreparedUpdate* update = txn->updates;
+    const capi_PreparedUpdate* end    = update + txn->numUpdates;
+
+    for (; update < end; update++) {
+        (void) memcpy(update->dstAddr, update->srcAddr, update->nBytes);
+    }
+}
+
+/* Function capi_RequestParamTransaction =================================== */
+/* Abstract:
+ *   Marks a prepared transaction to be applied at the next step boundary,
+ *   i.e. the next time the model thread calls
+ *   capi_ApplyPendingParamTransaction. The transaction and its value
+ *   buffers must not be modified until the request has been served, i.e.
+ *   until capi_IsParamTransactionPending returns 0.
+ */
+void capi_RequestParamTransaction(capi_ParamTransaction* txn) {
+    /* release: the model thread sees the updates and their values */
+    CAPI_STORE_RELEASE(&txn->isPending, 1);
+}
+
+/* Function capi_ApplyPendingParamTransaction ============================== */
+/* Abstract:
+ *   To be called by the model thread between two model steps. Commits the
+ *   transaction if it was requested with capi_RequestParamTransaction, so
+ *   that all parameters change together and no step sees a partial update.
+ *   Returns 1 if the transaction was applied and 0 otherwise.
+ */
+int_T capi_ApplyPendingParamTransaction(capi_ParamTransaction* txn) {
+    /* acquire: the writes made before the request are visible */
+    if (!CAPI_LOAD_ACQUIRE(&txn->isPending)) return 0;
+
+    capi_CommitParamTransaction(txn);
+    /* release: the requester may reuse the value buffers once it sees 0 */
+    CAPI_STORE_RELEASE(&txn->isPending, 0);
+    return 1;
+}
+
+/* Function capi_IsParamTransactionPending ================================= */
+/* Abstract:
+ *   Returns 1 while a transaction requested with
+ *   capi_RequestParamTransaction has not yet been applied by the model
+ *   thread and 0 once it has, after which the requesting thread may modify
+ *   the transaction and its value buffers again.
+ */
+int_T capi_IsParamTransactionPending(capi_ParamTransaction* txn) {
+    return CAPI_LOAD_ACQUIRE(&txn->isPending) ? 1 : 0;
+}
+
+/* Function capi_FreeParamTransaction ====================================== */
+/* Abstract:
+ *   Releases the memory held by a transaction and leaves it empty. An empty
+ *   transaction is all zeros, so a zero-initialized capi_ParamTransaction
+ *   can be passed to capi_PrepareParamTransaction directly.
+ */
+void capi_FreeParamTransaction(capi_ParamTransaction* txn) {
+    free(txn->updates);
+    txn->updates    = NULL;
+    txn->numUpdates = 0;
+    txn->isPending  = 0;
+}
+
 /* EOF - rtw_capi_examples.c */
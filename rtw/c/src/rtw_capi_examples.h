@@ -14,6 +14,10 @@
  * 
  *   The functions provided in this file are
  *       capi_PrintModelParameter - Prints a model parameter value to STDOUT
+ *       capi_PrepareParamTransaction, capi_CommitParamTransaction,
+ *       capi_RequestParamTransaction, capi_ApplyPendingParamTransaction,
+ *       capi_IsParamTransactionPending, capi_FreeParamTransaction
+ *                                - Update many parameters in one pass
  */
 
 #ifndef __RTW_CAPI_EXAMPLES_H__
@@ -29,6 +33,30 @@
 extern "C" {
 #endif
 
+/* One requested parameter update: the parameter is identified by its index
+ * in rtModelParameters (or rtBlockParameters if isBlockParam is set) and
+ * newParam points to the new value, laid out exactly like the parameter. */
+typedef struct capi_ParamUpdate_tag {
+    uint_T      paramIdx;
+    boolean_T   isBlockParam;
+    const void* newParam;
+} capi_ParamUpdate;
+
+/* An update with its destination address and size already resolved */
+typedef struct capi_PreparedUpdate_tag {
+    void*       dstAddr;
+    const void* srcAddr;
+    size_t      nBytes;
+} capi_PreparedUpdate;
+
+typedef struct capi_ParamTransaction_tag {
+    capi_PreparedUpdate* updates;
+    uint_T               numUpdates;
+    volatile int_T       isPending;  /* apply at the next step boundary;
+                                        only accessed with release/acquire
+                                        ordering, see rtw_capi_examples.c */
+} capi_ParamTransaction;
+
 extern void capi_PrintModelParameter(rtwCAPI_ModelMappingInfo* capiMap,  
                                      uint_T                    paramIdx);
  
@@ -53,6 +81,21 @@ extern int_T capi_ModifyParameter(void                 *_param,
                                   uint8_T              slDataType,
                                   unsigned short       isComplex);
 
+extern int_T capi_PrepareParamTransaction(capi_ParamTransaction*    txn,
+                                          rtwCAPI_ModelMappingInfo* capiMap,
+                                          const capi_ParamUpdate*   updates,
+                                          uint_T                    numUpdates);
+
+extern void  capi_CommitParamTransaction(capi_ParamTransaction* txn);
+
+extern void  capi_RequestParamTransaction(capi_ParamTransaction* txn);
+
+extern int_T capi_ApplyPendingParamTransaction(capi_ParamTransaction* txn);
+
+extern int_T capi_IsParamTransactionPending(capi_ParamTransaction* txn);
+
+extern void  capi_FreeParamTransaction(capi_ParamTransaction* txn);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,412 @@
+/*
+ * Copyright 2004-2017 The MathWorks, Inc.
+ *
+ * File: rtw_capi_index.c
+ *
+ * Abstract:
+ *   Hashed name-to-index lookup over the RTW generated C-API structures.
+ *   See rtw_capi_index.h for the list of functions.
+ *
+ *   Each table is an open addressed (linear probing) hash table holding
+ *   entry indices into the static C-API arrays. No names are copied; the
+ *   keys are compared against the strings generated in <MODEL>_capi.c. The
+ *   table is sized to at least twice the number of entries so that probe
+ *   sequences stay short, and the full hash is kept per slot so that most
+ *   mismatches are rejected without a strcmp.
+ */
+
+#include <string.h>
+#include "rtw_capi_index.h"
+
+/* Logical definitions */
+#if (!defined(__cplusplus))
+#  ifndef false
+#   define false                       (0U)
+#  endif
+#  ifndef true
+#   define true                        (1U)
+#  endif
+#endif
+
+/* Kinds of C-API entries that can be looked up */
+typedef enum {
+    CAPI_INDEX_SIGNAL = 0,
+    CAPI_INDEX_BLOCK_PARAM,
+    CAPI_INDEX_MODEL_PARAM,
+    CAPI_INDEX_STATE
+} CAPIIndexKind;
+
+/* Lookup key. Unused fields are NULL (strings) or 0 (port) */
+typedef struct CAPIIndexKey_tag {
+    const char_T* path;
+    const char_T* name;
+    uint_T        port;
+} CAPIIndexKey;
+
+#define CAPI_INDEX_FNV_OFFSET (2166136261U)
+#define CAPI_INDEX_FNV_PRIME  (16777619U)
+
+static const char_T* rtwCAPI_indexMallocError = "Memory Allocation Error";
+
+/* Function: HashString ========================================================
+ * Abstract:
+ *   Continue an FNV-1a hash over a NUL terminated string, including the
+ *   terminator so that ("ab","c") and ("a","bc") hash differently. A NULL
+ *   string hashes like the empty string.
+ */
+static uint32_T HashString(uint32_T hash, const char_T* str)
+{
+    if (str != NULL) {
+        const unsigned char* s = (const unsigned char*) str;
+        while (*s != '\0') {
+            hash ^= (uint32_T) *s++;
+            hash *= CAPI_INDEX_FNV_PRIME;
+        }
+    }
+    hash *= CAPI_INDEX_FNV_PRIME;   /* terminator: hash ^= 0 */
+    return hash;
+} /* end HashString */
+
+/* Function: HashKey ===========================================================
+ * Abstract:
+ *   Hash all fields of a lookup key.
+ */
+static uint32_T HashKey(const CAPIIndexKey* key)
+{
+    uint32_T hash = CAPI_INDEX_FNV_OFFSET;
+
+    hash = HashString(hash, key->path);
+    hash = HashString(hash, key->name);
+    hash ^= (uint32_T) (key->port & 0xFFU);
+    hash *= CAPI_INDEX_FNV_PRIME;
+    hash ^= (uint32_T) ((key->port >> 8) & 0xFFU);
+    hash *= CAPI_INDEX_FNV_PRIME;
+    return hash;
+} /* end HashKey */
+
+/* Function: StringsEqual ======================================================
+ * Abstract:
+ *   strcmp that treats NULL as the empty string.
+ */
+static boolean_T StringsEqual(const char_T* a, const char_T* b)
+{
+    if (a == NULL) a = "";
+    if (b == NULL) b = "";
+    return (boolean_T) (strcmp(a, b) == 0);
+} /* end StringsEqual */
+
+/* Function: KeysEqual =========================================================
+ * Abstract:
+ *   Compare two lookup keys field by field.
+ */
+static boolean_T KeysEqual(const CAPIIndexKey* a, const CAPIIndexKey* b)
+{
+    return (boolean_T) (a->port == b->port &&
+                        StringsEqual(a->path, b->path) &&
+                        StringsEqual(a->name, b->name));
+} /* end KeysEqual */
+
+/* Function: GetTable ==========================================================
+ * Abstract:
+ *   Return the table of the index that holds entries of the given kind.
+ */
+static rtwCAPI_NameTable* GetTable(rtwCAPI_NameIndex* index,
+                                   CAPIIndexKind      kind)
+{
+    switch (kind) {
+      case CAPI_INDEX_SIGNAL:      return &index->signals;
+      case CAPI_INDEX_BLOCK_PARAM: return &index->blockParams;
+      case CAPI_INDEX_MODEL_PARAM: return &index->modelParams;
+      default:                     return &index->states;
+    }
+} /* end GetTable */
+
+/* Function: GetNumEntries =====================================================
+ * Abstract:
+ *   Number of entries of the given kind in the C-API map. Returns 0 if the
+ *   corresponding array was not generated.
+ */
+static uint_T GetNumEntries(const rtwCAPI_ModelMappingInfo* mmi,
+                            CAPIIndexKind                   kind)
+{
+    switch (kind) {
+      case CAPI_INDEX_SIGNAL:
+        return (rtwCAPI_GetSignals(mmi) == NULL) ? 0U :
+            rtwCAPI_GetNumSignals(mmi);
+      case CAPI_INDEX_BLOCK_PARAM:
+        return (rtwCAPI_GetBlockParameters(mmi) == NULL) ? 0U :
+            rtwCAPI_GetNumBlockParameters(mmi);
+      case CAPI_INDEX_MODEL_PARAM:
+        return (rtwCAPI_GetModelParameters(mmi) == NULL) ? 0U :
+            rtwCAPI_GetNumModelParameters(mmi);
+      default:
+        return (rtwCAPI_GetStates(mmi) == NULL) ? 0U :
+            rtwCAPI_GetNumStates(mmi);
+    }
+} /* end GetNumEntries */
+
+/* Function: GetEntryKey =======================================================
+ * Abstract:
+ *   Fill in the lookup key of entry i of the given kind.
+ */
+static void GetEntryKey(const rtwCAPI_ModelMappingInfo* mmi,
+                        CAPIIndexKind                   kind,
+                        uint_T                          i,
+                        CAPIIndexKey*                   key)
+{
+    key->path = NULL;
+    key->name = NULL;
+    key->port = 0U;
+
+    switch (kind) {
+      case CAPI_INDEX_SIGNAL: {
+          const rtwCAPI_Signals* signals = rtwCAPI_GetSignals(mmi);
+          key->path = rtwCAPI_GetSignalBlockPath(signals, i);
+          key->port = rtwCAPI_GetSignalPortNumber(signals, i);
+          break;
+      }
+      case CAPI_INDEX_BLOCK_PARAM: {
+          const rtwCAPI_BlockParameters* params =
+              rtwCAPI_GetBlockParameters(mmi);
+          key->path = rtwCAPI_GetBlockParameterBlockPath(params, i);
+          key->name = rtwCAPI_GetBlockParameterName(params, i);
+          break;
+      }
+      case CAPI_INDEX_MODEL_PARAM: {
+          const rtwCAPI_ModelParameters* params =
+              rtwCAPI_GetModelParameters(mmi);
+          key->name = rtwCAPI_GetModelParameterName(params, i);
+          break;
+      }
+      default: {
+          const rtwCAPI_States* states = rtwCAPI_GetStates(mmi);
+          key->path = rtwCAPI_GetStateBlockPath(states, i);
+          key->name = rtwCAPI_GetStateName(states, i);
+          break;
+      }
+    }
+} /* end GetEntryKey */
+
+/* Function: FreeTable =========================================================
+ * Abstract:
+ *   Release the slots of a table and mark it as not built.
+ */
+static void FreeTable(rtwCAPI_NameTable* table)
+{
+    utFree(table->slots);
+    utFree(table->hashes);
+    table->slots    = NULL;
+    table->hashes   = NULL;
+    table->mask     = 0U;
+    table->isBuilt  = false;
+    table->isLinear = false;
+} /* end FreeTable */
+
+/* Function: BuildTable ========================================================
+ * Abstract:
+ *   Hash all entries of the given kind. Entries are inserted in index order
+ *   and lookups stop at the first match, so duplicate keys resolve to the
+ *   lowest index. If memory cannot be allocated the table is marked for
+ *   linear lookups and the error is returned.
+ */
+static const char_T* BuildTable(rtwCAPI_NameIndex* index,
+                                CAPIIndexKind      kind)
+{
+    rtwCAPI_NameTable* table = GetTable(index, kind);
+    uint_T             nEntries = GetNumEntries(index->mmi, kind);
+    uint_T             nSlots = 2U;
+    uint_T             i;
+
+    if (table->isBuilt) return NULL;
+
+    while (nSlots < 2U * nEntries) {
+        if (nSlots > ((uint_T) -1) / 4U) goto MEMORY_ERROR;
+        nSlots <<= 1;
+    }
+
+    table->slots  = (uint_T*) utMalloc(nSlots * sizeof(uint_T));
+    table->hashes = (uint32_T*) utMalloc(nSlots * sizeof(uint32_T));
+    if (table->slots == NULL || table->hashes == NULL) goto MEMORY_ERROR;
+
+    (void) memset(table->slots, 0, nSlots * sizeof(uint_T));
+    table->mask = nSlots - 1U;
+
+    for (i = 0; i < nEntries; i++) {
+        CAPIIndexKey key;
+        uint32_T     hash;
+        uint_T       slot;
+
+        GetEntryKey(index->mmi, kind, i, &key);
+        hash = HashKey(&key);
+        slot = hash & table->mask;
+        while (table->slots[slot] != 0U) {
+            slot = (slot + 1U) & table->mask;
+        }
+        table->slots[slot]  = i + 1U;
+        table->hashes[slot] = hash;
+    }
+    table->isBuilt = true;
+    return NULL;
+
+  MEMORY_ERROR:
+    FreeTable(table);
+    table->isBuilt  = true;
+    table->isLinear = true;
+    return rtwCAPI_indexMallocError;
+} /* end BuildTable */
+
+/* Function: FindEntry =========================================================
+ * Abstract:
+ *   Return the lowest index of an entry of the given kind matching key, or
+ *   -1 if there is none. Builds the table on first use.
+ */
+static int_T FindEntry(rtwCAPI_NameIndex*  index,
+                       CAPIIndexKind       kind,
+                       const CAPIIndexKey* key)
+{
+    rtwCAPI_NameTable* table = GetTable(index, kind);
+    CAPIIndexKey       entryKey;
+
+    if (!table->isBuilt) (void) BuildTable(index, kind);
+
+    if (table->isLinear) {
+        uint_T nEntries = GetNumEntries(index->mmi, kind);
+        uint_T i;
+
+        for (i = 0; i < nEntries; i++) {
+            GetEntryKey(index->mmi, kind, i, &entryKey);
+            if (KeysEqual(key, &entryKey)) return (int_T) i;
+        }
+    } else {
+        uint32_T hash = HashKey(key);
+        uint_T   slot = hash & table->mask;
+
+        while (table->slots[slot] != 0U) {
+            if (table->hashes[slot] == hash) {
+                uint_T i = table->slots[slot] - 1U;
+
+                GetEntryKey(index->mmi, kind, i, &entryKey);
+                if (KeysEqual(key, &entryKey)) return (int_T) i;
+            }
+            slot = (slot + 1U) & table->mask;
+        }
+    }
+    return -1;
+} /* end FindEntry */
+
+
+/* Function rtwCAPI_InitNameIndex ========================================== */
+/* Abstract:
+ *   Attach an empty index to a ModelMappingInfo structure. No memory is
+ *   allocated until the index is queried or rtwCAPI_BuildNameIndex is
+ *   called.
+ *     index - Index to initialize
+ *     mmi   - Pointer to the ModelMappingInfo structure in Real-Time model.
+ *             The C-API arrays must not change while the index is in use.
+ */
+void rtwCAPI_InitNameIndex(rtwCAPI_NameIndex*              index,
+                           const rtwCAPI_ModelMappingInfo* mmi)
+{
+    (void) memset(index, 0, sizeof(rtwCAPI_NameIndex));
+    index->mmi = mmi;
+}
+
+/* Function rtwCAPI_BuildNameIndex ========================================= */
+/* Abstract:
+ *   Build every table of the index. Returns NULL on success or an error
+ *   message if memory could not be allocated; queries still work in that
+ *   case but fall back to linear scans.
+ */
+const char_T* rtwCAPI_BuildNameIndex(rtwCAPI_NameIndex* index)
+{
+    const char_T* errmsg = NULL;
+    int_T         kind;
+
+    for (kind = CAPI_INDEX_SIGNAL; kind <= CAPI_INDEX_STATE; kind++) {
+        const char_T* err = BuildTable(index, (CAPIIndexKind) kind);
+        if (err != NULL) errmsg = err;
+    }
+    return errmsg;
+}
+
+/* Function rtwCAPI_FreeNameIndex ========================================== */
+/* Abstract:
+ *   Release the memory held by the index. The index can be queried again
+ *   afterwards, in which case the tables are rebuilt.
+ */
+void rtwCAPI_FreeNameIndex(rtwCAPI_NameIndex* index)
+{
+    FreeTable(&index->signals);
+    FreeTable(&index->blockParams);
+    FreeTable(&index->modelParams);
+    FreeTable(&index->states);
+}
+
+/* Function rtwCAPI_FindSignal ============================================= */
+/* Abstract:
+ *   Index into rtBlockSignals of the signal driven by port portNumber
+ *   (starting at 0) of block blockPath, or -1 if there is none.
+ */
+int_T rtwCAPI_FindSignal(rtwCAPI_NameIndex* index,
+                         const char_T*      blockPath,
+                         uint16_T           portNumber)
+{
+    CAPIIndexKey key;
+
+    key.path = blockPath;
+    key.name = NULL;
+    key.port = portNumber;
+    return FindEntry(index, CAPI_INDEX_SIGNAL, &key);
+}
+
+/* Function rtwCAPI_FindBlockParameter ===================================== */
+/* Abstract:
+ *   Index into rtBlockParameters of parameter paramName of block blockPath,
+ *   or -1 if there is none.
+ */
+int_T rtwCAPI_FindBlockParameter(rtwCAPI_NameIndex* index,
+                                 const char_T*      blockPath,
+                                 const char_T*      paramName)
+{
+    CAPIIndexKey key;
+
+    key.path = blockPath;
+    key.name = paramName;
+    key.port = 0U;
+    return FindEntry(index, CAPI_INDEX_BLOCK_PARAM, &key);
+}
+
+/* Function rtwCAPI_FindModelParameter ===================================== */
+/* Abstract:
+ *   Index into rtModelParameters of workspace variable varName, or -1 if
+ *   there is none.
+ */
+int_T rtwCAPI_FindModelParameter(rtwCAPI_NameIndex* index,
+                                 const char_T*      varName)
+{
+    CAPIIndexKey key;
+
+    key.path = NULL;
+    key.name = varName;
+    key.port = 0U;
+    return FindEntry(index, CAPI_INDEX_MODEL_PARAM, &key);
+}
+
+/* Function rtwCAPI_FindState ============================================== */
+/* Abstract:
+ *   Index into rtBlockStates of state stateName of block blockPath, or -1
+ *   if there is none. A NULL stateName matches states without a name.
+ */
+int_T rtwCAPI_FindState(rtwCAPI_NameIndex* index,
+                        const char_T*      blockPath,
+                        const char_T*      stateName)
+{
+    CAPIIndexKey key;
+
+    key.path = blockPath;
+    key.name = stateName;
+    key.port = 0U;
+    return FindEntry(index, CAPI_INDEX_STATE, &key);
+}
+
+/* EOF - rtw_capi_index.c */
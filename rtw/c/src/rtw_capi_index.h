@@ -0,0 +1,86 @@
+/*
+ * Copyright 2004-2017 The MathWorks, Inc.
+ *
+ * File: rtw_capi_index.h
+ *
+ * Abstract:
+ *   Hashed name-to-index lookup over the RTW generated C-API structures.
+ *   The C-API structure types are provided in following 2 files.
+ *
+ *       matlabroot/rtw/c/src/rtw_capi.h & rtw_modelmap.h
+ *
+ *   The signals, block parameters, model parameters and states arrays in
+ *   <MODEL>_capi.c are only indexed by position. Resolving a block path or
+ *   variable name therefore means scanning every entry. The index below
+ *   hashes the names once and answers each query in constant time.
+ *
+ *   The functions provided in this file are
+ *       rtwCAPI_InitNameIndex       - Attach an (empty) index to a map
+ *       rtwCAPI_BuildNameIndex      - Build all tables up front (optional)
+ *       rtwCAPI_FreeNameIndex       - Release the memory held by the index
+ *       rtwCAPI_FindSignal          - blockPath + portNumber -> signal idx
+ *       rtwCAPI_FindBlockParameter  - blockPath + paramName  -> param idx
+ *       rtwCAPI_FindModelParameter  - varName                -> param idx
+ *       rtwCAPI_FindState           - blockPath + stateName  -> state idx
+ *
+ *   Each table is built the first time it is queried. The Find functions
+ *   return -1 if no entry matches; when several entries share a key the
+ *   lowest index is returned, as a linear scan would. Once built, the
+ *   index is read-only. Call rtwCAPI_BuildNameIndex before sharing an
+ *   index between threads so that no query has to build a table.
+ */
+
+#ifndef __RTW_CAPI_INDEX_H__
+# define __RTW_CAPI_INDEX_H__
+
+#include "rtw_modelmap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rtwCAPI_NameTable_tag {
+    uint_T*   slots;     /* entry index + 1 per slot, 0 if slot is empty   */
+    uint32_T* hashes;    /* hash of the key stored in the matching slot    */
+    uint_T    mask;      /* number of slots - 1 (slots is a power of 2)    */
+    boolean_T isBuilt;   /* table has been populated                       */
+    boolean_T isLinear;  /* allocation failed, fall back to linear scans   */
+} rtwCAPI_NameTable;
+
+typedef struct rtwCAPI_NameIndex_tag {
+    const rtwCAPI_ModelMappingInfo* mmi;
+    rtwCAPI_NameTable               signals;
+    rtwCAPI_NameTable               blockParams;
+    rtwCAPI_NameTable               modelParams;
+    rtwCAPI_NameTable               states;
+} rtwCAPI_NameIndex;
+
+extern void          rtwCAPI_InitNameIndex(rtwCAPI_NameIndex*              index,
+                                           const rtwCAPI_ModelMappingInfo* mmi);
+
+extern const char_T* rtwCAPI_BuildNameIndex(rtwCAPI_NameIndex* index);
+
+extern void          rtwCAPI_FreeNameIndex(rtwCAPI_NameIndex* index);
+
+extern int_T         rtwCAPI_FindSignal(rtwCAPI_NameIndex* index,
+                                        const char_T*      blockPath,
+                                        uint16_T           portNumber);
+
+extern int_T         rtwCAPI_FindBlockParameter(rtwCAPI_NameIndex* index,
+                                                const char_T*      blockPath,
+                                                const char_T*      paramName);
+
+extern int_T         rtwCAPI_FindModelParameter(rtwCAPI_NameIndex* index,
+                                                const char_T*      varName);
+
+extern int_T         rtwCAPI_FindState(rtwCAPI_NameIndex* index,
+                                       const char_T*      blockPath,
+                                       const char_T*      stateName);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/* EOF - rtw_capi_index.h */
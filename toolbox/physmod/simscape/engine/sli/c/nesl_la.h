@@ -2,10 +2,11 @@
  ** File: nesl_la.h
  ** Abstract: RTW Implementation of the Linear Algebra Service for deployed NE solver
  **
- ** Copyright 2007 The MathWorks, Inc.
+ ** Copyright 2007-2017 The MathWorks, Inc.
  *********************************************************************************************************************/
 
 #include "rt_matrixlib.h"
+#include <nesl_sd_type.h>
 #include <math.h>
 #include <string.h>
 
@@ -39,6 +40,58 @@
 # endif
 #endif
 
+/*
+ * Factorization reuse (modified Newton).
+ *
+ * By default every numeric call factorizes the Jacobian. With a maximum
+ * reuse count above zero, a numeric call instead keeps the last LU
+ * factorization while all of the following hold:
+ *   - the factorization has been reused fewer than mMaxReuse times;
+ *   - no Jacobian entry has moved by more than mJacobianTol relative to the
+ *     largest entry of the factorized Jacobian;
+ *   - each solve with the reused factors has reduced the residual norm to
+ *     at most mRateLimit times that of the previous solve, i.e. the
+ *     iteration still converges fast enough with stale factors.
+ * The factorization is thus reused across Newton iterations and steps.
+ * rtw_linalg_update_solver_stats marks the step boundary, so the first
+ * solve of a step is not compared with the converged residual of the
+ * previous one; without it that solve also triggers a refactorization. On
+ * fixed-cost targets reuse trades factorizations for extra iterations; the
+ * counters in the simulation data show where the balance lies.
+ *
+ * The policy and the counters belong to each McLinearAlgebraData, since
+ * this header is compiled into every translation unit that includes it.
+ * Every linear system starts with the policy given by the macros below;
+ * define them on the compiler command line to set it for the whole model,
+ * or call rtw_linalg_set_reuse_policy on a linear system at run time.
+ */
+#ifndef NESL_LA_MAX_REUSE
+#define NESL_LA_MAX_REUSE 0
+#endif
+
+#ifndef NESL_LA_JACOBIAN_TOL
+#define NESL_LA_JACOBIAN_TOL 0.1
+#endif
+
+#ifndef NESL_LA_RATE_LIMIT
+#define NESL_LA_RATE_LIMIT 0.5
+#endif
+
+typedef struct McLinearAlgebraReusePolicyTag
+{
+    size_t mMaxReuse;
+    real_T mJacobianTol;
+    real_T mRateLimit;
+} McLinearAlgebraReusePolicy;
+
+typedef struct McLinearAlgebraStatsTag
+{
+    size_t mNumNumericCalls;
+    size_t mNumFactorizations;
+    size_t mNumSolves;
+    size_t mNumSolvesAtStep;    /* mNumSolves at the last step boundary */
+} McLinearAlgebraStats;
+
 struct McLinearAlgebraDataTag
 {
     int32_T mNumRow;
@@ -48,8 +101,66 @@ struct McLinearAlgebraDataTag
     int32_T* mPivotIndices;
     PmAllocator* mAllocatorPtr;
     const PmSparsityPattern* mSparsityPatternPtr;
+    real_T* mAxFactored;        /* Jacobian values of the current mLU */
+    int32_T mNumNz;
+    boolean_T mIsFactored;
+    boolean_T mRefactor;        /* convergence too slow, do not reuse */
+    size_t mNumReuse;
+    real_T mLastResidualNorm;
+    boolean_T mStepStart;       /* no residual to compare with yet */
+    McLinearAlgebraReusePolicy mPolicy;
+    McLinearAlgebraStats mStats;
 };
 
+PMF_DEPLOY_STATIC void rtw_linalg_set_reuse_policy(McLinearAlgebraData* ne_la_data, size_t maxReuse, real_T jacobianTol, real_T rateLimit)
+{
+    ne_la_data->mPolicy.mMaxReuse = maxReuse;
+    ne_la_data->mPolicy.mJacobianTol = jacobianTol;
+    ne_la_data->mPolicy.mRateLimit = rateLimit;
+}
+
+/*
+ * Copy the counters of a linear system into the simulation data of its
+ * network. Call once per major step, after the step's last solve; the
+ * solves since the previous call make up the iterations of the step.
+ */
+PMF_DEPLOY_STATIC void rtw_linalg_update_solver_stats(McLinearAlgebraData* ne_la_data, NeslSimulationData* sd)
+{
+    McLinearAlgebraStats* stats = &ne_la_data->mStats;
+    NeslSimulationDataData* data = sd->mData;
+    size_t iterations = stats->mNumSolves - stats->mNumSolvesAtStep;
+
+    data->mNumSteps++;
+    data->mNumFactorizations = stats->mNumFactorizations;
+    data->mNumSolves = stats->mNumSolves;
+    data->mIterationsLastStep = iterations;
+    if (iterations > data->mMaxIterationsPerStep) {
+        data->mMaxIterationsPerStep = iterations;
+    }
+    stats->mNumSolvesAtStep = stats->mNumSolves;
+    ne_la_data->mStepStart = true;
+}
+
+PMF_DEPLOY_STATIC boolean_T rtw_linalg_can_reuse(const McLinearAlgebraData* ne_la_data, const real_T* Ax)
+{
+    const McLinearAlgebraReusePolicy* policy = &ne_la_data->mPolicy;
+    real_T maxEntry = 0.0;
+    real_T maxChange = 0.0;
+    int32_T i = 0;
+
+    if (!ne_la_data->mIsFactored || ne_la_data->mRefactor ||
+        ne_la_data->mNumReuse >= policy->mMaxReuse) {
+        return false;
+    }
+    for (i = 0; i < ne_la_data->mNumNz; i++) {
+        real_T entry = fabs(ne_la_data->mAxFactored[i]);
+        real_T change = fabs(Ax[i] - ne_la_data->mAxFactored[i]);
+        if (entry > maxEntry) maxEntry = entry;
+        if (change > maxChange) maxChange = change;
+    }
+    return (maxChange <= policy->mJacobianTol * maxEntry);
+}
+
 /* Populate full column major matrix from sparsity pattern. Memory is NOT allocated here */
 PMF_DEPLOY_STATIC void populate_full_matrix_from_sparsitypattern(real_T* A, const PmSparsityPattern* jacobian_pattern_ptr, const real_T* Ax, PmAllocator* allocatorPtr)
 {
@@ -101,6 +212,21 @@ PMF_DEPLOY_STATIC McLinearAlgebraData* rtw_linalg_create_data(PmAllocator* alloc
                                       sizeof(int32_T), 
                                       ((((int32_T) jacobian_pattern_ptr->mNumRow) < ne_la_data->mNumCol) ? 
                                        ne_la_data->mNumRow : ne_la_data->mNumCol));
+
+    ne_la_data->mNumNz = jacobian_pattern_ptr->mJc[ne_la_data->mNumCol];
+    ne_la_data->mAxFactored = (real_T*)
+        pm_allocator_alloc(ne_la_data->mAllocatorPtr,
+                           sizeof(real_T),
+                           (ne_la_data->mNumNz > 0) ? ne_la_data->mNumNz : 1);
+    ne_la_data->mIsFactored = false;
+    ne_la_data->mRefactor = false;
+    ne_la_data->mNumReuse = 0;
+    ne_la_data->mLastResidualNorm = 0.0;
+    ne_la_data->mStepStart = true;
+    ne_la_data->mPolicy.mMaxReuse = NESL_LA_MAX_REUSE;
+    ne_la_data->mPolicy.mJacobianTol = NESL_LA_JACOBIAN_TOL;
+    ne_la_data->mPolicy.mRateLimit = NESL_LA_RATE_LIMIT;
+    memset(&ne_la_data->mStats, 0, sizeof(McLinearAlgebraStats));
     return ne_la_data;
 }
 
@@ -113,12 +239,21 @@ PMF_DEPLOY_STATIC McLinearAlgebraStatus rtw_linalg_symbolic(McLinearAlgebraData*
 
 
 
-/* Perform the LU factorization */
+/* Perform the LU factorization, or keep the previous one (see above) */
 PMF_DEPLOY_STATIC McLinearAlgebraStatus rtw_linalg_numeric(McLinearAlgebraData* ne_la_data, const real_T* Ax)
 {
+    McLinearAlgebraStats* stats = &ne_la_data->mStats;
+    stats->mNumNumericCalls++;
+
+    if (rtw_linalg_can_reuse(ne_la_data, Ax)) {
+        ne_la_data->mNumReuse++;
+        return MC_LA_OK;
+    }
+
     populate_full_matrix_from_sparsitypattern(ne_la_data->mLU, ne_la_data->mSparsityPatternPtr, Ax, ne_la_data->mAllocatorPtr);
     rt_lu_real(ne_la_data->mLU, ne_la_data->mNumRow, ne_la_data->mPivotIndices);
-    UNUSED_PARAMETER(Ax);
+    stats->mNumFactorizations++;
+    ne_la_data->mIsFactored = false;
 
     /* Check for zeros on the main diagonal */
     {
@@ -134,6 +269,10 @@ PMF_DEPLOY_STATIC McLinearAlgebraStatus rtw_linalg_numeric(McLinearAlgebraData*
         }
     }
 
+    memcpy(ne_la_data->mAxFactored, Ax, ne_la_data->mNumNz*sizeof(real_T));
+    ne_la_data->mIsFactored = true;
+    ne_la_data->mRefactor = false;
+    ne_la_data->mNumReuse = 0;
     return MC_LA_OK;
 }
 
@@ -144,6 +283,27 @@ PMF_DEPLOY_STATIC McLinearAlgebraStatus rtw_linalg_solve(McLinearAlgebraData* ne
     rt_ForwardSubstitutionRR_Dbl(ne_la_data->mLU, B, ne_la_data->mLinvB, ne_la_data->mNumRow, 1, ne_la_data->mPivotIndices, true);
     rt_BackwardSubstitutionRR_Dbl(ne_la_data->mLU+((ne_la_data->mNumRow*ne_la_data->mNumRow)-1), ne_la_data->mLinvB+(ne_la_data->mNumRow-1), dy, ne_la_data->mNumRow, 1, false);
     UNUSED_PARAMETER(Ax);
+
+    {
+        const McLinearAlgebraReusePolicy* policy = &ne_la_data->mPolicy;
+        ne_la_data->mStats.mNumSolves++;
+
+        /* Convergence-rate check on the residual: with stale factors the
+         * residual must still shrink by mRateLimit per iteration */
+        if (policy->mMaxReuse > 0) {
+            real_T residualNorm = 0.0;
+            int32_T i = 0;
+            for (i = 0; i < ne_la_data->mNumRow; i++) {
+                if (fabs(B[i]) > residualNorm) residualNorm = fabs(B[i]);
+            }
+            if (ne_la_data->mNumReuse > 0 && !ne_la_data->mStepStart &&
+                residualNorm > policy->mRateLimit * ne_la_data->mLastResidualNorm) {
+                ne_la_data->mRefactor = true;
+            }
+            ne_la_data->mLastResidualNorm = residualNorm;
+            ne_la_data->mStepStart = false;
+        }
+    }
     return MC_LA_OK;
 } 
 
@@ -169,6 +329,9 @@ PMF_DEPLOY_STATIC void rtw_linalg_destroy_data(PmAllocator* allocatorPtr, McLine
     pm_allocator_free(ne_la_data->mAllocatorPtr, ne_la_data->mPivotIndices);
     ne_la_data->mPivotIndices = NULL;
 
+    pm_allocator_free(ne_la_data->mAllocatorPtr, ne_la_data->mAxFactored);
+    ne_la_data->mAxFactored = NULL;
+
     ne_la_data->mSparsityPatternPtr = NULL;
     pm_allocator_free(allocatorPtr, ne_la_data);
 }
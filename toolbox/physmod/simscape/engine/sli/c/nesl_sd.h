@@ -3,7 +3,7 @@
  ** Abstract:
  **   NeslSimulationData implementation for code generation
  **
- ** Copyright 2010-2014 The MathWorks, Inc.
+ ** Copyright 2010-2017 The MathWorks, Inc.
  ******************************************************************************/
 
 #ifndef __nesl_sd_h__
@@ -35,6 +35,16 @@ NESL_SIM_DATA_MACRO(LOCAL_SIM_DATA_FUNCTION)
 NESL_SIM_DATA_VECTOR_MACRO(LOCAL_SIM_DATA_FUNCTION)
 NESL_SIM_DATA_PATTERN_MACRO(LOCAL_SIM_DATA_FUNCTION)
 
+/* The solver counters are not part of the NeslSimulationData interface
+ * shared with the engine, so they are read through plain functions */
+#define LOCAL_SIM_DATA_STATS_FUNCTION(_name, _type)                     \
+    PMF_DEPLOY_STATIC _type nesl_sim_data_##_name(const NeslSimulationData *sd) \
+    {                                                                   \
+        return sd->mData->m##_name;                                     \
+    }
+
+NESL_SIM_DATA_STATS_MACRO(LOCAL_SIM_DATA_STATS_FUNCTION)
+
 PMF_DEPLOY_STATIC void local_sim_data_destroy(NeslSimulationData *sd)
 {
     PmAllocator *a = pm_default_allocator();
@@ -3,7 +3,7 @@
  ** Abstract:
  **   NeslSimulationData data type for code generation
  ** 
- ** Copyright 2013 The MathWorks, Inc.
+ ** Copyright 2013-2017 The MathWorks, Inc.
  ******************************************************************************/
 
 #ifndef __nesl_sd_type_h__
@@ -40,6 +40,16 @@
     _X( LinJacobianPattern , PmSparsityPattern )        \
     _X( SolJacobianPattern , PmSparsityPattern )        \
 
+/* Linear solver counters, updated once per major step by
+ * rtw_linalg_update_solver_stats (nesl_la.h). An iteration is a linear
+ * solve. */
+#define NESL_SIM_DATA_STATS_MACRO(_X)                   \
+    _X( NumSteps,             size_t )                  \
+    _X( NumFactorizations,    size_t )                  \
+    _X( NumSolves,            size_t )                  \
+    _X( IterationsLastStep,   size_t )                  \
+    _X( MaxIterationsPerStep, size_t )                  \
+
 #define LOCAL_ADD_MEMBER(_name, _type) _type m##_name;
 
 struct NeslSimulationDataDataTag
@@ -47,6 +57,7 @@ struct NeslSimulationDataDataTag
     NESL_SIM_DATA_MACRO(LOCAL_ADD_MEMBER)
     NESL_SIM_DATA_VECTOR_MACRO(LOCAL_ADD_MEMBER)
     NESL_SIM_DATA_PATTERN_MACRO(LOCAL_ADD_MEMBER)
+    NESL_SIM_DATA_STATS_MACRO(LOCAL_ADD_MEMBER)
 };
 
 #endif /* include guard */